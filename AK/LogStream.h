@@ -57,6 +57,41 @@ private:
 #endif
 };
 
+#if defined(KERNEL)
+// In the kernel, a message is put together here and handed over in one piece when the
+// stream goes away, so it becomes a single kernel log record instead of a bunch of fragments.
+template<int (*putstr)(const char*, int)>
+class BufferedLogStream : public LogStream {
+public:
+    virtual ~BufferedLogStream() override { flush(); }
+
+    virtual void write(const char* characters, int length) const override
+    {
+        for (int i = 0; i < length; ++i) {
+            if (m_length == (int)sizeof(m_buffer))
+                flush();
+            m_buffer[m_length++] = characters[i];
+        }
+    }
+
+private:
+    void flush() const
+    {
+        if (m_length)
+            putstr(m_buffer, m_length);
+        m_length = 0;
+    }
+
+    mutable char m_buffer[128];
+    mutable int m_length { 0 };
+};
+
+class DebugLogStream final : public BufferedLogStream<dbgputstr> {
+public:
+    DebugLogStream() {}
+    virtual ~DebugLogStream() override;
+};
+#else
 class DebugLogStream final : public LogStream {
 public:
     DebugLogStream() {}
@@ -67,17 +102,13 @@ public:
         dbgputstr(characters, length);
     }
 };
+#endif
 
 #if !defined(BOOTSTRAPPER) && defined(KERNEL)
-class KernelLogStream final : public LogStream {
+class KernelLogStream final : public BufferedLogStream<kernelputstr> {
 public:
     KernelLogStream() {}
     virtual ~KernelLogStream() override;
-
-    virtual void write(const char* characters, int length) const override
-    {
-        kernelputstr(characters, length);
-    }
 };
 #endif
 
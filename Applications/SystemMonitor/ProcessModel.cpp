@@ -107,6 +107,10 @@ String ProcessModel::column_name(int column) const
         return "F:Zero";
     case Column::CowFaults:
         return "F:CoW";
+    case Column::MinorFaults:
+        return "F:Minor";
+    case Column::MajorFaults:
+        return "F:Major";
     case Column::IPv4SocketReadBytes:
         return "IPv4 In";
     case Column::IPv4SocketWriteBytes:
@@ -169,6 +173,10 @@ GUI::Model::ColumnMetadata ProcessModel::column_metadata(int column) const
         return { 60, Gfx::TextAlignment::CenterRight };
     case Column::CowFaults:
         return { 60, Gfx::TextAlignment::CenterRight };
+    case Column::MinorFaults:
+        return { 60, Gfx::TextAlignment::CenterRight };
+    case Column::MajorFaults:
+        return { 60, Gfx::TextAlignment::CenterRight };
     case Column::FileReadBytes:
         return { 60, Gfx::TextAlignment::CenterRight };
     case Column::FileWriteBytes:
@@ -242,6 +250,10 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
             return thread.current_state.zero_faults;
         case Column::CowFaults:
             return thread.current_state.cow_faults;
+        case Column::MinorFaults:
+            return thread.current_state.minor_faults;
+        case Column::MajorFaults:
+            return thread.current_state.major_faults;
         case Column::IPv4SocketReadBytes:
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
@@ -311,6 +323,10 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, Role role) const
             return thread.current_state.zero_faults;
         case Column::CowFaults:
             return thread.current_state.cow_faults;
+        case Column::MinorFaults:
+            return thread.current_state.minor_faults;
+        case Column::MajorFaults:
+            return thread.current_state.major_faults;
         case Column::IPv4SocketReadBytes:
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
@@ -354,6 +370,8 @@ void ProcessModel::update()
             state.inode_faults = thread.inode_faults;
             state.zero_faults = thread.zero_faults;
             state.cow_faults = thread.cow_faults;
+            state.minor_faults = it.value.minor_faults;
+            state.major_faults = it.value.major_faults;
             state.unix_socket_read_bytes = thread.unix_socket_read_bytes;
             state.unix_socket_write_bytes = thread.unix_socket_write_bytes;
             state.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes;
@@ -67,6 +67,8 @@ public:
         InodeFaults,
         ZeroFaults,
         CowFaults,
+        MinorFaults,
+        MajorFaults,
         FileReadBytes,
         FileWriteBytes,
         UnixSocketReadBytes,
@@ -114,6 +116,8 @@ private:
         unsigned inode_faults;
         unsigned zero_faults;
         unsigned cow_faults;
+        unsigned minor_faults;
+        unsigned major_faults;
         unsigned unix_socket_read_bytes;
         unsigned unix_socket_write_bytes;
         unsigned ipv4_socket_read_bytes;
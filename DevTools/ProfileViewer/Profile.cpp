@@ -26,12 +26,64 @@
 
 #include "Profile.h"
 #include "ProfileModel.h"
+#include <AK/Demangle.h>
+#include <AK/HashMap.h>
 #include <AK/HashTable.h>
 #include <AK/MappedFile.h>
 #include <AK/QuickSort.h>
 #include <LibCore/File.h>
 #include <LibELF/ELFLoader.h>
+#include <serenity.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/profile.h>
+
+// The running kernel's symbol table as exported by /proc/ksyms, already sorted by address.
+// It's a lot cheaper than digging the symbols out of /boot/kernel, and always matches.
+class KernelSymbols {
+public:
+    bool load()
+    {
+        auto file = Core::File::construct("/proc/ksyms");
+        if (!file->open(Core::IODevice::ReadOnly))
+            return false;
+        auto data = file->read_all();
+        for (auto line : StringView(data).split_view('\n')) {
+            if (line.length() < 10)
+                continue;
+            auto address = strtoul(String(line.substring_view(0, 8)).characters(), nullptr, 16);
+            m_symbols.append({ (u32)address, line.substring_view(9, line.length() - 9) });
+        }
+        return !m_symbols.is_empty();
+    }
+
+    String symbolicate(u32 address, u32& offset) const
+    {
+        offset = 0;
+        size_t low = 0;
+        size_t high = m_symbols.size();
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (m_symbols[middle].address > address)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        if (low == 0)
+            return "??";
+        auto& symbol = m_symbols[low - 1];
+        offset = address - symbol.address;
+        return demangle(symbol.name);
+    }
+
+private:
+    struct Symbol {
+        u32 address;
+        String name;
+    };
+    Vector<Symbol> m_symbols;
+};
 
 static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
 {
@@ -109,7 +161,7 @@ void Profile::rebuild_tree()
         if (event.type == "malloc" && !live_allocations.contains(event.ptr))
             continue;
 
-        if (event.type == "free")
+        if (event.type == "free" || event.is_trace())
             continue;
 
         ProfileNode* node = nullptr;
@@ -166,7 +218,13 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
         return nullptr;
     }
 
-    auto json = JsonValue::from_string(file->read_all());
+    auto data = file->read_all();
+
+    // Captures from /dev/profile are a stream of binary records, not JSON.
+    if (!data.is_empty() && data[0] != '{')
+        return load_from_profile_stream(data);
+
+    auto json = JsonValue::from_string(data);
     if (!json.is_object()) {
         fprintf(stderr, "Invalid perfcore format (not a JSON object)\n");
         return nullptr;
@@ -183,10 +241,15 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
 
     auto elf_loader = make<ELFLoader>(static_cast<const u8*>(elf_file.data()), elf_file.size());
 
-    MappedFile kernel_elf_file("/boot/kernel");
+    KernelSymbols kernel_symbols;
+    bool has_kernel_symbols = kernel_symbols.load();
+    MappedFile kernel_elf_file;
     OwnPtr<ELFLoader> kernel_elf_loader;
-    if (kernel_elf_file.is_valid())
-        kernel_elf_loader = make<ELFLoader>(static_cast<const u8*>(kernel_elf_file.data()), kernel_elf_file.size());
+    if (!has_kernel_symbols) {
+        kernel_elf_file = MappedFile("/boot/kernel");
+        if (kernel_elf_file.is_valid())
+            kernel_elf_loader = make<ELFLoader>(static_cast<const u8*>(kernel_elf_file.data()), kernel_elf_file.size());
+    }
 
     auto events_value = object.get("events");
     if (!events_value.is_array())
@@ -221,7 +284,9 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
             String symbol;
 
             if (ptr >= 0xc0000000) {
-                if (kernel_elf_loader) {
+                if (has_kernel_symbols) {
+                    symbol = kernel_symbols.symbolicate(ptr, offset);
+                } else if (kernel_elf_loader) {
                     symbol = kernel_elf_loader->symbolicate(ptr, &offset);
                 } else {
                     symbol = "??";
@@ -248,6 +313,237 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
     return NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(move(events)));
 }
 
+struct SymbolicationTarget {
+    MappedFile file;
+    OwnPtr<ELFLoader> loader;
+};
+
+OwnPtr<Profile> Profile::load_from_profile_stream(const ByteBuffer& data)
+{
+    KernelSymbols kernel_symbols;
+    bool has_kernel_symbols = kernel_symbols.load();
+    MappedFile kernel_elf_file;
+    OwnPtr<ELFLoader> kernel_elf_loader;
+    if (!has_kernel_symbols) {
+        kernel_elf_file = MappedFile("/boot/kernel");
+        if (kernel_elf_file.is_valid())
+            kernel_elf_loader = make<ELFLoader>(static_cast<const u8*>(kernel_elf_file.data()), kernel_elf_file.size());
+    }
+
+    HashMap<pid_t, String> process_names;
+    HashMap<pid_t, String> process_executables;
+    HashMap<String, OwnPtr<SymbolicationTarget>> targets;
+
+    auto loader_for_pid = [&](pid_t pid) -> ELFLoader* {
+        auto executable_path = process_executables.get(pid);
+        if (!executable_path.has_value() || executable_path.value().is_empty())
+            return nullptr;
+        auto it = targets.find(executable_path.value());
+        if (it != targets.end())
+            return it->value->loader.ptr();
+        auto target = make<SymbolicationTarget>();
+        target->file = MappedFile(executable_path.value());
+        if (target->file.is_valid())
+            target->loader = make<ELFLoader>(static_cast<const u8*>(target->file.data()), target->file.size());
+        else
+            fprintf(stderr, "Unable to open executable '%s' for symbolication.\n", executable_path.value().characters());
+        auto* loader = target->loader.ptr();
+        targets.set(executable_path.value(), move(target));
+        return loader;
+    };
+
+    auto symbolicate = [&](ELFLoader* elf_loader, u32 ptr) -> Frame {
+        u32 offset = 0;
+        String symbol;
+        if (ptr >= 0xc0000000) {
+            if (has_kernel_symbols)
+                symbol = kernel_symbols.symbolicate(ptr, offset);
+            else if (kernel_elf_loader)
+                symbol = kernel_elf_loader->symbolicate(ptr, &offset);
+        } else if (elf_loader) {
+            symbol = elf_loader->symbolicate(ptr, &offset);
+        }
+        if (symbol.is_empty() || symbol == "??")
+            symbol = String::format("??@%08x", ptr);
+        return { symbol, ptr, offset };
+    };
+
+    Vector<Event> events;
+    HashMap<u32, String> tracepoint_names;
+    u32 lost_samples = 0;
+
+    // Events and tracepoints only come in perfcore files, which hold a single process.
+    pid_t perfcore_pid = 0;
+
+    size_t offset = 0;
+    while (offset + sizeof(profile_record_header) <= data.size()) {
+        profile_record_header header;
+        memcpy(&header, data.data() + offset, sizeof(header));
+        if (header.size < sizeof(header) || offset + header.size > data.size()) {
+            fprintf(stderr, "Truncated profile record at offset %zu\n", offset);
+            break;
+        }
+        const u8* record = data.data() + offset;
+        offset += header.size;
+
+        if (header.type == PROFILE_RECORD_PROCESS && header.size >= sizeof(profile_process)) {
+            profile_process process;
+            memcpy(&process, record, sizeof(process));
+            if (sizeof(process) + process.name_length + process.executable_length > header.size)
+                continue;
+            auto* strings = reinterpret_cast<const char*>(record + sizeof(process));
+            process_names.set(process.pid, String(strings, process.name_length));
+            process_executables.set(process.pid, String(strings + process.name_length, process.executable_length));
+            perfcore_pid = process.pid;
+            continue;
+        }
+
+        if (header.type == PROFILE_RECORD_LOST && header.size >= sizeof(profile_lost)) {
+            profile_lost lost;
+            memcpy(&lost, record, sizeof(lost));
+            lost_samples += lost.count;
+            continue;
+        }
+
+        if (header.type == PROFILE_RECORD_TRACEPOINT && header.size >= sizeof(profile_tracepoint)) {
+            profile_tracepoint tracepoint;
+            memcpy(&tracepoint, record, sizeof(tracepoint));
+            if (sizeof(tracepoint) + tracepoint.name_length > header.size)
+                continue;
+            tracepoint_names.set(tracepoint.id, String(reinterpret_cast<const char*>(record + sizeof(tracepoint)), tracepoint.name_length));
+            continue;
+        }
+
+        if (header.type == PROFILE_RECORD_EVENT && header.size >= sizeof(profile_event)) {
+            profile_event perf_event;
+            memcpy(&perf_event, record, sizeof(perf_event));
+            if (sizeof(perf_event) + perf_event.frame_count * sizeof(u32) > header.size)
+                continue;
+
+            Event event;
+            event.timestamp = perf_event.timestamp;
+            event.tid = perf_event.tid;
+
+            switch (perf_event.type) {
+            case PERF_EVENT_MALLOC:
+                event.type = "malloc";
+                event.size = perf_event.arg1;
+                event.ptr = perf_event.arg2;
+                break;
+            case PERF_EVENT_FREE:
+                event.type = "free";
+                event.ptr = perf_event.arg1;
+                break;
+            case PERF_EVENT_TRACE_BEGIN:
+                event.type = "trace_begin";
+                break;
+            case PERF_EVENT_TRACE_END:
+                event.type = "trace_end";
+                break;
+            case PERF_EVENT_TRACE_INSTANT:
+                event.type = "trace_instant";
+                break;
+            default:
+                continue;
+            }
+            if (event.is_trace()) {
+                event.tracepoint_id = perf_event.arg1;
+                event.payload = perf_event.arg2;
+            }
+
+            auto* elf_loader = loader_for_pid(perfcore_pid);
+            auto* frames = reinterpret_cast<const u32*>(record + sizeof(perf_event));
+            for (ssize_t i = perf_event.frame_count - 1; i >= 0; --i) {
+                u32 ptr;
+                memcpy(&ptr, &frames[i], sizeof(ptr));
+                event.frames.append(symbolicate(elf_loader, ptr));
+            }
+
+            events.append(move(event));
+            continue;
+        }
+
+        if (header.type != PROFILE_RECORD_SAMPLE || header.size < sizeof(profile_sample))
+            continue;
+
+        profile_sample sample;
+        memcpy(&sample, record, sizeof(sample));
+        if (sizeof(sample) + sample.frame_count * sizeof(u32) > header.size || !sample.frame_count)
+            continue;
+
+        Event event;
+        event.timestamp = sample.timestamp;
+        event.type = "sample";
+        event.tid = sample.tid;
+        event.in_kernel = sample.flags & PROFILE_SAMPLE_IN_KERNEL;
+
+        // Root every stack in its process so a system-wide capture splits up by who was running.
+        auto process_name = process_names.get(sample.pid).value_or("??");
+        event.frames.append({ String::format("%s(%d)", process_name.characters(), sample.pid), 0, 0 });
+
+        auto* elf_loader = loader_for_pid(sample.pid);
+        auto* frames = reinterpret_cast<const u32*>(record + sizeof(sample));
+        for (ssize_t i = sample.frame_count - 1; i >= 0; --i) {
+            u32 ptr;
+            memcpy(&ptr, &frames[i], sizeof(ptr));
+            event.frames.append(symbolicate(elf_loader, ptr));
+        }
+
+        events.append(move(event));
+    }
+
+    if (lost_samples)
+        fprintf(stderr, "Warning: %u samples were lost while recording\n", lost_samples);
+
+    if (events.is_empty()) {
+        fprintf(stderr, "No samples in profile\n");
+        return nullptr;
+    }
+
+    auto profile = NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(move(events)));
+    profile->build_trace_spans(tracepoint_names);
+    return profile;
+}
+
+void Profile::build_trace_spans(const HashMap<u32, String>& tracepoint_names)
+{
+    // Scopes nest within a thread, so a stack of open spans per thread is enough to pair them up.
+    HashMap<int, Vector<size_t>> open_spans;
+
+    for (auto& event : m_events) {
+        if (!event.is_trace())
+            continue;
+
+        if (event.type == "trace_end") {
+            auto& stack = open_spans.ensure(event.tid);
+            if (!stack.is_empty())
+                m_trace_spans[stack.take_last()].end = event.timestamp;
+            continue;
+        }
+
+        TraceSpan span;
+        span.tracepoint_id = event.tracepoint_id;
+        span.name = tracepoint_names.get(event.tracepoint_id).value_or(String::format("#%u", event.tracepoint_id));
+        span.tid = event.tid;
+        span.start = event.timestamp;
+        span.end = event.timestamp;
+        span.payload = event.payload;
+
+        if (!m_tracepoint_names.contains_slow(span.name))
+            m_tracepoint_names.append(span.name);
+
+        if (event.type == "trace_begin") {
+            auto& stack = open_spans.ensure(event.tid);
+            span.depth = stack.size();
+            stack.append(m_trace_spans.size());
+            // Until we see the end, assume it lasted until the end of the profile.
+            span.end = m_last_timestamp;
+        }
+
+        m_trace_spans.append(move(span));
+    }
+}
+
 void ProfileNode::sort_children()
 {
     sort_profile_nodes(m_children);
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
@@ -105,6 +107,7 @@ private:
 class Profile {
 public:
     static OwnPtr<Profile> load_from_perfcore_file(const StringView& path);
+    static OwnPtr<Profile> load_from_profile_stream(const ByteBuffer&);
     ~Profile();
 
     GUI::Model& model();
@@ -123,13 +126,32 @@ public:
         FlatPtr ptr { 0 };
         size_t size { 0 };
         bool in_kernel { false };
+        int tid { 0 };
+        u32 tracepoint_id { 0 };
+        u32 payload { 0 };
         Vector<Frame> frames;
+
+        bool is_trace() const { return type.starts_with("trace_"); }
+    };
+
+    // One firing of a tracepoint: a begin/end pair, or an instant (where start == end).
+    struct TraceSpan {
+        u32 tracepoint_id { 0 };
+        String name;
+        int tid { 0 };
+        u64 start { 0 };
+        u64 end { 0 };
+        u32 payload { 0 };
+        u32 depth { 0 };
     };
 
     u32 filtered_event_count() const { return m_filtered_event_count; }
 
     const Vector<Event>& events() const { return m_events; }
 
+    const Vector<TraceSpan>& trace_spans() const { return m_trace_spans; }
+    const Vector<String>& tracepoint_names() const { return m_tracepoint_names; }
+
     u64 length_in_ms() const { return m_last_timestamp - m_first_timestamp; }
     u64 first_timestamp() const { return m_first_timestamp; }
     u64 last_timestamp() const { return m_last_timestamp; }
@@ -149,6 +171,7 @@ private:
     explicit Profile(Vector<Event>);
 
     void rebuild_tree();
+    void build_trace_spans(const HashMap<u32, String>& tracepoint_names);
 
     RefPtr<ProfileModel> m_model;
     Vector<NonnullRefPtr<ProfileNode>> m_roots;
@@ -157,6 +180,8 @@ private:
     u64 m_last_timestamp { 0 };
 
     Vector<Event> m_events;
+    Vector<TraceSpan> m_trace_spans;
+    Vector<String> m_tracepoint_names;
 
     bool m_has_timestamp_filter_range { false };
     u64 m_timestamp_filter_range_start { 0 };
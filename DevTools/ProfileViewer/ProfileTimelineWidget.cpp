@@ -27,6 +27,10 @@
 #include "ProfileTimelineWidget.h"
 #include "Profile.h"
 #include <LibGUI/Painter.h>
+#include <LibGfx/Font.h>
+
+static const int sample_area_height = 80;
+static const int tracepoint_lane_height = 16;
 
 ProfileTimelineWidget::ProfileTimelineWidget(Profile& profile)
     : m_profile(profile)
@@ -34,7 +38,7 @@ ProfileTimelineWidget::ProfileTimelineWidget(Profile& profile)
     set_background_color(Color::White);
     set_fill_with_background_color(true);
     set_size_policy(GUI::SizePolicy::Fill, GUI::SizePolicy::Fixed);
-    set_preferred_size(0, 80);
+    set_preferred_size(0, sample_area_height + m_profile.tracepoint_names().size() * tracepoint_lane_height);
 }
 
 ProfileTimelineWidget::~ProfileTimelineWidget()
@@ -49,19 +53,47 @@ void ProfileTimelineWidget::paint_event(GUI::PaintEvent& event)
     painter.add_clip_rect(event.rect());
 
     float column_width = (float)frame_inner_rect().width() / (float)m_profile.length_in_ms();
-    float frame_height = (float)frame_inner_rect().height() / (float)m_profile.deepest_stack_depth();
+    int sample_area_bottom = frame_thickness() + sample_area_height;
+    float frame_height = (float)(sample_area_height - frame_thickness()) / (float)max(m_profile.deepest_stack_depth(), 1u);
 
     for (auto& event : m_profile.events()) {
+        if (event.is_trace())
+            continue;
+
         u64 t = event.timestamp - m_profile.first_timestamp();
         int x = (int)((float)t * column_width);
         int cw = max(1, (int)column_width);
 
-        int column_height = frame_inner_rect().height() - (int)((float)event.frames.size() * frame_height);
+        int column_height = (int)((float)event.frames.size() * frame_height);
 
         bool in_kernel = event.in_kernel;
         Color color = in_kernel ? Color::from_rgb(0xc25e5a) : Color::from_rgb(0x5a65c2);
         for (int i = 0; i < cw; ++i)
-            painter.draw_line({ x + i, frame_thickness() + column_height }, { x + i, height() - frame_thickness() * 2 }, color);
+            painter.draw_line({ x + i, sample_area_bottom - column_height }, { x + i, sample_area_bottom - 1 }, color);
+    }
+
+    // Each tracepoint gets a lane of its own below the samples, with a bar for every time it fired.
+    auto& tracepoint_names = m_profile.tracepoint_names();
+    for (size_t lane = 0; lane < tracepoint_names.size(); ++lane) {
+        Gfx::Rect lane_rect { frame_thickness(), sample_area_bottom + (int)lane * tracepoint_lane_height, frame_inner_rect().width(), tracepoint_lane_height };
+        painter.fill_rect(lane_rect, lane % 2 ? Color::from_rgb(0xf0f0f0) : Color::White);
+        painter.draw_text(lane_rect.shrunken(4, 0), tracepoint_names[lane], Gfx::TextAlignment::CenterLeft, Color::from_rgb(0x808080));
+    }
+
+    for (auto& span : m_profile.trace_spans()) {
+        size_t lane = 0;
+        while (lane < tracepoint_names.size() && tracepoint_names[lane] != span.name)
+            ++lane;
+
+        int x = (int)((float)(span.start - m_profile.first_timestamp()) * column_width);
+        int w = max(2, (int)((float)(span.end - span.start) * column_width));
+        Gfx::Rect span_rect { frame_thickness() + x, sample_area_bottom + (int)lane * tracepoint_lane_height + 2, w, tracepoint_lane_height - 4 };
+
+        Color color = span.start == span.end ? Color::from_rgb(0xc2a05a) : Color::from_rgb(0x5ac27a);
+        painter.fill_rect(span_rect, color);
+        painter.draw_rect(span_rect, color.darkened());
+        if (span_rect.width() > font().width(span.name) + 4)
+            painter.draw_text(span_rect, span.name, Gfx::TextAlignment::Center, Color::Black);
     }
 
     u64 normalized_start_time = min(m_select_start_time, m_select_end_time);
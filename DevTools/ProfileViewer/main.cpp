@@ -34,21 +34,67 @@
 #include <LibGUI/Model.h>
 #include <LibGUI/TreeView.h>
 #include <LibGUI/Window.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static OwnPtr<Profile> record_system_profile(int seconds)
+{
+    int fd = open("/dev/profile", O_RDONLY);
+    if (fd < 0) {
+        perror("open /dev/profile");
+        return nullptr;
+    }
+
+    printf("Recording the whole system for %d second(s)...\n", seconds);
+
+    ByteBuffer data;
+    auto buffer = ByteBuffer::create_uninitialized(64 * KB);
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - start.tv_sec >= seconds)
+            break;
+        ssize_t nread = read(fd, buffer.data(), buffer.size());
+        if (nread < 0) {
+            perror("read");
+            break;
+        }
+        data.append(buffer.data(), nread);
+    }
+    close(fd);
+
+    return Profile::load_from_profile_stream(data);
+}
 
 int main(int argc, char** argv)
 {
-    if (argc != 2) {
+    if (argc < 2 || argc > 3) {
         printf("usage: %s <profile-file>\n", argv[0]);
+        printf("       %s --system [seconds]\n", argv[0]);
         return 0;
     }
 
-    const char* path = argv[1];
-    auto profile = Profile::load_from_perfcore_file(path);
-
-    if (!profile) {
-        fprintf(stderr, "Unable to load profile '%s'\n", path);
-        return 1;
+    OwnPtr<Profile> profile;
+    if (!strcmp(argv[1], "--system")) {
+        int seconds = argc == 3 ? atoi(argv[2]) : 5;
+        profile = record_system_profile(max(seconds, 1));
+        if (!profile) {
+            fprintf(stderr, "Unable to record a system profile\n");
+            return 1;
+        }
+    } else {
+        const char* path = argv[1];
+        profile = Profile::load_from_perfcore_file(path);
+        if (!profile) {
+            fprintf(stderr, "Unable to load profile '%s'\n", path);
+            return 1;
+        }
     }
 
     GUI::Application app(argc, argv);
@@ -37,6 +37,7 @@
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
 #include <Kernel/Interrupts/UnhandledInterruptHandler.h>
 #include <Kernel/KSyms.h>
+#include <Kernel/KernelLog.h>
 #include <Kernel/Process.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/IO.h>
@@ -171,6 +172,7 @@ void handle_crash(RegisterState& regs, const char* description, int signal)
 {
     if (!Process::current) {
         klog() << description << " with !current";
+        KernelLog::flush();
         hang();
     }
 
@@ -184,6 +186,7 @@ void handle_crash(RegisterState& regs, const char* description, int signal)
     if (Process::current->is_ring0()) {
         klog() << "Oh shit, we've crashed in ring 0 :(";
         dump_backtrace();
+        KernelLog::flush();
         hang();
     }
 
@@ -269,8 +272,6 @@ void page_fault_handler(RegisterState regs)
         u32 free_scrub_pattern = explode_byte(FREE_SCRUB_BYTE);
         u32 kmalloc_scrub_pattern = explode_byte(KMALLOC_SCRUB_BYTE);
         u32 kfree_scrub_pattern = explode_byte(KFREE_SCRUB_BYTE);
-        u32 slab_alloc_scrub_pattern = explode_byte(SLAB_ALLOC_SCRUB_BYTE);
-        u32 slab_dealloc_scrub_pattern = explode_byte(SLAB_DEALLOC_SCRUB_BYTE);
         if ((fault_address & 0xffff0000) == (malloc_scrub_pattern & 0xffff0000)) {
             dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like it may be uninitialized malloc() memory";
         } else if ((fault_address & 0xffff0000) == (free_scrub_pattern & 0xffff0000)) {
@@ -279,10 +280,6 @@ void page_fault_handler(RegisterState regs)
             dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like it may be uninitialized kmalloc() memory";
         } else if ((fault_address & 0xffff0000) == (kfree_scrub_pattern & 0xffff0000)) {
             dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like it may be recently kfree()'d memory";
-        } else if ((fault_address & 0xffff0000) == (slab_alloc_scrub_pattern & 0xffff0000)) {
-            dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like it may be uninitialized slab_alloc() memory";
-        } else if ((fault_address & 0xffff0000) == (slab_dealloc_scrub_pattern & 0xffff0000)) {
-            dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like it may be recently slab_dealloc()'d memory";
         } else if (fault_address < 4096) {
             dbg() << "Note: Address " << VirtualAddress(fault_address) << " looks like a possible nullptr dereference";
         }
@@ -829,6 +826,7 @@ void __assertion_failed(const char* msg, const char* file, unsigned line, const
         MM.enter_process_paging_scope(*Process::current);
 
     Kernel::dump_backtrace();
+    KernelLog::flush();
     asm volatile("hlt");
     for (;;)
         ;
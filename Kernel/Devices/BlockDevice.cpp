@@ -24,22 +24,205 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
+#include <LibBareMetal/StdLib.h>
+#include <LibC/errno_numbers.h>
+
+//#define BLOCK_QUEUE_DEBUG
 
 namespace Kernel {
 
+// A request that has been waiting this long is served next, no matter where it is on the disk.
+static const u64 max_request_wait_ms = 500;
+
+static Thread* s_io_thread;
+static WaitQueue* s_io_wait_queue;
+static Vector<BlockDevice*>* s_queued_devices;
+static size_t s_next_queued_device;
+
+// Transfers that bypass the read cache are bounced through a kernel buffer of at most this size.
+static const size_t max_direct_transfer_size = 16 * PAGE_SIZE;
+
+static u64 uptime_ms()
+{
+    return g_uptime * 1000 / TimeManagement::the().ticks_per_second();
+}
+
+// The read cache holds one page worth of blocks per entry (a "chunk"), which is also the most
+// the drivers transfer in one go. Entries that are being loaded or copied out of are never evicted.
+class BlockReadCache {
+public:
+    static const size_t entry_count = 256;
+
+    // Once reads look sequential, we read this far ahead, doubling with every read that follows on.
+    static const unsigned min_readahead_chunks = 4;
+    static const unsigned max_readahead_chunks = 32;
+
+    enum class State : u8 {
+        Empty,
+        Loading,
+        Valid,
+    };
+
+    struct Entry {
+        unsigned chunk { 0 };
+        State state { State::Empty };
+        u32 pin_count { 0 };
+        u32 last_used { 0 };
+    };
+
+    BlockReadCache()
+        : m_data(KBuffer::create_with_size(entry_count * PAGE_SIZE, Region::Access::Read | Region::Access::Write, "BlockReadCache"))
+    {
+    }
+
+    u8* data(const Entry& entry) { return m_data.data() + (&entry - m_entries) * PAGE_SIZE; }
+
+    // Makes sure the entry's page is backed by memory before the driver writes into it,
+    // since release_pages() may have given it back.
+    bool commit(const Entry& entry) { return m_data.impl().region().commit(&entry - m_entries); }
+    WaitQueue& wait_queue() { return m_wait_queue; }
+
+    Entry* find(unsigned chunk)
+    {
+        auto it = m_entry_for_chunk.find(chunk);
+        if (it == m_entry_for_chunk.end())
+            return nullptr;
+        return &m_entries[(*it).value];
+    }
+
+    // Takes over the least recently used entry that isn't busy, for loading the given chunk into.
+    Entry* claim(unsigned chunk)
+    {
+        Entry* victim = nullptr;
+        for (auto& entry : m_entries) {
+            if (entry.state == State::Loading || entry.pin_count)
+                continue;
+            if (entry.state == State::Empty) {
+                victim = &entry;
+                break;
+            }
+            if (!victim || entry.last_used < victim->last_used)
+                victim = &entry;
+        }
+        if (!victim)
+            return nullptr;
+        if (victim->state == State::Valid)
+            m_entry_for_chunk.remove(victim->chunk);
+        victim->chunk = chunk;
+        victim->state = State::Loading;
+        touch(*victim);
+        m_entry_for_chunk.set(chunk, victim - m_entries);
+        return victim;
+    }
+
+    void drop(Entry& entry)
+    {
+        m_entry_for_chunk.remove(entry.chunk);
+        entry.state = State::Empty;
+    }
+
+    void touch(Entry& entry) { entry.last_used = ++m_use_counter; }
+
+    // Waits for the chunk if it's being loaded, and pins it if it's there.
+    Entry* wait_and_pin(unsigned chunk)
+    {
+        InterruptDisabler disabler;
+        for (;;) {
+            auto* entry = find(chunk);
+            if (!entry)
+                return nullptr;
+            if (entry->state == State::Valid) {
+                ++entry->pin_count;
+                touch(*entry);
+                return entry;
+            }
+            Thread::current->wait_on(m_wait_queue);
+        }
+    }
+
+    void unpin(Entry& entry)
+    {
+        InterruptDisabler disabler;
+        ASSERT(entry.pin_count);
+        --entry.pin_count;
+    }
+
+    // Figures out how far to read ahead of a read at the given offset.
+    unsigned update_readahead(u32 offset, unsigned length)
+    {
+        InterruptDisabler disabler;
+        if (offset == m_sequential_offset)
+            m_readahead_chunks = m_readahead_chunks ? min(m_readahead_chunks * 2, max_readahead_chunks) : min_readahead_chunks;
+        else
+            m_readahead_chunks = 0;
+        m_sequential_offset = offset + length;
+        return m_readahead_chunks;
+    }
+
+    size_t release_pages()
+    {
+        InterruptDisabler disabler;
+        auto& region = m_data.impl().region();
+        size_t released_page_count = 0;
+        for (size_t i = 0; i < entry_count; ++i) {
+            auto& entry = m_entries[i];
+            // Empty entries are about to be claimed (or have never been used), so leave them alone.
+            if (entry.state != State::Valid || entry.pin_count)
+                continue;
+            drop(entry);
+            if (region.decommit(i))
+                ++released_page_count;
+        }
+        return released_page_count;
+    }
+
+private:
+    KBuffer m_data;
+    Entry m_entries[entry_count];
+    HashMap<unsigned, size_t> m_entry_for_chunk;
+    WaitQueue m_wait_queue;
+    u32 m_use_counter { 0 };
+
+    u32 m_sequential_offset { 0 };
+    unsigned m_readahead_chunks { 0 };
+};
+
+BlockDevice::BlockDevice(unsigned major, unsigned minor, size_t block_size)
+    : Device(major, minor)
+    , m_block_size(block_size)
+{
+}
+
 BlockDevice::~BlockDevice()
 {
+    InterruptDisabler disabler;
+    ASSERT(m_queue.is_empty());
+    if (s_queued_devices) {
+        s_queued_devices->remove_first_matching([this](auto* device) { return device == this; });
+        s_next_queued_device = 0;
+    }
+    if (m_merge_buffer)
+        kfree(m_merge_buffer);
 }
 
 bool BlockDevice::read_block(unsigned index, u8* buffer) const
 {
-    return const_cast<BlockDevice*>(this)->read_blocks(index, 1, buffer);
+    return const_cast<BlockDevice*>(this)->submit_request_and_wait(RequestType::Read, index, 1, buffer);
 }
 
 bool BlockDevice::write_block(unsigned index, const u8* data)
 {
-    return write_blocks(index, 1, data);
+    return submit_request_and_wait(RequestType::Write, index, 1, const_cast<u8*>(data));
 }
 
 bool BlockDevice::read_raw(u32 offset, unsigned length, u8* out) const
@@ -48,7 +231,7 @@ bool BlockDevice::read_raw(u32 offset, unsigned length, u8* out) const
     ASSERT((length % block_size()) == 0);
     u32 first_block = offset / block_size();
     u32 end_block = (offset + length) / block_size();
-    return const_cast<BlockDevice*>(this)->read_blocks(first_block, end_block - first_block, out);
+    return const_cast<BlockDevice*>(this)->submit_request_and_wait(RequestType::Read, first_block, end_block - first_block, out);
 }
 
 bool BlockDevice::write_raw(u32 offset, unsigned length, const u8* in)
@@ -59,7 +242,487 @@ bool BlockDevice::write_raw(u32 offset, unsigned length, const u8* in)
     u32 end_block = (offset + length) / block_size();
     ASSERT(first_block <= 0xffffffff);
     ASSERT(end_block <= 0xffffffff);
-    return write_blocks(first_block, end_block - first_block, in);
+    return submit_request_and_wait(RequestType::Write, first_block, end_block - first_block, const_cast<u8*>(in));
+}
+
+void BlockDevice::write_raw_async(u32 offset, unsigned length, const u8* in, Function<void(bool)> completion)
+{
+    ASSERT((offset % block_size()) == 0);
+    ASSERT((length % block_size()) == 0);
+    u32 first_block = offset / block_size();
+    u32 end_block = (offset + length) / block_size();
+    submit_request(RequestType::Write, first_block, end_block - first_block, const_cast<u8*>(in), move(completion));
+}
+
+bool BlockDevice::transfer_and_wait(RequestType type, unsigned index, unsigned count, u8* buffer)
+{
+    // Queue all of it before waiting for any of it, so the device gets to sort and merge it.
+    ASSERT(!Thread::current || Thread::current != s_io_thread);
+    WaitQueue wait_queue;
+    size_t pending_count = 0;
+    bool success = true;
+    size_t max_count = max_blocks_per_request();
+    for (unsigned i = 0; i < count; i += max_count) {
+        {
+            InterruptDisabler disabler;
+            ++pending_count;
+        }
+        submit_request(type, index + i, min(count - i, max_count), buffer + i * block_size(), [&](bool request_success) {
+            InterruptDisabler disabler;
+            if (!request_success)
+                success = false;
+            if (!--pending_count)
+                wait_queue.wake_all();
+        });
+    }
+    InterruptDisabler disabler;
+    while (pending_count)
+        Thread::current->wait_on(wait_queue);
+    return success;
+}
+
+bool BlockDevice::read_direct(u32 offset, unsigned length, u8* out)
+{
+    // The I/O thread can't see the caller's address space, so this goes through a kernel buffer.
+    unsigned first_block = offset / block_size();
+    unsigned end_block = ceil_div(offset + length, (u32)block_size());
+    unsigned max_count = max_direct_transfer_size / block_size();
+    auto buffer = ByteBuffer::create_uninitialized(min(end_block - first_block, max_count) * block_size());
+    for (unsigned index = first_block; index < end_block; index += max_count) {
+        unsigned count = min(end_block - index, max_count);
+        if (!transfer_and_wait(RequestType::Read, index, count, buffer.data()))
+            return false;
+        u32 piece_start = max(offset, (u32)(index * block_size()));
+        u32 piece_end = min(offset + length, (u32)((index + count) * block_size()));
+        memcpy(out + (piece_start - offset), buffer.data() + (piece_start - index * block_size()), piece_end - piece_start);
+    }
+    return true;
+}
+
+bool BlockDevice::write_direct(u32 offset, unsigned length, const u8* in)
+{
+    unsigned first_block = offset / block_size();
+    unsigned end_block = ceil_div(offset + length, (u32)block_size());
+    unsigned max_count = max_direct_transfer_size / block_size();
+    auto buffer = ByteBuffer::create_uninitialized(min(end_block - first_block, max_count) * block_size());
+    for (unsigned index = first_block; index < end_block; index += max_count) {
+        unsigned count = min(end_block - index, max_count);
+        u32 piece_start = max(offset, (u32)(index * block_size()));
+        u32 piece_end = min(offset + length, (u32)((index + count) * block_size()));
+
+        // We can only write whole blocks, so the ones we only partly overwrite have to be read first.
+        if (piece_start % block_size()) {
+            if (!submit_request_and_wait(RequestType::Read, index, 1, buffer.data()))
+                return false;
+        }
+        if (piece_end % block_size() && (count > 1 || !(piece_start % block_size()))) {
+            if (!submit_request_and_wait(RequestType::Read, index + count - 1, 1, buffer.data() + (count - 1) * block_size()))
+                return false;
+        }
+
+        memcpy(buffer.data() + (piece_start - index * block_size()), in + (piece_start - offset), piece_end - piece_start);
+        if (!transfer_and_wait(RequestType::Write, index, count, buffer.data()))
+            return false;
+    }
+    return true;
+}
+
+void BlockDevice::enable_read_cache()
+{
+    // Cache entries are one page each, so blocks must fit evenly into pages.
+    ASSERT(!(PAGE_SIZE % block_size()));
+    if (!m_read_cache)
+        m_read_cache = make<BlockReadCache>();
+}
+
+void BlockDevice::start_loading(unsigned first_chunk, unsigned count, bool is_readahead)
+{
+    auto& cache = *m_read_cache;
+    unsigned blocks_per_chunk = PAGE_SIZE / block_size();
+    for (unsigned chunk = first_chunk; chunk < first_chunk + count; ++chunk) {
+        unsigned index = chunk * blocks_per_chunk;
+        unsigned count_to_load = blocks_per_chunk;
+        if (block_count()) {
+            if (index >= block_count())
+                break;
+            count_to_load = min(blocks_per_chunk, block_count() - index);
+        }
+
+        BlockReadCache::Entry* entry;
+        {
+            InterruptDisabler disabler;
+            if (cache.find(chunk)) {
+                if (!is_readahead)
+                    ++m_read_cache_hit_count;
+                continue;
+            }
+            entry = cache.claim(chunk);
+            // Everything is busy being loaded or read from. Readers will go around the cache.
+            if (!entry)
+                break;
+            if (is_readahead)
+                ++m_readahead_count;
+            else
+                ++m_read_cache_miss_count;
+        }
+
+        if (!cache.commit(*entry)) {
+            InterruptDisabler disabler;
+            cache.drop(*entry);
+            cache.wait_queue().wake_all();
+            break;
+        }
+
+        submit_request(RequestType::Read, index, count_to_load, cache.data(*entry), [this, entry, chunk](bool success) {
+            InterruptDisabler disabler;
+            auto& cache = *m_read_cache;
+            ASSERT(entry->chunk == chunk && entry->state == BlockReadCache::State::Loading);
+            if (success)
+                entry->state = BlockReadCache::State::Valid;
+            else
+                cache.drop(*entry);
+            cache.wait_queue().wake_all();
+        });
+    }
+}
+
+bool BlockDevice::read_through_cache(u32 offset, unsigned length, u8* out)
+{
+    if (!m_read_cache)
+        return read_direct(offset, length, out);
+    if (!length)
+        return true;
+
+    auto& cache = *m_read_cache;
+    unsigned first_chunk = offset / PAGE_SIZE;
+    unsigned end_chunk = ceil_div(offset + length, (u32)PAGE_SIZE);
+
+    // Get everything we need (and will probably need next) on its way before waiting for any of it.
+    start_loading(first_chunk, end_chunk - first_chunk, false);
+    if (unsigned readahead_chunks = cache.update_readahead(offset, length))
+        start_loading(end_chunk, readahead_chunks, true);
+
+    for (unsigned chunk = first_chunk; chunk < end_chunk; ++chunk) {
+        u32 chunk_offset = chunk * PAGE_SIZE;
+        u32 piece_start = max(offset, chunk_offset);
+        u32 piece_end = min(offset + length, chunk_offset + (u32)PAGE_SIZE);
+        u8* destination = out + (piece_start - offset);
+
+        // It may have been evicted or overwritten since we started loading it, in which case we try once more.
+        auto* entry = cache.wait_and_pin(chunk);
+        if (!entry) {
+            start_loading(chunk, 1, false);
+            entry = cache.wait_and_pin(chunk);
+        }
+        if (!entry) {
+            if (!read_direct(piece_start, piece_end - piece_start, destination))
+                return false;
+            continue;
+        }
+        memcpy(destination, cache.data(*entry) + (piece_start - chunk_offset), piece_end - piece_start);
+        cache.unpin(*entry);
+    }
+    return true;
+}
+
+bool BlockDevice::read_from_cache_if_present(u32 offset, unsigned length, u8* out)
+{
+    if (!m_read_cache || !length)
+        return false;
+
+    auto& cache = *m_read_cache;
+    unsigned first_chunk = offset / PAGE_SIZE;
+    unsigned end_chunk = ceil_div(offset + length, (u32)PAGE_SIZE);
+    Vector<BlockReadCache::Entry*, 2> entries;
+    {
+        InterruptDisabler disabler;
+        for (unsigned chunk = first_chunk; chunk < end_chunk; ++chunk) {
+            auto* entry = cache.find(chunk);
+            if (!entry || entry->state != BlockReadCache::State::Valid) {
+                for (auto* pinned_entry : entries)
+                    --pinned_entry->pin_count;
+                return false;
+            }
+            ++entry->pin_count;
+            cache.touch(*entry);
+            entries.append(entry);
+        }
+        m_read_cache_hit_count += entries.size();
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        u32 chunk_offset = (first_chunk + i) * PAGE_SIZE;
+        u32 piece_start = max(offset, chunk_offset);
+        u32 piece_end = min(offset + length, chunk_offset + (u32)PAGE_SIZE);
+        memcpy(out + (piece_start - offset), cache.data(*entries[i]) + (piece_start - chunk_offset), piece_end - piece_start);
+        cache.unpin(*entries[i]);
+    }
+    return true;
+}
+
+void BlockDevice::invalidate_read_cache(unsigned index, unsigned count)
+{
+    if (!m_read_cache)
+        return;
+    unsigned blocks_per_chunk = PAGE_SIZE / block_size();
+    InterruptDisabler disabler;
+    for (unsigned chunk = index / blocks_per_chunk; chunk < ceil_div(index + count, blocks_per_chunk); ++chunk) {
+        auto* entry = m_read_cache->find(chunk);
+        if (entry && entry->state == BlockReadCache::State::Valid)
+            m_read_cache->drop(*entry);
+    }
+}
+
+size_t BlockDevice::release_all_read_cache_pages()
+{
+    size_t released_page_count = 0;
+    Device::for_each([&](Device& device) {
+        if (!device.is_block_device())
+            return;
+        auto& block_device = static_cast<BlockDevice&>(device);
+        if (block_device.m_read_cache)
+            released_page_count += block_device.m_read_cache->release_pages();
+    });
+    return released_page_count;
+}
+
+ssize_t BlockDevice::read_at_offset(FileDescription& description, off_t offset, u8* buffer, ssize_t length)
+{
+    if (block_count()) {
+        u64 size = (u64)block_count() * block_size();
+        if ((u64)offset >= size)
+            return 0;
+        length = min((u64)length, size - offset);
+    }
+    if (length <= 0)
+        return 0;
+    bool success = description.is_direct() ? read_direct(offset, length, buffer) : read_through_cache(offset, length, buffer);
+    if (!success)
+        return -EIO;
+    return length;
+}
+
+ssize_t BlockDevice::write_at_offset(FileDescription&, off_t offset, const u8* data, ssize_t length)
+{
+    if (block_count()) {
+        u64 size = (u64)block_count() * block_size();
+        if ((u64)offset >= size)
+            return -ENOSPC;
+        length = min((u64)length, size - offset);
+    }
+    if (length <= 0)
+        return 0;
+    // Writes always go straight to the disk. The read cache is kept up to date by submit_request().
+    if (!write_direct(offset, length, data))
+        return -EIO;
+    return length;
+}
+
+ssize_t BlockDevice::preadv(FileDescription& description, off_t offset, const iovec* iov, int iov_count)
+{
+    ssize_t nread = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = read_at_offset(description, offset + nread, (u8*)iov[i].iov_base, iov[i].iov_len);
+        if (rc < 0)
+            return nread ? nread : rc;
+        nread += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nread;
+}
+
+ssize_t BlockDevice::pwritev(FileDescription& description, off_t offset, const iovec* iov, int iov_count)
+{
+    ssize_t nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = write_at_offset(description, offset + nwritten, (const u8*)iov[i].iov_base, iov[i].iov_len);
+        if (rc < 0)
+            return nwritten ? nwritten : rc;
+        nwritten += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nwritten;
+}
+
+bool BlockDevice::submit_request_and_wait(RequestType type, unsigned index, u16 count, u8* buffer)
+{
+    ASSERT(!Thread::current || Thread::current != s_io_thread);
+    WaitQueue wait_queue;
+    bool done = false;
+    bool result = false;
+    submit_request(type, index, count, buffer, [&](bool success) {
+        result = success;
+        done = true;
+        wait_queue.wake_all();
+    });
+    InterruptDisabler disabler;
+    while (!done)
+        Thread::current->wait_on(wait_queue);
+    return result;
+}
+
+void BlockDevice::submit_request(RequestType type, unsigned index, u16 count, u8* buffer, Function<void(bool)> completion)
+{
+    // Nothing older than a write may be served from the read cache. Drop what's cached both now and
+    // once the write is done, since reads queued before it may still get dispatched ahead of it.
+    if (type == RequestType::Write && m_read_cache) {
+        invalidate_read_cache(index, count);
+        completion = [this, index, count, completion = move(completion)](bool success) {
+            invalidate_read_cache(index, count);
+            completion(success);
+        };
+    }
+
+    // Without a thread to wait in (early boot), just do the transfer right here.
+    if (!Thread::current) {
+        bool success = type == RequestType::Read ? read_blocks(index, count, buffer) : write_blocks(index, count, buffer);
+        completion(success);
+        return;
+    }
+
+    if (!s_io_thread) {
+        s_io_wait_queue = new WaitQueue;
+        s_queued_devices = new Vector<BlockDevice*>;
+        Process::create_kernel_process(s_io_thread, "BlockIO", io_thread_main);
+    }
+
+    auto request = make<Request>();
+    request->type = type;
+    request->index = index;
+    request->count = count;
+    request->buffer = buffer;
+    request->completion = move(completion);
+    request->submitted_at = uptime_ms();
+
+    InterruptDisabler disabler;
+    if (!s_queued_devices->contains_slow(this))
+        s_queued_devices->append(this);
+
+    // Keep the queue sorted by block index. Requests for the same block stay in submission order.
+    size_t insert_index = m_queue.size();
+    while (insert_index > 0 && m_queue[insert_index - 1]->index > index)
+        --insert_index;
+    m_queue.insert(insert_index, move(request));
+    m_max_queue_depth = max(m_max_queue_depth, m_queue.size());
+
+    s_io_wait_queue->wake_all();
+}
+
+size_t BlockDevice::pick_next_request() const
+{
+    ASSERT(!m_queue.is_empty());
+
+    // Don't let a request starve while we keep sweeping past it.
+    auto now = uptime_ms();
+    size_t oldest = 0;
+    for (size_t i = 1; i < m_queue.size(); ++i) {
+        if (m_queue[i]->submitted_at < m_queue[oldest]->submitted_at)
+            oldest = i;
+    }
+    if (now - m_queue[oldest]->submitted_at >= max_request_wait_ms)
+        return oldest;
+
+    // Otherwise carry on in the direction we've been going, and start over from the lowest block at the end.
+    for (size_t i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i]->index >= m_head_position)
+            return i;
+    }
+    return 0;
+}
+
+void BlockDevice::dispatch_next_requests()
+{
+    Vector<NonnullOwnPtr<Request>, 16> batch;
+    unsigned first_index;
+    size_t total_count;
+    {
+        InterruptDisabler disabler;
+        size_t queue_index = pick_next_request();
+        batch.append(m_queue.take(queue_index));
+        first_index = batch[0]->index;
+        total_count = batch[0]->count;
+
+        // Pick up everything that continues right where the batch ends, as long as the driver can take it in one go.
+        size_t max_count = max_blocks_per_request();
+        while (queue_index < m_queue.size()) {
+            auto& next = m_queue[queue_index];
+            if (next->type != batch[0]->type || next->index != first_index + total_count || total_count + next->count > max_count)
+                break;
+            total_count += next->count;
+            batch.append(m_queue.take(queue_index));
+        }
+        m_head_position = first_index + total_count;
+    }
+
+#ifdef BLOCK_QUEUE_DEBUG
+    dbg() << class_name() << ": " << (batch[0]->type == RequestType::Read ? "read" : "write") << " " << total_count << " block(s) @ " << first_index << " for " << batch.size() << " request(s)";
+#endif
+
+    bool success;
+    if (batch.size() == 1) {
+        auto& request = *batch[0];
+        if (request.type == RequestType::Read)
+            success = read_blocks(request.index, request.count, request.buffer);
+        else
+            success = write_blocks(request.index, request.count, request.buffer);
+    } else {
+        if (!m_merge_buffer)
+            m_merge_buffer = (u8*)kmalloc(max_blocks_per_request() * block_size());
+        if (batch[0]->type == RequestType::Read) {
+            success = read_blocks(first_index, total_count, m_merge_buffer);
+            if (success) {
+                for (auto& request : batch)
+                    memcpy(request->buffer, m_merge_buffer + (request->index - first_index) * block_size(), request->count * block_size());
+            }
+        } else {
+            for (auto& request : batch)
+                memcpy(m_merge_buffer + (request->index - first_index) * block_size(), request->buffer, request->count * block_size());
+            success = write_blocks(first_index, total_count, m_merge_buffer);
+        }
+        m_merged_request_count += batch.size() - 1;
+    }
+
+    auto now = uptime_ms();
+    for (auto& request : batch) {
+        record_completion(*request, now);
+        request->completion(success);
+    }
+}
+
+void BlockDevice::record_completion(const Request& request, u64 now)
+{
+    u64 latency = now - request.submitted_at;
+    size_t bucket = 0;
+    while (bucket < latency_histogram_size - 1 && latency >= (1u << bucket))
+        ++bucket;
+    ++m_latency_histogram[bucket];
+    ++m_completed_request_count;
+}
+
+void BlockDevice::io_thread_main()
+{
+    for (;;) {
+        BlockDevice* device = nullptr;
+        {
+            InterruptDisabler disabler;
+            // Take turns between devices, one batch at a time.
+            for (size_t i = 0; i < s_queued_devices->size(); ++i) {
+                auto* candidate = s_queued_devices->at((s_next_queued_device + i) % s_queued_devices->size());
+                if (!candidate->m_queue.is_empty()) {
+                    device = candidate;
+                    s_next_queued_device = (s_next_queued_device + i + 1) % s_queued_devices->size();
+                    break;
+                }
+            }
+            if (!device) {
+                Thread::current->wait_on(*s_io_wait_queue);
+                continue;
+            }
+        }
+        device->dispatch_next_requests();
+    }
 }
 
 }
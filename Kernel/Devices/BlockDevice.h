@@ -26,36 +26,125 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/Devices/Device.h>
 
 namespace Kernel {
 
+class BlockReadCache;
+
 class BlockDevice : public Device {
 public:
     virtual ~BlockDevice() override;
 
+    enum class RequestType {
+        Read,
+        Write,
+    };
+
     size_t block_size() const { return m_block_size; }
     virtual bool is_seekable() const override { return true; }
+    virtual ssize_t preadv(FileDescription&, off_t, const iovec*, int iov_count) override;
+    virtual ssize_t pwritev(FileDescription&, off_t, const iovec*, int iov_count) override;
+
+    // The size of the device in blocks, or 0 if we don't know.
+    virtual unsigned block_count() const { return 0; }
 
     bool read_block(unsigned index, u8*) const;
     bool write_block(unsigned index, const u8*);
     bool read_raw(u32 offset, unsigned length, u8*) const;
     bool write_raw(u32 offset, unsigned length, const u8*);
 
+    // Queues a request without waiting for it. Queued requests are sorted by block index and
+    // adjacent ones are merged before they reach the driver. The completion callback runs on
+    // the block I/O thread, so the buffer must be kernel memory that stays around until then.
+    virtual void submit_request(RequestType, unsigned index, u16 count, u8* buffer, Function<void(bool success)> completion);
+    void write_raw_async(u32 offset, unsigned length, const u8*, Function<void(bool success)> completion);
+
+    // Raw readers of the device (as opposed to filesystems, which have their own cache) can go through
+    // a read cache with sequential readahead. It's kept coherent with every write that goes through
+    // the request queue, and filesystems pick up blocks from it instead of going to the disk again.
+    // Partitions use the cache of the device they're on.
+    void enable_read_cache();
+    bool has_read_cache() const { return m_read_cache; }
+    virtual bool read_through_cache(u32 offset, unsigned length, u8*);
+    virtual bool read_from_cache_if_present(u32 offset, unsigned length, u8*);
+
+    static size_t release_all_read_cache_pages();
+
     virtual bool read_blocks(unsigned index, u16 count, u8*) = 0;
     virtual bool write_blocks(unsigned index, u16 count, const u8*) = 0;
 
+    // Request completion times in milliseconds, bucketed by powers of two: <1, <2, <4, ... and the rest.
+    static const size_t latency_histogram_size = 12;
+
+    size_t queue_depth() const { return m_queue.size(); }
+    size_t max_queue_depth() const { return m_max_queue_depth; }
+    u32 completed_request_count() const { return m_completed_request_count; }
+    u32 merged_request_count() const { return m_merged_request_count; }
+    const u32* latency_histogram() const { return m_latency_histogram; }
+
+    u32 read_cache_hit_count() const { return m_read_cache_hit_count; }
+    u32 read_cache_miss_count() const { return m_read_cache_miss_count; }
+    u32 readahead_count() const { return m_readahead_count; }
+
 protected:
-    BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE)
-        : Device(major, minor)
-        , m_block_size(block_size)
-    {
-    }
+    BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE);
+
+    // How many blocks the driver can transfer in one go. Requests are only merged up to this size.
+    virtual size_t max_blocks_per_request() const { return PAGE_SIZE / m_block_size; }
+
+    bool submit_request_and_wait(RequestType, unsigned index, u16 count, u8* buffer);
+
+    // For reads and writes on the device node (positional or at the description's offset): any offset
+    // and length, through the read cache unless the description is O_DIRECT, and up to the end of the
+    // device if we know where that is.
+    ssize_t read_at_offset(FileDescription&, off_t, u8*, ssize_t);
+    ssize_t write_at_offset(FileDescription&, off_t, const u8*, ssize_t);
 
 private:
     virtual bool is_block_device() const final { return true; }
 
+    struct Request {
+        RequestType type { RequestType::Read };
+        unsigned index { 0 };
+        u16 count { 0 };
+        u8* buffer { nullptr };
+        Function<void(bool)> completion;
+        u64 submitted_at { 0 };
+    };
+
+    static void io_thread_main();
+    size_t pick_next_request() const;
+    void dispatch_next_requests();
+    void record_completion(const Request&, u64 now);
+
+    bool transfer_and_wait(RequestType, unsigned index, unsigned count, u8* buffer);
+    bool read_direct(u32 offset, unsigned length, u8*);
+    bool write_direct(u32 offset, unsigned length, const u8*);
+    void invalidate_read_cache(unsigned index, unsigned count);
+    void start_loading(unsigned first_chunk, unsigned count, bool is_readahead);
+
     size_t m_block_size { 0 };
+
+    // Pending requests, sorted by block index. The I/O thread sweeps across them in one direction,
+    // starting from wherever the last transfer ended.
+    Vector<NonnullOwnPtr<Request>> m_queue;
+    unsigned m_head_position { 0 };
+    u8* m_merge_buffer { nullptr };
+
+    size_t m_max_queue_depth { 0 };
+    u32 m_completed_request_count { 0 };
+    u32 m_merged_request_count { 0 };
+    u32 m_latency_histogram[latency_histogram_size] {};
+
+    OwnPtr<BlockReadCache> m_read_cache;
+    u32 m_read_cache_hit_count { 0 };
+    u32 m_read_cache_miss_count { 0 };
+    u32 m_readahead_count { 0 };
 };
 
 }
@@ -25,6 +25,7 @@
  */
 
 #include <Kernel/Devices/DiskPartition.h>
+#include <Kernel/FileSystem/FileDescription.h>
 
 // #define OFFD_DEBUG
 
@@ -65,6 +66,43 @@ bool DiskPartition::write_blocks(unsigned index, u16 count, const u8* data)
     return m_device->write_blocks(m_block_offset + index, count, data);
 }
 
+void DiskPartition::submit_request(RequestType type, unsigned index, u16 count, u8* buffer, Function<void(bool)> completion)
+{
+    // Requests are queued (and merged) on the underlying device, where they compete with every other partition's.
+    m_device->submit_request(type, m_block_offset + index, count, buffer, move(completion));
+}
+
+bool DiskPartition::read_through_cache(u32 offset, unsigned length, u8* out)
+{
+    // Share the cache of the device we're on with everyone else reading from it.
+    return m_device->read_through_cache(m_block_offset * block_size() + offset, length, out);
+}
+
+bool DiskPartition::read_from_cache_if_present(u32 offset, unsigned length, u8* out)
+{
+    return m_device->read_from_cache_if_present(m_block_offset * block_size() + offset, length, out);
+}
+
+ssize_t DiskPartition::read(FileDescription& description, u8* buffer, ssize_t size)
+{
+    return read_at_offset(description, description.offset(), buffer, size);
+}
+
+bool DiskPartition::can_read(const FileDescription& description) const
+{
+    return static_cast<unsigned>(description.offset()) < block_count() * block_size();
+}
+
+ssize_t DiskPartition::write(FileDescription& description, const u8* data, ssize_t size)
+{
+    return write_at_offset(description, description.offset(), data, size);
+}
+
+bool DiskPartition::can_write(const FileDescription& description) const
+{
+    return static_cast<unsigned>(description.offset()) < block_count() * block_size();
+}
+
 const char* DiskPartition::class_name() const
 {
     return "DiskPartition";
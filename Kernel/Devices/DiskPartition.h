@@ -38,12 +38,16 @@ public:
 
     virtual bool read_blocks(unsigned index, u16 count, u8*) override;
     virtual bool write_blocks(unsigned index, u16 count, const u8*) override;
+    virtual void submit_request(RequestType, unsigned index, u16 count, u8* buffer, Function<void(bool success)> completion) override;
 
     // ^BlockDevice
-    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return 0; }
-    virtual bool can_read(const FileDescription&) const override { return true; }
-    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return 0; }
-    virtual bool can_write(const FileDescription&) const override { return true; }
+    virtual unsigned block_count() const override { return m_block_limit - m_block_offset; }
+    virtual bool read_through_cache(u32 offset, unsigned length, u8*) override;
+    virtual bool read_from_cache_if_present(u32 offset, unsigned length, u8*) override;
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual bool can_read(const FileDescription&) const override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
+    virtual bool can_write(const FileDescription&) const override;
 
 private:
     virtual const char* class_name() const override;
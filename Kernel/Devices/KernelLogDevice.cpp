@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Devices/KernelLogDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KernelLog.h>
+#include <Kernel/Process.h>
+#include <LibBareMetal/Output/kstdio.h>
+#include <LibBareMetal/StdLib.h>
+#include <LibC/errno_numbers.h>
+
+namespace Kernel {
+
+KernelLogDevice::KernelLogDevice()
+    : CharacterDevice(1, 11)
+{
+}
+
+KernelLogDevice::~KernelLogDevice()
+{
+}
+
+KResultOr<NonnullRefPtr<FileDescription>> KernelLogDevice::open(int options)
+{
+    // Debug messages routinely contain kernel addresses.
+    if (!Process::current->is_superuser())
+        return KResult(-EPERM);
+    auto description = FileDescription::create(KernelLogReader::create());
+    description->set_rw_mode(options);
+    description->set_file_flags(options);
+    return description;
+}
+
+KernelLogReader::KernelLogReader()
+    : m_sequence(KernelLog::first_sequence())
+{
+}
+
+KernelLogReader::~KernelLogReader()
+{
+}
+
+bool KernelLogReader::can_read(const FileDescription&) const
+{
+    KernelLog::Record record;
+    return KernelLog::read(m_sequence, record) != KernelLog::ReadResult::NotReady;
+}
+
+ssize_t KernelLogReader::read(FileDescription&, u8* buffer, ssize_t size)
+{
+    KernelLog::Record record;
+    for (;;) {
+        auto result = KernelLog::read(m_sequence, record);
+        if (result == KernelLog::ReadResult::NotReady)
+            return -EAGAIN;
+        if (result == KernelLog::ReadResult::Success)
+            break;
+        // We fell behind, skip ahead to what's still there.
+        m_sequence = KernelLog::first_sequence();
+    }
+
+    // "<level>,<sequence>,<seconds>.<microseconds since boot>;<text>", much like Linux does it.
+    char header[48];
+    u32 seconds = record.timestamp_us / 1000000;
+    u32 microseconds = record.timestamp_us % 1000000;
+    int header_length = sprintf(header, "%u,%u,%u.%06u;", (unsigned)record.level, record.sequence, seconds, microseconds);
+    ssize_t record_size = header_length + record.length;
+    if (size < record_size)
+        return -EINVAL;
+    memcpy(buffer, header, header_length);
+    memcpy(buffer + header_length, record.text, record.length);
+    ++m_sequence;
+    return record_size;
+}
+
+}
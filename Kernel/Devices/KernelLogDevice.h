@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Kernel/Devices/CharacterDevice.h>
+
+namespace Kernel {
+
+// /dev/kmsg: Streams the kernel log, one record per read(), starting with the oldest one
+// still around. Reads block until there's something new, so `dmesg -w` doesn't have to poll.
+class KernelLogDevice final : public CharacterDevice {
+    AK_MAKE_ETERNAL
+public:
+    KernelLogDevice();
+    virtual ~KernelLogDevice() override;
+
+    // ^CharacterDevice
+    virtual KResultOr<NonnullRefPtr<FileDescription>> open(int options) override;
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return 0; }
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual bool can_read(const FileDescription&) const override { return true; }
+    virtual bool can_write(const FileDescription&) const override { return false; }
+
+private:
+    // ^CharacterDevice
+    virtual const char* class_name() const override { return "KernelLogDevice"; }
+};
+
+// One open /dev/kmsg, with its own position in the log.
+class KernelLogReader final : public File {
+public:
+    static NonnullRefPtr<KernelLogReader> create() { return adopt(*new KernelLogReader); }
+    virtual ~KernelLogReader() override;
+
+private:
+    KernelLogReader();
+
+    // ^File
+    virtual bool can_read(const FileDescription&) const override;
+    virtual bool can_write(const FileDescription&) const override { return false; }
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "kmsg"; }
+    virtual const char* class_name() const override { return "KernelLogReader"; }
+
+    u32 m_sequence { 0 };
+};
+
+}
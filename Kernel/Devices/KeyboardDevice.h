@@ -56,6 +56,7 @@ public:
     virtual bool can_read(const FileDescription&) const override;
     virtual ssize_t write(FileDescription&, const u8* buffer, ssize_t) override;
     virtual bool can_write(const FileDescription&) const override { return true; }
+    virtual bool has_readiness_notifications() const override { return true; }
 
     virtual const char* purpose() const override { return class_name(); }
 
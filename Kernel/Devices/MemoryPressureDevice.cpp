@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Devices/MemoryPressureDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibC/errno_numbers.h>
+#include <LibC/sys/memory_pressure.h>
+
+namespace Kernel {
+
+static MemoryPressureDevice* s_the;
+
+MemoryPressureDevice& MemoryPressureDevice::the()
+{
+    ASSERT(s_the);
+    return *s_the;
+}
+
+MemoryPressureDevice::MemoryPressureDevice()
+    : CharacterDevice(1, 19)
+    , m_level(MEMORY_PRESSURE_NORMAL)
+{
+    s_the = this;
+}
+
+MemoryPressureDevice::~MemoryPressureDevice()
+{
+}
+
+KResultOr<NonnullRefPtr<FileDescription>> MemoryPressureDevice::open(int options)
+{
+    auto listener = MemoryPressureListener::create();
+    // Tell new listeners right away if we're already under pressure.
+    if (m_level != MEMORY_PRESSURE_NORMAL)
+        listener->did_change_level();
+    auto description = FileDescription::create(move(listener));
+    description->set_rw_mode(options);
+    description->set_file_flags(options);
+    return description;
+}
+
+void MemoryPressureDevice::set_level(int level)
+{
+    InterruptDisabler disabler;
+    if (level == m_level)
+        return;
+    m_level = level;
+    for (auto* listener : m_listeners)
+        listener->did_change_level();
+}
+
+void MemoryPressureDevice::register_listener(Badge<MemoryPressureListener>, MemoryPressureListener& listener)
+{
+    InterruptDisabler disabler;
+    m_listeners.append(&listener);
+}
+
+void MemoryPressureDevice::unregister_listener(Badge<MemoryPressureListener>, MemoryPressureListener& listener)
+{
+    InterruptDisabler disabler;
+    m_listeners.remove_first_matching([&](auto* entry) { return entry == &listener; });
+}
+
+MemoryPressureListener::MemoryPressureListener()
+{
+    MemoryPressureDevice::the().register_listener({}, *this);
+}
+
+MemoryPressureListener::~MemoryPressureListener()
+{
+    MemoryPressureDevice::the().unregister_listener({}, *this);
+}
+
+ssize_t MemoryPressureListener::read(FileDescription&, u8* buffer, ssize_t size)
+{
+    if (size < (ssize_t)sizeof(memory_pressure_event))
+        return -EINVAL;
+    memory_pressure_event event;
+    {
+        InterruptDisabler disabler;
+        event.level = MemoryPressureDevice::the().level();
+        event.free_pages = MM.user_physical_pages() - MM.user_physical_pages_used();
+        event.total_pages = MM.user_physical_pages();
+        m_has_event = false;
+    }
+    memcpy(buffer, &event, sizeof(event));
+    return sizeof(event);
+}
+
+}
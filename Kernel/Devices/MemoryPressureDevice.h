@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/Vector.h>
+#include <Kernel/Devices/CharacterDevice.h>
+
+namespace Kernel {
+
+class MemoryPressureListener;
+
+// /dev/mempressure: Lets userspace find out when the kernel is running low on memory,
+// so that it can drop caches before the reclaim daemon has to take things away.
+// Every open() gets its own listener, so each reader sees every level change.
+class MemoryPressureDevice final : public CharacterDevice {
+    AK_MAKE_ETERNAL
+public:
+    MemoryPressureDevice();
+    virtual ~MemoryPressureDevice() override;
+
+    static MemoryPressureDevice& the();
+
+    int level() const { return m_level; }
+    void set_level(int);
+
+    void register_listener(Badge<MemoryPressureListener>, MemoryPressureListener&);
+    void unregister_listener(Badge<MemoryPressureListener>, MemoryPressureListener&);
+
+    // ^CharacterDevice
+    virtual KResultOr<NonnullRefPtr<FileDescription>> open(int options) override;
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return 0; }
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual bool can_read(const FileDescription&) const override { return true; }
+    virtual bool can_write(const FileDescription&) const override { return false; }
+
+private:
+    // ^CharacterDevice
+    virtual const char* class_name() const override { return "MemoryPressureDevice"; }
+
+    int m_level { 0 };
+    Vector<MemoryPressureListener*> m_listeners;
+};
+
+class MemoryPressureListener final : public File {
+public:
+    static NonnullRefPtr<MemoryPressureListener> create() { return adopt(*new MemoryPressureListener); }
+    virtual ~MemoryPressureListener() override;
+
+    void did_change_level() { m_has_event = true; }
+
+private:
+    MemoryPressureListener();
+
+    // ^File
+    virtual bool can_read(const FileDescription&) const override { return m_has_event; }
+    virtual bool can_write(const FileDescription&) const override { return false; }
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "mempressure"; }
+    virtual const char* class_name() const override { return "MemoryPressureListener"; }
+
+    bool m_has_event { false };
+};
+
+}
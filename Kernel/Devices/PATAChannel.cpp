@@ -106,15 +106,6 @@ namespace Kernel {
 
 #define PCI_Mass_Storage_Class 0x1
 #define PCI_IDE_Controller_Subclass 0x1
-static Lock& s_lock()
-{
-    static Lock* lock;
-    if (!lock)
-        lock = new Lock;
-
-    return *lock;
-};
-
 OwnPtr<PATAChannel> PATAChannel::create(ChannelType type, bool force_pio)
 {
     PCI::Address pci_address;
@@ -264,7 +255,7 @@ void PATAChannel::detect_disks()
 
 bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool slave_request)
 {
-    LOCKER(s_lock());
+    LOCKER(m_lock);
 #ifdef PATA_DEBUG
     dbg() << "PATAChannel::ata_read_sectors_with_dma (" << lba << " x" << count << ") -> " << outbuf;
 #endif
@@ -336,7 +327,7 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
 
 bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf, bool slave_request)
 {
-    LOCKER(s_lock());
+    LOCKER(m_lock);
 #ifdef PATA_DEBUG
     dbg() << "PATAChannel::ata_write_sectors_with_dma (" << lba << " x" << count << ") <- " << inbuf;
 #endif
@@ -405,7 +396,7 @@ bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf
 bool PATAChannel::ata_read_sectors(u32 start_sector, u16 count, u8* outbuf, bool slave_request)
 {
     ASSERT(count <= 256);
-    LOCKER(s_lock());
+    LOCKER(m_lock);
 #ifdef PATA_DEBUG
     dbg() << "PATAChannel::ata_read_sectors request (" << count << " sector(s) @ " << start_sector << " into " << outbuf << ")";
 #endif
@@ -459,7 +450,7 @@ bool PATAChannel::ata_read_sectors(u32 start_sector, u16 count, u8* outbuf, bool
 bool PATAChannel::ata_write_sectors(u32 start_sector, u16 count, const u8* inbuf, bool slave_request)
 {
     ASSERT(count <= 256);
-    LOCKER(s_lock());
+    LOCKER(m_lock);
 #ifdef PATA_DEBUG
     klog() << "PATAChannel::ata_write_sectors request (" << count << " sector(s) @ " << start_sector << ")";
 #endif
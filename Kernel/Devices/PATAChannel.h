@@ -95,6 +95,9 @@ private:
     IOAddress m_control_base;
     volatile u8 m_device_error { 0 };
 
+    // Both drives share the channel's registers, but the two channels are independent of each other.
+    Lock m_lock { "PATAChannel" };
+
     WaitQueue m_irq_queue;
 
     PhysicalRegionDescriptor& prdt() { return *reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_page->paddr().offset(0xc0000000).as_ptr()); }
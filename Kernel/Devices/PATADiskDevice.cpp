@@ -24,8 +24,6 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-//#define PATA_DEVICE_DEBUG
-
 #include <AK/Memory.h>
 #include <AK/StringView.h>
 #include <Kernel/Devices/PATAChannel.h>
@@ -80,91 +78,29 @@ void PATADiskDevice::set_drive_geometry(u16 cyls, u16 heads, u16 spt)
     m_sectors_per_track = spt;
 }
 
-ssize_t PATADiskDevice::read(FileDescription& fd, u8* outbuf, ssize_t len)
+unsigned PATADiskDevice::block_count() const
 {
-    unsigned index = fd.offset() / block_size();
-    u16 whole_blocks = len / block_size();
-    ssize_t remaining = len % block_size();
-
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
-        remaining = 0;
-    }
-
-#ifdef PATA_DEVICE_DEBUG
-    klog() << "PATADiskDevice::read() index=" << index << " whole_blocks=" << whole_blocks << " remaining=" << remaining;
-#endif
-
-    if (whole_blocks > 0) {
-        if (!read_blocks(index, whole_blocks, outbuf))
-            return -1;
-    }
-
-    off_t pos = whole_blocks * block_size();
-
-    if (remaining > 0) {
-        auto buf = ByteBuffer::create_uninitialized(block_size());
-        if (!read_blocks(index + whole_blocks, 1, buf.data()))
-            return pos;
-        memcpy(&outbuf[pos], buf.data(), remaining);
-    }
+    return m_cylinders * m_heads * m_sectors_per_track;
+}
 
-    return pos + remaining;
+ssize_t PATADiskDevice::read(FileDescription& description, u8* outbuf, ssize_t len)
+{
+    return read_at_offset(description, description.offset(), outbuf, len);
 }
 
 bool PATADiskDevice::can_read(const FileDescription& fd) const
 {
-    return static_cast<unsigned>(fd.offset()) < (m_cylinders * m_heads * m_sectors_per_track * block_size());
+    return static_cast<unsigned>(fd.offset()) < (block_count() * block_size());
 }
 
-ssize_t PATADiskDevice::write(FileDescription& fd, const u8* inbuf, ssize_t len)
+ssize_t PATADiskDevice::write(FileDescription& description, const u8* inbuf, ssize_t len)
 {
-    unsigned index = fd.offset() / block_size();
-    u16 whole_blocks = len / block_size();
-    ssize_t remaining = len % block_size();
-
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
-        remaining = 0;
-    }
-
-#ifdef PATA_DEVICE_DEBUG
-    klog() << "PATADiskDevice::write() index=" << index << " whole_blocks=" << whole_blocks << " remaining=" << remaining;
-#endif
-
-    if (whole_blocks > 0) {
-        if (!write_blocks(index, whole_blocks, inbuf))
-            return -1;
-    }
-
-    off_t pos = whole_blocks * block_size();
-
-    // since we can only write in block_size() increments, if we want to do a
-    // partial write, we have to read the block's content first, modify it,
-    // then write the whole block back to the disk.
-    if (remaining > 0) {
-        auto buf = ByteBuffer::create_zeroed(block_size());
-        if (!read_blocks(index + whole_blocks, 1, buf.data()))
-            return pos;
-        memcpy(buf.data(), &inbuf[pos], remaining);
-        if (!write_blocks(index + whole_blocks, 1, buf.data()))
-            return pos;
-    }
-
-    return pos + remaining;
+    return write_at_offset(description, description.offset(), inbuf, len);
 }
 
 bool PATADiskDevice::can_write(const FileDescription& fd) const
 {
-    return static_cast<unsigned>(fd.offset()) < (m_cylinders * m_heads * m_sectors_per_track * block_size());
+    return static_cast<unsigned>(fd.offset()) < (block_count() * block_size());
 }
 
 bool PATADiskDevice::read_sectors_with_dma(u32 lba, u16 count, u8* outbuf)
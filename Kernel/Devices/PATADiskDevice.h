@@ -61,6 +61,7 @@ public:
     void set_drive_geometry(u16, u16, u16);
 
     // ^BlockDevice
+    virtual unsigned block_count() const override;
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual bool can_read(const FileDescription&) const override;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
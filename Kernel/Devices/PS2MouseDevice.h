@@ -46,6 +46,7 @@ public:
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
     virtual bool can_write(const FileDescription&) const override { return true; }
+    virtual bool has_readiness_notifications() const override { return true; }
 
     virtual const char* purpose() const override { return class_name(); }
 
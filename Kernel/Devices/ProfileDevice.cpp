@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Devices/ProfileDevice.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+#include <Kernel/Profiling.h>
+#include <LibC/errno_numbers.h>
+#include <LibC/sys/ioctl_numbers.h>
+#include <LibC/sys/profile.h>
+
+namespace Kernel {
+
+ProfileDevice::ProfileDevice()
+    : CharacterDevice(1, 20)
+{
+}
+
+ProfileDevice::~ProfileDevice()
+{
+}
+
+KResultOr<NonnullRefPtr<FileDescription>> ProfileDevice::open(int options)
+{
+    // Samples contain kernel addresses.
+    if (!Process::current->is_superuser())
+        return KResult(-EPERM);
+    if (Profiling::is_streaming())
+        return KResult(-EBUSY);
+    auto description = FileDescription::create(ProfileStream::create());
+    description->set_rw_mode(options);
+    description->set_file_flags(options);
+    return description;
+}
+
+ProfileStream::ProfileStream()
+{
+    Profiling::start_streaming();
+}
+
+ProfileStream::~ProfileStream()
+{
+    Profiling::stop_streaming();
+}
+
+bool ProfileStream::can_read(const FileDescription&) const
+{
+    return Profiling::stream_has_records();
+}
+
+ssize_t ProfileStream::read(FileDescription&, u8* buffer, ssize_t size)
+{
+    if (size <= 0)
+        return -EINVAL;
+    return Profiling::read_stream(buffer, size);
+}
+
+int ProfileStream::ioctl(FileDescription&, unsigned request, unsigned arg)
+{
+    switch (request) {
+    case PROFILE_IOCTL_SET_FREQUENCY:
+        if (!arg)
+            return -EINVAL;
+        Profiling::set_stream_frequency(arg);
+        return 0;
+    case PROFILE_IOCTL_SET_FLAGS:
+        if (arg & ~PROFILE_FLAG_SCAN_STACKS)
+            return -EINVAL;
+        Profiling::set_stream_flags(arg);
+        return 0;
+    }
+    return -EINVAL;
+}
+
+}
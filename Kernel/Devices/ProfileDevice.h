@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Kernel/Devices/CharacterDevice.h>
+
+namespace Kernel {
+
+// /dev/profile: Streams samples of everything running on the system while it's open.
+// See <LibC/sys/profile.h> for what comes out of it.
+class ProfileDevice final : public CharacterDevice {
+    AK_MAKE_ETERNAL
+public:
+    ProfileDevice();
+    virtual ~ProfileDevice() override;
+
+    // ^CharacterDevice
+    virtual KResultOr<NonnullRefPtr<FileDescription>> open(int options) override;
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return 0; }
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual bool can_read(const FileDescription&) const override { return true; }
+    virtual bool can_write(const FileDescription&) const override { return false; }
+
+private:
+    // ^CharacterDevice
+    virtual const char* class_name() const override { return "ProfileDevice"; }
+};
+
+// One open /dev/profile. Sampling runs for as long as this is alive.
+class ProfileStream final : public File {
+public:
+    static NonnullRefPtr<ProfileStream> create() { return adopt(*new ProfileStream); }
+    virtual ~ProfileStream() override;
+
+private:
+    ProfileStream();
+
+    // ^File
+    virtual bool can_read(const FileDescription&) const override;
+    virtual bool can_write(const FileDescription&) const override { return false; }
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual int ioctl(FileDescription&, unsigned request, unsigned arg) override;
+    virtual String absolute_path(const FileDescription&) const override { return "profile"; }
+    virtual const char* class_name() const override { return "ProfileStream"; }
+};
+
+}
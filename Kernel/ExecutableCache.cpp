@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/ExecutableCache.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/AnonymousVMObject.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
+#include <LibBareMetal/StdLib.h>
+#include <LibELF/ELFImage.h>
+
+//#define EXECUTABLE_CACHE_DEBUG
+
+namespace Kernel {
+
+// Enough for the programs that get started over and over (Shell, ls, the usual utilities)
+// without holding on to the data segments of everything that was ever run.
+static const size_t max_cached_image_count = 16;
+
+RefPtr<ExecutableImage> ExecutableImage::create(Inode& inode)
+{
+    auto image = adopt(*new ExecutableImage(inode));
+    if (!image->parse())
+        return nullptr;
+    return image;
+}
+
+ExecutableImage::ExecutableImage(Inode& inode)
+    : m_inode_identifier(inode.identifier())
+    , m_vmobject(SharedInodeVMObject::create_with_inode(inode))
+{
+    auto metadata = inode.metadata();
+    m_image_size = metadata.size;
+    m_mtime = metadata.mtime;
+}
+
+ExecutableImage::~ExecutableImage()
+{
+}
+
+bool ExecutableImage::parse()
+{
+    auto region = MM.allocate_kernel_region_with_vmobject(*m_vmobject, PAGE_ROUND_UP(m_image_size), "ELF parsing", Region::Access::Read);
+    if (!region)
+        return false;
+
+    ELFImage image(region->vaddr().as_ptr(), m_image_size);
+    if (!image.is_valid())
+        return false;
+
+    m_entry = image.entry();
+
+    bool failed = false;
+    image.for_each_program_header([&](const ELFImage::ProgramHeader& program_header) {
+        if (failed)
+            return;
+        if (program_header.type() == PT_TLS) {
+            if (!program_header.size_in_memory())
+                return;
+            if (!image.is_within_image(program_header.raw_data(), program_header.size_in_image())) {
+                dbg() << "Shenanigans! ELF PT_TLS header sneaks outside of executable.";
+                failed = true;
+                return;
+            }
+            m_tls_size = program_header.size_in_memory();
+            m_tls_alignment = program_header.alignment();
+            m_tls_image = ByteBuffer::copy(program_header.raw_data(), program_header.size_in_image());
+            return;
+        }
+        if (program_header.type() != PT_LOAD)
+            return;
+        if (!program_header.size_in_memory() || program_header.alignment() != PAGE_SIZE) {
+            dbg() << "ExecutableImage: Unsupported PT_LOAD header (size " << program_header.size_in_memory() << ", alignment " << program_header.alignment() << ")";
+            failed = true;
+            return;
+        }
+
+        Segment segment;
+        segment.vaddr = program_header.vaddr();
+        segment.size_in_memory = program_header.size_in_memory();
+        segment.offset_in_image = program_header.offset();
+        segment.is_readable = program_header.is_readable();
+        segment.is_writable = program_header.is_writable();
+        segment.is_executable = program_header.is_executable();
+
+        if (segment.is_writable) {
+            if (!image.is_within_image(program_header.raw_data(), program_header.size_in_image())) {
+                dbg() << "Shenanigans! Writable ELF PT_LOAD header sneaks outside of executable.";
+                failed = true;
+                return;
+            }
+            // The segment doesn't have to start on a page boundary, so lay the data out at the
+            // same offset into the first page as it will have once mapped. Pages that are all
+            // .bss are left alone and stay on the shared zero page.
+            size_t offset_in_page = program_header.vaddr().get() & ~PAGE_MASK;
+            auto data = AnonymousVMObject::create_with_size(PAGE_ROUND_UP(offset_in_page + program_header.size_in_memory()));
+            auto data_region = MM.allocate_kernel_region_with_vmobject(*data, data->size(), "ELF data", Region::Access::Read | Region::Access::Write);
+            if (!data_region) {
+                failed = true;
+                return;
+            }
+            size_t initialized_page_count = ceil_div(offset_in_page + program_header.size_in_image(), PAGE_SIZE);
+            for (size_t i = 0; i < initialized_page_count; ++i) {
+                if (!data_region->commit(i)) {
+                    failed = true;
+                    return;
+                }
+            }
+            memcpy(data_region->vaddr().offset(offset_in_page).as_ptr(), program_header.raw_data(), program_header.size_in_image());
+            segment.data = move(data);
+        }
+
+        m_segments.append(move(segment));
+    });
+
+    return !failed;
+}
+
+ExecutableCache& ExecutableCache::the()
+{
+    static ExecutableCache* the;
+    if (!the)
+        the = new ExecutableCache;
+    return *the;
+}
+
+ExecutableCache::ExecutableCache()
+{
+}
+
+RefPtr<ExecutableImage> ExecutableCache::get(Inode& inode)
+{
+    auto metadata = inode.metadata();
+    NonnullRefPtrVector<ExecutableImage> evicted;
+    {
+        LOCKER(m_lock);
+        for (size_t i = 0; i < m_images.size(); ++i) {
+            auto& image = m_images[i];
+            if (image.inode_identifier() != inode.identifier())
+                continue;
+            if (image.image_size() != (size_t)metadata.size || image.mtime() != metadata.mtime) {
+                evicted.append(m_images.take(i));
+                break;
+            }
+            ++m_hits;
+            NonnullRefPtr<ExecutableImage> found = image;
+            if (i != 0) {
+                m_images.remove(i);
+                m_images.prepend(found);
+            }
+            return found;
+        }
+        ++m_misses;
+    }
+
+    // Parse without holding the lock, since reading the inode takes file system locks,
+    // and writes to an inode come back here (with those held) to invalidate it.
+    auto image = ExecutableImage::create(inode);
+    if (!image)
+        return nullptr;
+
+#ifdef EXECUTABLE_CACHE_DEBUG
+    dbg() << "ExecutableCache: Cached " << inode.identifier() << " with " << image->segments().size() << " segment(s)";
+#endif
+
+    {
+        LOCKER(m_lock);
+        m_images.prepend(*image);
+        while (m_images.size() > max_cached_image_count)
+            evicted.append(m_images.take_last());
+    }
+    return image;
+}
+
+void ExecutableCache::invalidate(const Inode& inode)
+{
+    NonnullRefPtrVector<ExecutableImage> evicted;
+    {
+        LOCKER(m_lock);
+        for (size_t i = 0; i < m_images.size();) {
+            if (m_images[i].inode_identifier() == inode.identifier())
+                evicted.append(m_images.take(i));
+            else
+                ++i;
+        }
+    }
+}
+
+void ExecutableCache::invalidate_all_for_fs(unsigned fsid)
+{
+    NonnullRefPtrVector<ExecutableImage> evicted;
+    {
+        LOCKER(m_lock);
+        for (size_t i = 0; i < m_images.size();) {
+            if (m_images[i].inode_identifier().fsid() == fsid)
+                evicted.append(m_images.take(i));
+            else
+                ++i;
+        }
+    }
+}
+
+void ExecutableCache::purge()
+{
+    NonnullRefPtrVector<ExecutableImage> evicted;
+    {
+        LOCKER(m_lock);
+        evicted = move(m_images);
+    }
+}
+
+void ExecutableCache::did_exec(u64 microseconds)
+{
+    // Called at the tail end of exec, possibly with interrupts already disabled.
+    InterruptDisabler disabler;
+    ++m_exec_count;
+    m_total_exec_microseconds += microseconds;
+    m_max_exec_microseconds = max(m_max_exec_microseconds, microseconds);
+}
+
+size_t ExecutableCache::image_count() const
+{
+    LOCKER(m_lock);
+    return m_images.size();
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Lock.h>
+#include <LibBareMetal/Memory/VirtualAddress.h>
+
+namespace Kernel {
+
+class AnonymousVMObject;
+class SharedInodeVMObject;
+
+// Everything exec needs to know about a program, worked out once per executable inode.
+// Read-only segments are mapped straight from the inode's shared VMObject, so all instances
+// share their pages, and writable segments are mapped copy-on-write from pristine copies.
+class ExecutableImage : public RefCounted<ExecutableImage> {
+public:
+    static RefPtr<ExecutableImage> create(Inode&);
+    ~ExecutableImage();
+
+    struct Segment {
+        VirtualAddress vaddr;
+        size_t size_in_memory { 0 };
+        size_t offset_in_image { 0 };
+        bool is_readable { false };
+        bool is_writable { false };
+        bool is_executable { false };
+
+        // For writable segments, the initialized data as it is laid out in memory.
+        RefPtr<AnonymousVMObject> data;
+    };
+
+    InodeIdentifier inode_identifier() const { return m_inode_identifier; }
+    size_t image_size() const { return m_image_size; }
+    time_t mtime() const { return m_mtime; }
+
+    SharedInodeVMObject& vmobject() { return *m_vmobject; }
+    Vector<Segment>& segments() { return m_segments; }
+    const Vector<Segment>& segments() const { return m_segments; }
+    VirtualAddress entry() const { return m_entry; }
+
+    bool has_tls() const { return m_tls_size; }
+    size_t tls_size() const { return m_tls_size; }
+    size_t tls_alignment() const { return m_tls_alignment; }
+    const ByteBuffer& tls_image() const { return m_tls_image; }
+
+private:
+    explicit ExecutableImage(Inode&);
+    bool parse();
+
+    InodeIdentifier m_inode_identifier;
+    size_t m_image_size { 0 };
+    time_t m_mtime { 0 };
+
+    NonnullRefPtr<SharedInodeVMObject> m_vmobject;
+    Vector<Segment> m_segments;
+    VirtualAddress m_entry;
+
+    size_t m_tls_size { 0 };
+    size_t m_tls_alignment { 0 };
+    ByteBuffer m_tls_image;
+};
+
+class ExecutableCache {
+public:
+    static ExecutableCache& the();
+
+    RefPtr<ExecutableImage> get(Inode&);
+    void invalidate(const Inode&);
+    void invalidate_all_for_fs(unsigned fsid);
+    void purge();
+
+    void did_exec(u64 microseconds);
+
+    size_t image_count() const;
+    u32 hits() const { return m_hits; }
+    u32 misses() const { return m_misses; }
+    u32 exec_count() const { return m_exec_count; }
+    u64 total_exec_microseconds() const { return m_total_exec_microseconds; }
+    u64 max_exec_microseconds() const { return m_max_exec_microseconds; }
+
+private:
+    ExecutableCache();
+
+    mutable Lock m_lock { "ExecutableCache" };
+
+    // Most recently used first.
+    NonnullRefPtrVector<ExecutableImage> m_images;
+
+    u32 m_hits { 0 };
+    u32 m_misses { 0 };
+    u32 m_exec_count { 0 };
+    u64 m_total_exec_microseconds { 0 };
+    u64 m_max_exec_microseconds { 0 };
+};
+
+}
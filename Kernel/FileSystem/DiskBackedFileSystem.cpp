@@ -31,6 +31,8 @@
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Process.h>
+#include <Kernel/Thread.h>
+#include <Kernel/WaitQueue.h>
 
 //#define DBFS_DEBUG
 
@@ -106,6 +108,34 @@ public:
             callback(entries()[i]);
     }
 
+    // Gives back every page of cached block data that only holds clean blocks.
+    // Those blocks will simply be read from disk again if they're needed.
+    size_t release_clean_pages()
+    {
+        auto& region = m_cached_block_data.impl().region();
+        size_t block_size = m_fs.block_size();
+        size_t released_page_count = 0;
+        for (size_t page_index = 0; page_index < region.page_count(); ++page_index) {
+            size_t first_entry = (page_index * PAGE_SIZE) / block_size;
+            size_t end_entry = min(m_entry_count, ceil_div((page_index + 1) * PAGE_SIZE, block_size));
+            bool is_clean = true;
+            for (size_t i = first_entry; i < end_entry; ++i) {
+                if (entries()[i].is_dirty) {
+                    is_clean = false;
+                    break;
+                }
+            }
+            if (!is_clean || !region.decommit(page_index))
+                continue;
+            for (size_t i = first_entry; i < end_entry; ++i) {
+                entries()[i].has_data = false;
+                entries()[i].timestamp = 0;
+            }
+            ++released_page_count;
+        }
+        return released_page_count;
+    }
+
 private:
     DiskBackedFS& m_fs;
     size_t m_entry_count { 10000 };
@@ -128,6 +158,7 @@ bool DiskBackedFS::write_block(unsigned index, const u8* data, FileDescription*
 #ifdef DBFS_DEBUG
     klog() << "DiskBackedFileSystem::write_block " << index << ", size=" << data.size();
 #endif
+    LOCKER(m_lock);
 
     bool allow_cache = !description || !description->is_direct();
 
@@ -162,6 +193,7 @@ bool DiskBackedFS::read_block(unsigned index, u8* buffer, FileDescription* descr
 #ifdef DBFS_DEBUG
     klog() << "DiskBackedFileSystem::read_block " << index;
 #endif
+    LOCKER(m_lock);
 
     bool allow_cache = !description || !description->is_direct();
 
@@ -176,9 +208,12 @@ bool DiskBackedFS::read_block(unsigned index, u8* buffer, FileDescription* descr
     auto& entry = cache().get(index);
     if (!entry.has_data) {
         u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size());
-        bool success = device().read_raw(base_offset, block_size(), entry.data);
+        // Someone reading the raw device may have brought this block in already.
+        if (!const_cast<DiskBackedFS*>(this)->device().read_from_cache_if_present(base_offset, block_size(), entry.data)) {
+            bool success = device().read_raw(base_offset, block_size(), entry.data);
+            ASSERT(success);
+        }
         entry.has_data = true;
-        ASSERT(success);
     }
     memcpy(buffer, entry.data, block_size());
     return true;
@@ -220,15 +255,31 @@ void DiskBackedFS::flush_writes_impl()
     LOCKER(m_lock);
     if (!cache().is_dirty())
         return;
+    // Queue every dirty block before waiting for any of them, so the device gets to sort and merge them.
     u32 count = 0;
+    size_t pending_count = 0;
+    WaitQueue wait_queue;
     cache().for_each_entry([&](CacheEntry& entry) {
         if (!entry.is_dirty)
             return;
         u32 base_offset = static_cast<u32>(entry.block_index) * static_cast<u32>(block_size());
-        device().write_raw(base_offset, block_size(), entry.data);
+        {
+            InterruptDisabler disabler;
+            ++pending_count;
+        }
+        device().write_raw_async(base_offset, block_size(), entry.data, [&](bool) {
+            InterruptDisabler disabler;
+            if (!--pending_count)
+                wait_queue.wake_all();
+        });
         ++count;
         entry.is_dirty = false;
     });
+    {
+        InterruptDisabler disabler;
+        while (pending_count)
+            Thread::current->wait_on(wait_queue);
+    }
     cache().set_dirty(false);
     dbg() << class_name() << ": Flushed " << count << " blocks to disk";
 }
@@ -238,6 +289,14 @@ void DiskBackedFS::flush_writes()
     flush_writes_impl();
 }
 
+size_t DiskBackedFS::release_clean_cache_pages()
+{
+    LOCKER(m_lock);
+    if (!m_cache)
+        return 0;
+    return m_cache->release_clean_pages();
+}
+
 DiskCache& DiskBackedFS::cache() const
 {
     if (!m_cache)
@@ -41,6 +41,7 @@ public:
     const BlockDevice& device() const { return *m_device; }
 
     virtual void flush_writes() override;
+    virtual size_t release_clean_cache_pages() override;
 
     void flush_writes_impl();
 
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <LibC/errno_numbers.h>
+
+namespace Kernel {
+
+NonnullRefPtr<EPoll> EPoll::create()
+{
+    return adopt(*new EPoll);
+}
+
+EPoll::EPoll()
+{
+}
+
+EPoll::~EPoll()
+{
+    InterruptDisabler disabler;
+    m_ready_entries.clear();
+    m_entries.clear();
+}
+
+KResult EPoll::add(int fd, FileDescription& description, const epoll_event& event)
+{
+    if (&description.file() == this)
+        return KResult(-EINVAL);
+    auto it = m_entries.find(fd);
+    if (it != m_entries.end()) {
+        if (&(*it).value->description() == &description)
+            return KResult(-EEXIST);
+        // The fd was closed and reused while the old description lived on elsewhere.
+        m_entries.remove(it);
+    }
+    auto entry = make<Entry>(*this, fd, description, event);
+    enqueue(*entry);
+    m_entries.set(fd, move(entry));
+    return KSuccess;
+}
+
+KResult EPoll::modify(int fd, FileDescription& description, const epoll_event& event)
+{
+    auto it = m_entries.find(fd);
+    if (it == m_entries.end() || &(*it).value->description() != &description)
+        return KResult(-ENOENT);
+    auto& entry = *(*it).value;
+    entry.update(event);
+    enqueue(entry);
+    return KSuccess;
+}
+
+KResult EPoll::remove(int fd, FileDescription& description)
+{
+    auto it = m_entries.find(fd);
+    if (it == m_entries.end() || &(*it).value->description() != &description)
+        return KResult(-ENOENT);
+    m_entries.remove(it);
+    return KSuccess;
+}
+
+void EPoll::enqueue(Entry& entry)
+{
+    InterruptDisabler disabler;
+    if (entry.is_disabled() || m_ready_entries.contains(entry))
+        return;
+    m_ready_entries.append(entry);
+    notify_readiness_observers();
+}
+
+bool EPoll::has_pending_events() const
+{
+    InterruptDisabler disabler;
+    for (auto it = m_ready_entries.begin(); it != m_ready_entries.end();) {
+        auto& entry = *it;
+        u32 ready_events = entry.ready_events();
+        if (entry.is_polled() && entry.is_edge_triggered())
+            ready_events &= ~entry.last_ready_events();
+        if (ready_events)
+            return true;
+        // Not ready after all. Notifying Files will put the entry back when this changes.
+        if (!entry.is_polled())
+            it.erase();
+        else
+            ++it;
+    }
+    return false;
+}
+
+void EPoll::collect_pending_events(Vector<epoll_event>& events, size_t max_events)
+{
+    InterruptDisabler disabler;
+
+    // Move everything to a local list first, so that entries we keep around
+    // can be requeued behind the ones we haven't looked at yet.
+    EntryList pending;
+    EntryList requeue;
+    while (auto* entry = m_ready_entries.take_first())
+        pending.append(*entry);
+
+    while (events.size() < max_events) {
+        auto* entry = pending.take_first();
+        if (!entry)
+            break;
+
+        u32 ready_events = entry->ready_events();
+        u32 reported_events = ready_events;
+        if (entry->is_polled() && entry->is_edge_triggered()) {
+            reported_events &= ~entry->last_ready_events();
+            entry->set_last_ready_events(ready_events);
+        }
+
+        if (!reported_events) {
+            if (entry->is_polled())
+                requeue.append(*entry);
+            continue;
+        }
+
+        epoll_event event;
+        event.events = reported_events;
+        event.data = entry->data();
+        events.append(event);
+
+        if (entry->is_one_shot()) {
+            entry->set_disabled();
+            continue;
+        }
+        if (entry->is_edge_triggered() && !entry->is_polled())
+            continue;
+        // Level-triggered: keep reporting until the File is no longer ready.
+        requeue.append(*entry);
+    }
+
+    while (auto* entry = pending.take_first())
+        m_ready_entries.append(*entry);
+    while (auto* entry = requeue.take_first())
+        m_ready_entries.append(*entry);
+}
+
+EPoll::Entry::Entry(EPoll& epoll, int fd, FileDescription& description, const epoll_event& event)
+    : m_epoll(epoll)
+    , m_fd(fd)
+    , m_description(description)
+    , m_event(event)
+{
+    m_description.register_readiness_observer(*this);
+}
+
+EPoll::Entry::~Entry()
+{
+    m_description.unregister_readiness_observer(*this);
+}
+
+void EPoll::Entry::update(const epoll_event& event)
+{
+    InterruptDisabler disabler;
+    m_event = event;
+    m_last_ready_events = 0;
+    m_disabled = false;
+}
+
+u32 EPoll::Entry::ready_events() const
+{
+    u32 ready_events = 0;
+    if ((m_event.events & EPOLLIN) && m_description.can_read())
+        ready_events |= EPOLLIN;
+    if ((m_event.events & EPOLLOUT) && m_description.can_write())
+        ready_events |= EPOLLOUT;
+    // These are always reported, like epoll(7) says.
+    auto& file = m_description.file();
+    if (file.is_hung_up(m_description))
+        ready_events |= EPOLLHUP;
+    if (file.has_pending_error(m_description))
+        ready_events |= EPOLLERR;
+    return ready_events;
+}
+
+bool EPoll::Entry::is_polled() const
+{
+    return !m_description.file().has_readiness_notifications();
+}
+
+void EPoll::Entry::readiness_may_have_changed()
+{
+    m_epoll.enqueue(*this);
+}
+
+void EPoll::Entry::description_will_die()
+{
+    m_epoll.m_entries.remove(m_fd);
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// EPoll is a persistent set of file descriptions that a process is interested in.
+//
+// Unlike select() and poll(), registrations survive between waits. Each entry
+// observes its File, and is put on the ready list when the File says it may
+// have become ready. A wait then only has to look at the ready list.
+//
+// Entries for Files without readiness notifications stay on the ready list
+// permanently, so they are effectively polled on every wait.
+
+class EPoll final : public File {
+public:
+    static NonnullRefPtr<EPoll> create();
+    virtual ~EPoll() override;
+
+    KResult add(int fd, FileDescription&, const epoll_event&);
+    KResult modify(int fd, FileDescription&, const epoll_event&);
+    KResult remove(int fd, FileDescription&);
+
+    bool has_pending_events() const;
+    void collect_pending_events(Vector<epoll_event>&, size_t max_events);
+
+    // ^File
+    virtual bool can_read(const FileDescription&) const override { return has_pending_events(); }
+    virtual bool can_write(const FileDescription&) const override { return false; }
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return -EINVAL; }
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual const char* class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+    virtual bool has_readiness_notifications() const override { return true; }
+
+private:
+    EPoll();
+
+    class Entry final : public ReadinessObserver {
+    public:
+        Entry(EPoll&, int fd, FileDescription&, const epoll_event&);
+        virtual ~Entry() override;
+
+        int fd() const { return m_fd; }
+        FileDescription& description() { return m_description; }
+
+        void update(const epoll_event&);
+        u32 ready_events() const;
+        bool is_polled() const;
+        bool is_edge_triggered() const { return m_event.events & EPOLLET; }
+        bool is_one_shot() const { return m_event.events & EPOLLONESHOT; }
+        bool is_disabled() const { return m_disabled; }
+        void set_disabled() { m_disabled = true; }
+
+        u32 last_ready_events() const { return m_last_ready_events; }
+        void set_last_ready_events(u32 events) { m_last_ready_events = events; }
+
+        const epoll_data_t& data() const { return m_event.data; }
+
+        // ^ReadinessObserver
+        virtual void readiness_may_have_changed() override;
+        virtual void description_will_die() override;
+
+        IntrusiveListNode m_ready_list_node;
+
+    private:
+        EPoll& m_epoll;
+        int m_fd { -1 };
+        FileDescription& m_description;
+        epoll_event m_event;
+        u32 m_last_ready_events { 0 };
+        bool m_disabled { false };
+    };
+
+    void enqueue(Entry&);
+
+    typedef IntrusiveList<Entry, &Entry::m_ready_list_node> EntryList;
+
+    HashMap<int, NonnullOwnPtr<Entry>> m_entries;
+    mutable EntryList m_ready_entries;
+};
+
+}
@@ -44,6 +44,8 @@ namespace Kernel {
 static const size_t max_link_count = 65535;
 static const size_t max_block_size = 4096;
 static const ssize_t max_inline_symlink_length = 60;
+static const size_t max_unused_inode_bytes = 2 * MB;
+static const size_t append_preallocation_blocks = 16;
 
 static u8 to_ext2_file_type(mode_t mode)
 {
@@ -128,6 +130,8 @@ bool Ext2FS::initialize()
         return false;
     }
 
+    m_group_hints.resize(m_block_group_count);
+
     unsigned blocks_to_read = ceil_div(m_block_group_count * (unsigned)sizeof(ext2_group_desc), block_size());
     BlockIndex first_block_of_bgdt = block_size() == 1024 ? 2 : 1;
     m_cached_group_descriptor_table = KBuffer::create_with_size(block_size() * blocks_to_read, Region::Access::Read | Region::Access::Write, "Ext2FS: Block group descriptors");
@@ -516,6 +520,12 @@ void Ext2FS::flush_block_group_descriptor_table()
 void Ext2FS::flush_writes()
 {
     LOCKER(m_lock);
+    // Preallocated blocks are marked as used in the bitmaps, so hand them back before
+    // those go out. Otherwise a crash (or an inode that stays cached) leaks them on disk.
+    for (auto& it : m_inode_cache) {
+        if (it.value)
+            it.value->discard_preallocated_blocks();
+    }
     if (m_super_block_dirty) {
         flush_super_block();
         m_super_block_dirty = false;
@@ -524,7 +534,8 @@ void Ext2FS::flush_writes()
         flush_block_group_descriptor_table();
         m_block_group_descriptors_dirty = false;
     }
-    for (auto& cached_bitmap : m_cached_bitmaps) {
+    for (auto& it : m_cached_bitmaps) {
+        auto& cached_bitmap = it.value;
         if (cached_bitmap->dirty) {
             write_block(cached_bitmap->bitmap_block_index, cached_bitmap->buffer.data());
             cached_bitmap->dirty = false;
@@ -536,22 +547,75 @@ void Ext2FS::flush_writes()
 
     DiskBackedFS::flush_writes();
 
-    // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
-    // We don't uncache Inodes that are being watched by at least one InodeWatcher.
+    evict_unused_inodes(max_unused_inode_bytes);
+}
+
+void Ext2FS::inode_became_unused(Ext2FSInode& inode)
+{
+    LOCKER(m_lock);
+    // Someone may have picked the inode up again while we were waiting for the lock.
+    if (inode.ref_count() != 1 || inode.m_unused_list_node.is_in_list())
+        return;
 
-    // FIXME: It would be better to keep a capped number of Inodes around.
-    //        The problem is that they are quite heavy objects, and use a lot of heap memory
-    //        for their (child name lookup) and (block list) caches.
-    Vector<InodeIndex> unused_inodes;
+    inode.discard_preallocated_blocks();
+
+    // Nothing refers to a deleted inode anymore, so let it go (and free it on disk) right away.
+    if (inode.m_raw_inode.i_links_count == 0) {
+        uncache_inode(inode.index());
+        return;
+    }
+
+    // Inodes that are being watched stay around for as long as they're watched.
+    if (inode.has_watchers())
+        return;
+
+    inode.m_unused_footprint = inode.memory_footprint();
+    m_unused_inode_bytes += inode.m_unused_footprint;
+    m_unused_inodes.append(inode);
+    evict_unused_inodes(max_unused_inode_bytes);
+}
+
+void Ext2FS::inode_became_used(Ext2FSInode& inode)
+{
+    LOCKER(m_lock);
+    if (!inode.m_unused_list_node.is_in_list())
+        return;
+    m_unused_inodes.remove(inode);
+    m_unused_inode_bytes -= inode.m_unused_footprint;
+}
+
+void Ext2FS::evict_unused_inodes(size_t max_bytes)
+{
+    LOCKER(m_lock);
+    while (m_unused_inode_bytes > max_bytes) {
+        auto* inode = m_unused_inodes.first();
+        ASSERT(inode);
+        inode_became_used(*inode);
+        if (inode->is_metadata_dirty())
+            inode->flush_metadata();
+        ++m_inode_cache_evictions;
+        uncache_inode(inode->index());
+    }
+}
+
+size_t Ext2FS::cached_inode_count() const
+{
+    LOCKER(m_lock);
+    size_t count = 0;
     for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() != 1)
-            continue;
-        if (it.value->has_watchers())
-            continue;
-        unused_inodes.append(it.key);
+        if (it.value)
+            ++count;
     }
-    for (auto index : unused_inodes)
-        uncache_inode(index);
+    return count;
+}
+
+size_t Ext2FS::unused_inode_count() const
+{
+    LOCKER(m_lock);
+    size_t count = 0;
+    for (auto it = m_unused_inodes.begin(); it != m_unused_inodes.end(); ++it)
+        ++count;
+    return count;
 }
 
 Ext2FSInode::Ext2FSInode(Ext2FS& fs, unsigned index)
@@ -561,10 +625,22 @@ Ext2FSInode::Ext2FSInode(Ext2FS& fs, unsigned index)
 
 Ext2FSInode::~Ext2FSInode()
 {
+    if (m_unused_list_node.is_in_list())
+        fs().inode_became_used(*this);
+    discard_preallocated_blocks();
     if (m_raw_inode.i_links_count == 0)
         fs().free_inode(*this);
 }
 
+size_t Ext2FSInode::memory_footprint() const
+{
+    // A rough estimate of the heap memory we're holding on to, block list and lookup cache included.
+    size_t footprint = sizeof(*this) + m_block_list.capacity() * sizeof(unsigned);
+    for (auto& it : m_lookup_cache)
+        footprint += sizeof(it) + sizeof(StringImpl) + it.key.length() + 1;
+    return footprint;
+}
+
 InodeMetadata Ext2FSInode::metadata() const
 {
     LOCKER(m_lock);
@@ -616,10 +692,16 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 
     {
         auto it = m_inode_cache.find(inode.index());
-        if (it != m_inode_cache.end())
+        if (it != m_inode_cache.end()) {
+            ++m_inode_cache_hits;
+            if ((*it).value)
+                const_cast<Ext2FS&>(*this).inode_became_used(*(*it).value);
             return (*it).value;
+        }
     }
 
+    ++m_inode_cache_misses;
+
     if (!get_inode_allocation_state(inode.index())) {
         m_inode_cache.set(inode.index(), nullptr);
         return nullptr;
@@ -638,18 +720,35 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 }
 
 ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDescription* description) const
+{
+    iovec vec { buffer, (size_t)count };
+    return read_bytes_vectored(offset, &vec, 1, description);
+}
+
+ssize_t Ext2FSInode::read_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description) const
 {
     Locker inode_locker(m_lock);
     ASSERT(offset >= 0);
     if (m_raw_inode.i_size == 0)
         return 0;
+    if (offset >= (off_t)size())
+        return 0;
+
+    size_t count = 0;
+    for (int i = 0; i < iov_count; ++i)
+        count += iov[i].iov_len;
 
     // Symbolic links shorter than 60 characters are store inline inside the i_block array.
     // This avoids wasting an entire block on short links. (Most links are short.)
     if (is_symlink() && size() < max_inline_symlink_length) {
         ASSERT(offset == 0);
-        ssize_t nread = min((off_t)size() - offset, static_cast<off_t>(count));
-        memcpy(buffer, ((const u8*)m_raw_inode.i_block) + offset, (size_t)nread);
+        const u8* inline_data = (const u8*)m_raw_inode.i_block;
+        size_t nread = 0;
+        for (int i = 0; i < iov_count && nread < size(); ++i) {
+            size_t num_bytes_to_copy = min(size() - nread, iov[i].iov_len);
+            memcpy(iov[i].iov_base, inline_data + nread, num_bytes_to_copy);
+            nread += num_bytes_to_copy;
+        }
         return nread;
     }
 
@@ -674,10 +773,13 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
     ssize_t nread = 0;
     size_t remaining_count = min((off_t)count, (off_t)size() - offset);
-    u8* out = buffer;
+
+    // Position in the caller's segments. Each block is read once, even if it straddles several segments.
+    int vec_index = 0;
+    size_t offset_into_vec = 0;
 
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: Reading up to " << count << " bytes " << offset << " bytes into inode " << identifier() << " to " << (const void*)buffer;
+    dbg() << "Ext2FS: Reading up to " << count << " bytes " << offset << " bytes into inode " << identifier() << " to " << iov_count << " segment(s)";
 #endif
 
     u8 block[max_block_size];
@@ -693,16 +795,39 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min(block_size - offset_into_block, remaining_count);
-        memcpy(out, block + offset_into_block, num_bytes_to_copy);
+        const u8* in = block + offset_into_block;
         remaining_count -= num_bytes_to_copy;
         nread += num_bytes_to_copy;
-        out += num_bytes_to_copy;
+
+        while (num_bytes_to_copy) {
+            ASSERT(vec_index < iov_count);
+            auto& vec = iov[vec_index];
+            size_t chunk_size = min(num_bytes_to_copy, vec.iov_len - offset_into_vec);
+            memcpy((u8*)vec.iov_base + offset_into_vec, in, chunk_size);
+            in += chunk_size;
+            num_bytes_to_copy -= chunk_size;
+            offset_into_vec += chunk_size;
+            if (offset_into_vec == vec.iov_len) {
+                ++vec_index;
+                offset_into_vec = 0;
+            }
+        }
     }
 
     return nread;
 }
 
-KResult Ext2FSInode::resize(u64 new_size)
+void Ext2FSInode::discard_preallocated_blocks()
+{
+    if (m_preallocated_blocks.is_empty())
+        return;
+    LOCKER(fs().m_lock);
+    for (auto block_index : m_preallocated_blocks)
+        fs().set_block_allocation_state(block_index, false);
+    m_preallocated_blocks.clear();
+}
+
+KResult Ext2FSInode::resize(u64 new_size, bool should_preallocate)
 {
     u64 old_size = size();
     if (old_size == new_size)
@@ -719,15 +844,44 @@ KResult Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         u32 additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().super_block().s_free_blocks_count + m_preallocated_blocks.size())
             return KResult(-ENOSPC);
     }
 
     auto block_list = fs().block_list_for_inode(m_raw_inode);
     if (blocks_needed_after > blocks_needed_before) {
-        auto new_blocks = fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before);
+        size_t new_block_count = blocks_needed_after - blocks_needed_before;
+        Vector<unsigned> new_blocks;
+        new_blocks.ensure_capacity(new_block_count);
+        while (new_blocks.size() < new_block_count && !m_preallocated_blocks.is_empty())
+            new_blocks.unchecked_append(m_preallocated_blocks.take_first());
+
+        if (new_blocks.size() < new_block_count) {
+            // Ask for the new blocks right after the last one we have, so the file stays contiguous.
+            unsigned goal = 0;
+            if (!new_blocks.is_empty())
+                goal = new_blocks.last() + 1;
+            for (size_t i = block_list.size(); !goal && i > 0; --i) {
+                if (block_list[i - 1])
+                    goal = block_list[i - 1] + 1;
+            }
+
+            size_t count = new_block_count - new_blocks.size();
+            size_t preallocation_count = 0;
+            if (should_preallocate)
+                preallocation_count = min(append_preallocation_blocks, (size_t)fs().super_block().s_free_blocks_count - count);
+
+            auto allocated_blocks = fs().allocate_blocks(fs().group_index_from_inode(index()), count + preallocation_count, goal);
+            for (size_t i = 0; i < allocated_blocks.size(); ++i) {
+                if (i < count)
+                    new_blocks.unchecked_append(allocated_blocks[i]);
+                else
+                    m_preallocated_blocks.append(allocated_blocks[i]);
+            }
+        }
         block_list.append(move(new_blocks));
     } else if (blocks_needed_after < blocks_needed_before) {
+        discard_preallocated_blocks();
 #ifdef EXT2_DEBUG
         dbg() << "Ext2FS: Shrinking inode " << identifier() << ". Old block list is " << block_list.size() << " entries:";
         for (auto block_index : block_list) {
@@ -752,6 +906,27 @@ KResult Ext2FSInode::resize(u64 new_size)
     return KSuccess;
 }
 
+ssize_t Ext2FSInode::write_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description)
+{
+    ASSERT(offset >= 0);
+
+    Locker inode_locker(m_lock);
+    Locker fs_locker(fs().m_lock);
+
+    if (!is_symlink()) {
+        // Grow the inode to its final size up front, so new blocks are allocated (and the
+        // block list is rebuilt) once, rather than once per segment.
+        u64 count = 0;
+        for (int i = 0; i < iov_count; ++i)
+            count += iov[i].iov_len;
+        auto resize_result = resize(max(static_cast<u64>(offset) + count, (u64)size()), description && description->should_append());
+        if (resize_result.is_error())
+            return resize_result;
+    }
+
+    return Inode::write_bytes_vectored(offset, iov, iov_count, description);
+}
+
 ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, FileDescription* description)
 {
     ASSERT(offset >= 0);
@@ -778,7 +953,7 @@ ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, Fi
     u64 old_size = size();
     u64 new_size = max(static_cast<u64>(offset) + count, (u64)size());
 
-    auto resize_result = resize(new_size);
+    auto resize_result = resize(new_size, description && description->should_append());
     if (resize_result.is_error())
         return resize_result;
 
@@ -1050,65 +1225,125 @@ bool Ext2FS::write_ext2_inode(unsigned inode, const ext2_inode& e2inode)
     return success;
 }
 
-Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count)
+unsigned Ext2FS::blocks_in_group(GroupIndex group_index) const
 {
-    LOCKER(m_lock);
-#ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: allocate_blocks(preferred group: " << preferred_group_index << ", count: " << count << ")";
-#endif
-    if (count == 0)
-        return {};
+    BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
+    return min(blocks_per_group(), super_block().s_blocks_count - first_block_in_group);
+}
 
-    Vector<BlockIndex> blocks;
+size_t Ext2FS::allocate_block_run(GroupIndex group_index, unsigned first_bit, size_t count, Vector<BlockIndex>& blocks)
+{
+    LOCKER(m_lock);
+    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+    auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
+    auto block_bitmap = cached_bitmap.bitmap(blocks_per_group());
+    unsigned end = blocks_in_group(group_index);
+    BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
+
+    size_t allocated = 0;
+    for (unsigned bit_index = first_bit; bit_index < end && allocated < count && !block_bitmap.get(bit_index); ++bit_index) {
+        block_bitmap.set(bit_index, true);
+        blocks.append(first_block_in_group + bit_index);
 #ifdef EXT2_DEBUG
-    dbg() << "Ext2FS: allocate_blocks:";
+        dbg() << "  allocated > " << blocks.last();
 #endif
-    blocks.ensure_capacity(count);
+        ++allocated;
+    }
+    if (!allocated)
+        return 0;
 
-    GroupIndex group_index = preferred_group_index;
+    // Account for the whole run at once instead of going through set_block_allocation_state() per block.
+    cached_bitmap.dirty = true;
+    m_super_block.s_free_blocks_count -= allocated;
+    m_super_block_dirty = true;
+    bgd.bg_free_blocks_count -= allocated;
+    m_block_group_descriptors_dirty = true;
 
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
-        group_index = 1;
-    }
+    auto& hints = group_hints(group_index);
+    if (hints.next_free_block >= first_bit && hints.next_free_block < first_bit + allocated)
+        hints.next_free_block = first_bit + allocated;
+    return allocated;
+}
 
-    while (blocks.size() < count) {
-
-        bool found_a_group = false;
-        if (group_descriptor(group_index).bg_free_blocks_count) {
-            found_a_group = true;
-        } else {
-            if (group_index == preferred_group_index)
-                group_index = 1;
-            for (; group_index < m_block_group_count; ++group_index) {
-                if (group_descriptor(group_index).bg_free_blocks_count) {
-                    found_a_group = true;
+void Ext2FS::allocate_blocks_in_group(GroupIndex group_index, size_t count, Vector<BlockIndex>& blocks)
+{
+    LOCKER(m_lock);
+    auto& bgd = group_descriptor(group_index);
+    auto block_bitmap = get_bitmap_block(bgd.bg_block_bitmap).bitmap(blocks_per_group());
+    unsigned end = blocks_in_group(group_index);
+    auto& hints = group_hints(group_index);
+
+    while (count && bgd.bg_free_blocks_count) {
+        // Take the first free run that fits the whole request, or failing that, the longest one there is.
+        unsigned best_start = 0;
+        size_t best_length = 0;
+        bool found_first_free = false;
+        unsigned bit_index = hints.next_free_block;
+        while (bit_index < end) {
+            if (!(bit_index % 8) && bit_index + 8 <= end && block_bitmap.data()[bit_index / 8] == 0xff) {
+                bit_index += 8;
+                continue;
+            }
+            if (block_bitmap.get(bit_index)) {
+                ++bit_index;
+                continue;
+            }
+            if (!found_first_free) {
+                hints.next_free_block = bit_index;
+                found_first_free = true;
+            }
+            unsigned run_start = bit_index;
+            while (bit_index < end && bit_index - run_start < count && !block_bitmap.get(bit_index))
+                ++bit_index;
+            size_t run_length = bit_index - run_start;
+            if (run_length > best_length) {
+                best_start = run_start;
+                best_length = run_length;
+                if (run_length == count)
                     break;
-                }
             }
         }
 
-        ASSERT(found_a_group);
-        auto& bgd = group_descriptor(group_index);
-        auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
-
-        int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
-        auto block_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), blocks_in_group);
+        if (!best_length) {
+            klog() << "Ext2FS: Group " << group_index << " claims " << bgd.bg_free_blocks_count << " free blocks, but its bitmap is full";
+            hints.next_free_block = end;
+            return;
+        }
 
-        BlockIndex first_block_in_group = (group_index - 1) * blocks_per_group() + first_block_index();
-        size_t free_region_size = 0;
-        auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
-        ASSERT(first_unset_bit_index.has_value());
 #ifdef EXT2_DEBUG
-        dbg() << "Ext2FS: allocating free region of size: " << free_region_size << "[" << group_index << "]";
+        dbg() << "Ext2FS: allocating free region of size: " << best_length << "[" << group_index << "]";
 #endif
-        for (size_t i = 0; i < free_region_size; ++i) {
-            BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group;
-            set_block_allocation_state(block_index, true);
-            blocks.unchecked_append(block_index);
+        count -= allocate_block_run(group_index, best_start, best_length, blocks);
+    }
+}
+
+Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal)
+{
+    LOCKER(m_lock);
 #ifdef EXT2_DEBUG
-            dbg() << "  allocated > " << block_index;
+    dbg() << "Ext2FS: allocate_blocks(preferred group: " << preferred_group_index << ", count: " << count << ", goal: " << goal << ")";
 #endif
-        }
+    if (count == 0)
+        return {};
+
+    Vector<BlockIndex> blocks;
+    blocks.ensure_capacity(count);
+
+    // If the caller knows where its data ends, try to carry on right from there.
+    if (goal && goal >= first_block_index() && goal < super_block().s_blocks_count) {
+        GroupIndex goal_group_index = group_index_from_block_index(goal);
+        unsigned bit_index = (goal - first_block_index()) - ((goal_group_index - 1) * blocks_per_group());
+        allocate_block_run(goal_group_index, bit_index, count, blocks);
+        preferred_group_index = goal_group_index;
+    }
+
+    if (!preferred_group_index)
+        preferred_group_index = 1;
+
+    for (unsigned i = 0; i < m_block_group_count && blocks.size() < count; ++i) {
+        GroupIndex group_index = (preferred_group_index - 1 + i) % m_block_group_count + 1;
+        if (group_descriptor(group_index).bg_free_blocks_count)
+            allocate_blocks_in_group(group_index, count - blocks.size(), blocks);
     }
 
     ASSERT(blocks.size() == count);
@@ -1163,9 +1398,11 @@ unsigned Ext2FS::find_a_free_inode(GroupIndex preferred_group, off_t expected_si
 
     auto& cached_bitmap = get_bitmap_block(bgd.bg_inode_bitmap);
     auto inode_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), inodes_in_group);
-    for (size_t i = 0; i < inode_bitmap.size(); ++i) {
+    auto& hints = group_hints(group_index);
+    for (size_t i = hints.next_free_inode; i < inode_bitmap.size(); ++i) {
         if (inode_bitmap.get(i))
             continue;
+        hints.next_free_inode = i;
         first_free_inode_in_group = first_inode_in_group + i;
         break;
     }
@@ -1188,7 +1425,7 @@ Ext2FS::GroupIndex Ext2FS::group_index_from_block_index(BlockIndex block_index)
 {
     if (!block_index)
         return 0;
-    return (block_index - 1) / blocks_per_group() + 1;
+    return (block_index - first_block_index()) / blocks_per_group() + 1;
 }
 
 unsigned Ext2FS::group_index_from_inode(unsigned inode) const
@@ -1235,6 +1472,12 @@ bool Ext2FS::set_inode_allocation_state(InodeIndex inode_index, bool new_state)
     cached_bitmap.bitmap(inodes_per_group()).set(bit_index, new_state);
     cached_bitmap.dirty = true;
 
+    auto& hints = group_hints(group_index);
+    if (!new_state && bit_index < hints.next_free_inode)
+        hints.next_free_inode = bit_index;
+    else if (new_state && bit_index == hints.next_free_inode)
+        ++hints.next_free_inode;
+
     // Update superblock
 #ifdef EXT2_DEBUG
     dbg() << "Ext2FS: superblock free inode count " << m_super_block.s_free_inodes_count << " -> " << (m_super_block.s_free_inodes_count - 1);
@@ -1266,16 +1509,17 @@ Ext2FS::BlockIndex Ext2FS::first_block_index() const
 
 Ext2FS::CachedBitmap& Ext2FS::get_bitmap_block(BlockIndex bitmap_block_index)
 {
-    for (auto& cached_bitmap : m_cached_bitmaps) {
-        if (cached_bitmap->bitmap_block_index == bitmap_block_index)
-            return *cached_bitmap;
-    }
+    auto it = m_cached_bitmaps.find(bitmap_block_index);
+    if (it != m_cached_bitmaps.end())
+        return *it->value;
 
     auto block = KBuffer::create_with_size(block_size(), Region::Access::Read | Region::Access::Write, "Ext2FS: Cached bitmap block");
     bool success = read_block(bitmap_block_index, block.data());
     ASSERT(success);
-    m_cached_bitmaps.append(make<CachedBitmap>(bitmap_block_index, move(block)));
-    return *m_cached_bitmaps.last();
+    auto cached_bitmap = make<CachedBitmap>(bitmap_block_index, move(block));
+    auto& cached_bitmap_ref = *cached_bitmap;
+    m_cached_bitmaps.set(bitmap_block_index, move(cached_bitmap));
+    return cached_bitmap_ref;
 }
 
 bool Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
@@ -1306,6 +1550,12 @@ bool Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
     cached_bitmap.bitmap(blocks_per_group()).set(bit_index, new_state);
     cached_bitmap.dirty = true;
 
+    auto& hints = group_hints(group_index);
+    if (!new_state && bit_index < hints.next_free_block)
+        hints.next_free_block = bit_index;
+    else if (new_state && bit_index == hints.next_free_block)
+        ++hints.next_free_block;
+
     // Update superblock
 #ifdef EXT2_DEBUG
     dbg() << "Ext2FS: superblock free block count " << m_super_block.s_free_blocks_count << " -> " << (m_super_block.s_free_blocks_count - 1);
@@ -1488,7 +1738,7 @@ RefPtr<Inode> Ext2FSInode::lookup(StringView name)
 
 void Ext2FSInode::one_ref_left()
 {
-    // FIXME: I would like to not live forever, but uncached Ext2FS is fucking painful right now.
+    fs().inode_became_unused(*this);
 }
 
 int Ext2FSInode::set_atime(time_t t)
@@ -1583,7 +1833,8 @@ KResult Ext2FSInode::chown(uid_t uid, gid_t gid)
 
 KResult Ext2FSInode::truncate(u64 size)
 {
-    LOCKER(m_lock);
+    Locker inode_locker(m_lock);
+    Locker fs_locker(fs().m_lock);
     if (static_cast<u64>(m_raw_inode.i_size) == size)
         return KSuccess;
     auto result = resize(size);
@@ -1622,10 +1873,11 @@ KResult Ext2FS::prepare_to_unmount() const
     LOCKER(m_lock);
 
     for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() > 1)
+        if (it.value && it.value->ref_count() > 1)
             return KResult(-EBUSY);
     }
 
+    const_cast<Ext2FS&>(*this).evict_unused_inodes(0);
     m_inode_cache.clear();
     return KSuccess;
 }
@@ -28,6 +28,7 @@
 
 #include <AK/Bitmap.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
 #include <Kernel/FileSystem/DiskBackedFileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/ext2_fs.h>
@@ -58,11 +59,13 @@ public:
 private:
     // ^Inode
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const override;
+    virtual ssize_t read_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) const override;
     virtual InodeMetadata metadata() const override;
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const override;
     virtual RefPtr<Inode> lookup(StringView name) override;
     virtual void flush_metadata() override;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* data, FileDescription*) override;
+    virtual ssize_t write_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) override;
     virtual KResult add_child(InodeIdentifier child_id, const StringView& name, mode_t) override;
     virtual KResult remove_child(const StringView& name) override;
     virtual int set_atime(time_t) override;
@@ -77,15 +80,27 @@ private:
 
     bool write_directory(const Vector<FS::DirectoryEntry>&);
     void populate_lookup_cache() const;
-    KResult resize(u64);
+    KResult resize(u64, bool should_preallocate = false);
+    void discard_preallocated_blocks();
 
     Ext2FS& fs();
     const Ext2FS& fs() const;
     Ext2FSInode(Ext2FS&, unsigned index);
 
+    size_t memory_footprint() const;
+
     mutable Vector<unsigned> m_block_list;
     mutable HashMap<String, unsigned> m_lookup_cache;
     ext2_inode m_raw_inode;
+
+    // While only the inode cache holds on to us, we're on Ext2FS's list of unused inodes.
+    IntrusiveListNode m_unused_list_node;
+    size_t m_unused_footprint { 0 };
+
+    // Blocks reserved past the end of a file that's being appended to, so the next
+    // writes land right after the current ones. Given back once the file is closed,
+    // and whenever the filesystem flushes its bitmaps.
+    Vector<unsigned> m_preallocated_blocks;
 };
 
 class Ext2FS final : public DiskBackedFS {
@@ -104,6 +119,14 @@ public:
     virtual KResult prepare_to_unmount() const override;
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_name_cache() const override { return true; }
+
+    size_t cached_inode_count() const;
+    size_t unused_inode_count() const;
+    size_t unused_inode_bytes() const { return m_unused_inode_bytes; }
+    u32 inode_cache_hits() const { return m_inode_cache_hits; }
+    u32 inode_cache_misses() const { return m_inode_cache_misses; }
+    u32 inode_cache_evictions() const { return m_inode_cache_evictions; }
 
 private:
     typedef unsigned BlockIndex;
@@ -135,7 +158,10 @@ private:
 
     BlockIndex first_block_index() const;
     InodeIndex find_a_free_inode(GroupIndex preferred_group, off_t expected_size);
-    Vector<BlockIndex> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    Vector<BlockIndex> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    void allocate_blocks_in_group(GroupIndex, size_t count, Vector<BlockIndex>&);
+    size_t allocate_block_run(GroupIndex, unsigned first_bit, size_t count, Vector<BlockIndex>&);
+    unsigned blocks_in_group(GroupIndex) const;
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
@@ -150,6 +176,10 @@ private:
     void uncache_inode(InodeIndex);
     void free_inode(Ext2FSInode&);
 
+    void inode_became_unused(Ext2FSInode&);
+    void inode_became_used(Ext2FSInode&);
+    void evict_unused_inodes(size_t max_bytes);
+
     struct BlockListShape {
         unsigned direct_blocks { 0 };
         unsigned indirect_blocks { 0 };
@@ -167,9 +197,26 @@ private:
 
     mutable HashMap<InodeIndex, RefPtr<Ext2FSInode>> m_inode_cache;
 
+    // Inodes that nobody but m_inode_cache refers to, least recently used first.
+    // They're kept around in case they're needed again soon, up to a memory limit.
+    mutable IntrusiveList<Ext2FSInode, &Ext2FSInode::m_unused_list_node> m_unused_inodes;
+    mutable size_t m_unused_inode_bytes { 0 };
+    mutable u32 m_inode_cache_hits { 0 };
+    mutable u32 m_inode_cache_misses { 0 };
+    u32 m_inode_cache_evictions { 0 };
+
     bool m_super_block_dirty { false };
     bool m_block_group_descriptors_dirty { false };
 
+    // Where to start looking for free blocks and inodes in each group (bit indices into the group's
+    // bitmaps), so allocations don't rescan the full part of the bitmap every time.
+    struct GroupAllocationHints {
+        unsigned next_free_block { 0 };
+        unsigned next_free_inode { 0 };
+    };
+    Vector<GroupAllocationHints> m_group_hints;
+    GroupAllocationHints& group_hints(GroupIndex group_index) { return m_group_hints[group_index - 1]; }
+
     struct CachedBitmap {
         CachedBitmap(BlockIndex bi, KBuffer&& buf)
             : bitmap_block_index(bi)
@@ -184,7 +231,7 @@ private:
 
     CachedBitmap& get_bitmap_block(BlockIndex);
 
-    Vector<OwnPtr<CachedBitmap>> m_cached_bitmaps;
+    HashMap<BlockIndex, OwnPtr<CachedBitmap>> m_cached_bitmaps;
 };
 
 inline Ext2FS& Ext2FSInode::fs()
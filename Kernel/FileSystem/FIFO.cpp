@@ -87,6 +87,7 @@ void FIFO::attach(Direction direction)
         klog() << "open writer (" << m_writers << ")";
 #endif
     }
+    notify_readiness_observers();
 }
 
 void FIFO::detach(Direction direction)
@@ -104,6 +105,7 @@ void FIFO::detach(Direction direction)
         ASSERT(m_writers);
         --m_writers;
     }
+    notify_readiness_observers();
 }
 
 bool FIFO::can_read(const FileDescription&) const
@@ -116,6 +118,17 @@ bool FIFO::can_write(const FileDescription&) const
     return m_buffer.space_for_writing() || !m_readers;
 }
 
+bool FIFO::is_hung_up(const FileDescription& description) const
+{
+    return description.fifo_direction() == Direction::Reader && !m_writers;
+}
+
+bool FIFO::has_pending_error(const FileDescription& description) const
+{
+    // Writing now would raise SIGPIPE.
+    return description.fifo_direction() == Direction::Writer && !m_readers;
+}
+
 ssize_t FIFO::read(FileDescription&, u8* buffer, ssize_t size)
 {
     if (!m_writers && m_buffer.is_empty())
@@ -127,6 +140,8 @@ ssize_t FIFO::read(FileDescription&, u8* buffer, ssize_t size)
 #ifdef FIFO_DEBUG
     dbg() << "   -> read (" << String::format("%c", buffer[0]) << ") " << nread;
 #endif
+    if (nread > 0)
+        notify_readiness_observers();
     return nread;
 }
 
@@ -139,7 +154,18 @@ ssize_t FIFO::write(FileDescription&, const u8* buffer, ssize_t size)
 #ifdef FIFO_DEBUG
     dbg() << "fifo: write(" << (const void*)buffer << ", " << size << ")";
 #endif
-    return m_buffer.write(buffer, size);
+    ssize_t nwritten = m_buffer.write(buffer, size);
+    if (nwritten > 0)
+        notify_readiness_observers();
+    return nwritten;
+}
+
+KResult FIFO::set_buffer_capacity(size_t capacity)
+{
+    auto result = m_buffer.set_capacity(capacity);
+    if (result.is_success())
+        notify_readiness_observers();
+    return result;
 }
 
 String FIFO::absolute_path(const FileDescription&) const
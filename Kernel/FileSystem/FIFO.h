@@ -26,8 +26,8 @@
 
 #pragma once
 
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/FileSystem/File.h>
+#include <Kernel/RingBuffer.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel {
@@ -52,21 +52,27 @@ public:
     void attach(Direction);
     void detach(Direction);
 
+    size_t buffer_capacity() const { return m_buffer.capacity(); }
+    KResult set_buffer_capacity(size_t);
+
 private:
     // ^File
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual bool can_read(const FileDescription&) const override;
     virtual bool can_write(const FileDescription&) const override;
+    virtual bool is_hung_up(const FileDescription&) const override;
+    virtual bool has_pending_error(const FileDescription&) const override;
     virtual String absolute_path(const FileDescription&) const override;
     virtual const char* class_name() const override { return "FIFO"; }
     virtual bool is_fifo() const override { return true; }
+    virtual bool has_readiness_notifications() const override { return true; }
 
     explicit FIFO(uid_t);
 
     unsigned m_writers { 0 };
     unsigned m_readers { 0 };
-    DoubleBuffer m_buffer;
+    RingBuffer m_buffer;
 
     uid_t m_uid { 0 };
 
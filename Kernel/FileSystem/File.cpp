@@ -25,6 +25,7 @@
  */
 
 #include <AK/StringView.h>
+#include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/FileDescription.h>
 
@@ -50,11 +51,56 @@ void File::close()
 {
 }
 
+ssize_t File::readv(FileDescription& description, const iovec* iov, int iov_count)
+{
+    ssize_t nread = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = read(description, (u8*)iov[i].iov_base, iov[i].iov_len);
+        if (rc < 0)
+            return nread ? nread : rc;
+        nread += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nread;
+}
+
+ssize_t File::writev(FileDescription& description, const iovec* iov, int iov_count)
+{
+    ssize_t nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = write(description, (const u8*)iov[i].iov_base, iov[i].iov_len);
+        if (rc < 0)
+            return nwritten ? nwritten : rc;
+        nwritten += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nwritten;
+}
+
+ssize_t File::preadv(FileDescription&, off_t, const iovec*, int)
+{
+    return -ESPIPE;
+}
+
+ssize_t File::pwritev(FileDescription&, off_t, const iovec*, int)
+{
+    return -ESPIPE;
+}
+
 int File::ioctl(FileDescription&, unsigned, unsigned)
 {
     return -ENOTTY;
 }
 
+void File::notify_readiness_observers()
+{
+    InterruptDisabler disabler;
+    for (auto& observer : m_readiness_observers)
+        observer.readiness_may_have_changed();
+}
+
 KResultOr<Region*> File::mmap(Process&, FileDescription&, VirtualAddress, size_t, size_t, int, bool)
 {
     return KResult(-ENODEV);
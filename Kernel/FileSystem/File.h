@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
@@ -52,6 +53,13 @@ namespace Kernel {
 //   - Note that can_read() should return true in EOF conditions,
 //     and a subsequent call to read() should return 0.
 //
+// has_readiness_notifications()
+//
+//   - Return true if this File calls notify_readiness_observers() whenever it
+//     may have become readable or writable (data arrived, buffer space freed,
+//     peer hung up, ...). It's fine to notify spuriously.
+//   - Files that don't do this are polled by their ReadinessObservers instead.
+//
 // ioctl()
 //
 //   - Optional. If unimplemented, ioctl() on this File will fail with -ENOTTY.
@@ -64,6 +72,25 @@ namespace Kernel {
 //   - Called by mmap() when userspace wants to memory-map this File somewhere.
 //   - Should create a Region in the Process and return it if successful.
 
+class ReadinessObserver {
+public:
+    virtual ~ReadinessObserver() { }
+
+    // Called, possibly from IRQ context, when the observed File may have become ready.
+    virtual void readiness_may_have_changed() = 0;
+
+    // Called when the observed FileDescription is about to die.
+    // The observer must unregister itself from the FileDescription.
+    virtual void description_will_die() = 0;
+
+private:
+    friend class File;
+    friend class FileDescription;
+
+    IntrusiveListNode m_file_list_node;
+    IntrusiveListNode m_description_list_node;
+};
+
 class File : public RefCounted<File> {
 public:
     virtual ~File();
@@ -74,8 +101,17 @@ public:
     virtual bool can_read(const FileDescription&) const = 0;
     virtual bool can_write(const FileDescription&) const = 0;
 
+    // Whether the other end has gone away, or an error is waiting to be picked up.
+    // Readiness interfaces report these whether or not they were asked for.
+    virtual bool is_hung_up(const FileDescription&) const { return false; }
+    virtual bool has_pending_error(const FileDescription&) const { return false; }
+
     virtual ssize_t read(FileDescription&, u8*, ssize_t) = 0;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) = 0;
+    virtual ssize_t readv(FileDescription&, const iovec*, int iov_count);
+    virtual ssize_t writev(FileDescription&, const iovec*, int iov_count);
+    virtual ssize_t preadv(FileDescription&, off_t, const iovec*, int iov_count);
+    virtual ssize_t pwritev(FileDescription&, off_t, const iovec*, int iov_count);
     virtual int ioctl(FileDescription&, unsigned request, unsigned arg);
     virtual KResultOr<Region*> mmap(Process&, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared);
 
@@ -97,9 +133,18 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_epoll() const { return false; }
+
+    virtual bool has_readiness_notifications() const { return false; }
+    void notify_readiness_observers();
 
 protected:
     File();
+
+private:
+    friend class FileDescription;
+
+    IntrusiveList<ReadinessObserver, &ReadinessObserver::m_file_list_node> m_readiness_observers;
 };
 
 }
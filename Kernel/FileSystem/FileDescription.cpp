@@ -66,6 +66,10 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    while (auto* observer = m_readiness_observers.first()) {
+        observer->description_will_die();
+        ASSERT(!m_readiness_observers.contains(*observer));
+    }
     if (is_socket())
         socket()->detach(*this);
     if (is_fifo())
@@ -153,6 +157,38 @@ ssize_t FileDescription::write(const u8* data, ssize_t size)
     return nwritten;
 }
 
+ssize_t FileDescription::readv(const iovec* iov, int iov_count)
+{
+    LOCKER(m_lock);
+    SmapDisabler disabler;
+    int nread = m_file->readv(*this, iov, iov_count);
+    if (nread > 0 && m_file->is_seekable())
+        m_current_offset += nread;
+    return nread;
+}
+
+ssize_t FileDescription::writev(const iovec* iov, int iov_count)
+{
+    LOCKER(m_lock);
+    SmapDisabler disabler;
+    int nwritten = m_file->writev(*this, iov, iov_count);
+    if (nwritten > 0 && m_file->is_seekable())
+        m_current_offset += nwritten;
+    return nwritten;
+}
+
+ssize_t FileDescription::preadv(off_t offset, const iovec* iov, int iov_count)
+{
+    SmapDisabler disabler;
+    return m_file->preadv(*this, offset, iov, iov_count);
+}
+
+ssize_t FileDescription::pwritev(off_t offset, const iovec* iov, int iov_count)
+{
+    SmapDisabler disabler;
+    return m_file->pwritev(*this, offset, iov, iov_count);
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this);
@@ -163,6 +199,20 @@ bool FileDescription::can_read() const
     return m_file->can_read(*this);
 }
 
+void FileDescription::register_readiness_observer(ReadinessObserver& observer)
+{
+    InterruptDisabler disabler;
+    m_readiness_observers.append(observer);
+    m_file->m_readiness_observers.append(observer);
+}
+
+void FileDescription::unregister_readiness_observer(ReadinessObserver& observer)
+{
+    InterruptDisabler disabler;
+    m_readiness_observers.remove(observer);
+    m_file->m_readiness_observers.remove(observer);
+}
+
 ByteBuffer FileDescription::read_entire_file()
 {
     // HACK ALERT: (This entire function)
@@ -70,6 +70,12 @@ public:
     off_t seek(off_t, int whence);
     ssize_t read(u8*, ssize_t);
     ssize_t write(const u8* data, ssize_t);
+    ssize_t readv(const iovec*, int iov_count);
+    ssize_t writev(const iovec*, int iov_count);
+
+    // Positional I/O doesn't touch (or lock) the shared file offset.
+    ssize_t preadv(off_t, const iovec*, int iov_count);
+    ssize_t pwritev(off_t, const iovec*, int iov_count);
     KResult fstat(stat&);
 
     KResult chmod(mode_t);
@@ -125,7 +131,7 @@ public:
 
     bool is_fifo() const;
     FIFO* fifo();
-    FIFO::Direction fifo_direction() { return m_fifo_direction; }
+    FIFO::Direction fifo_direction() const { return m_fifo_direction; }
     void set_fifo_direction(Badge<FIFO>, FIFO::Direction direction) { m_fifo_direction = direction; }
 
     Optional<KBuffer>& generator_cache() { return m_generator_cache; }
@@ -138,6 +144,9 @@ public:
 
     KResult chown(uid_t, gid_t);
 
+    void register_readiness_observer(ReadinessObserver&);
+    void unregister_readiness_observer(ReadinessObserver&);
+
 private:
     friend class VFS;
     explicit FileDescription(File&);
@@ -161,6 +170,8 @@ private:
     bool m_direct { false };
     FIFO::Direction m_fifo_direction { FIFO::Direction::Neither };
 
+    IntrusiveList<ReadinessObserver, &ReadinessObserver::m_description_list_node> m_readiness_observers;
+
     Lock m_lock { "FileDescription" };
 };
 
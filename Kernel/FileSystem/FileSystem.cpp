@@ -100,6 +100,21 @@ void FS::sync()
         fs.flush_writes();
 }
 
+size_t FS::release_all_clean_cache_pages()
+{
+    NonnullRefPtrVector<FS, 32> fses;
+    {
+        InterruptDisabler disabler;
+        for (auto& it : all_fses())
+            fses.append(*it.value);
+    }
+
+    size_t released_page_count = 0;
+    for (auto& fs : fses)
+        released_page_count += fs.release_clean_cache_pages();
+    return released_page_count;
+}
+
 void FS::lock_all()
 {
     for (auto& it : all_fses()) {
@@ -53,11 +53,15 @@ public:
     static FS* from_fsid(u32);
     static void sync();
     static void lock_all();
+    static size_t release_all_clean_cache_pages();
 
     virtual bool initialize() = 0;
     virtual const char* class_name() const = 0;
     virtual InodeIdentifier root_inode() const = 0;
     virtual bool supports_watchers() const { return false; }
+    // Whether the contents of directories only ever change through the VFS,
+    // so that NameCache can remember lookups in them.
+    virtual bool supports_name_cache() const { return false; }
 
     bool is_readonly() const { return m_readonly; }
 
@@ -84,6 +88,7 @@ public:
     virtual RefPtr<Inode> get_inode(InodeIdentifier) const = 0;
 
     virtual void flush_writes() {}
+    virtual size_t release_clean_cache_pages() { return 0; }
 
     int block_size() const { return m_block_size; }
 
@@ -27,11 +27,13 @@
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
+#include <Kernel/ExecutableCache.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Net/LocalSocket.h>
+#include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
@@ -61,6 +63,34 @@ void Inode::sync()
     }
 }
 
+ssize_t Inode::read_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description) const
+{
+    ssize_t nread = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = read_bytes(offset + nread, iov[i].iov_len, (u8*)iov[i].iov_base, description);
+        if (rc < 0)
+            return nread ? nread : rc;
+        nread += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nread;
+}
+
+ssize_t Inode::write_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription* description)
+{
+    ssize_t nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t rc = write_bytes(offset + nwritten, iov[i].iov_len, (const u8*)iov[i].iov_base, description);
+        if (rc < 0)
+            return nwritten ? nwritten : rc;
+        nwritten += rc;
+        if ((size_t)rc < iov[i].iov_len)
+            break;
+    }
+    return nwritten;
+}
+
 ByteBuffer Inode::read_entire(FileDescription* descriptor) const
 {
     size_t initial_size = metadata().size ? metadata().size : 4096;
@@ -129,14 +159,19 @@ void Inode::will_be_destroyed()
 
 void Inode::inode_contents_changed(off_t offset, ssize_t size, const u8* data)
 {
-    if (m_shared_vmobject)
+    // A cached executable image always holds on to the inode's shared VMObject.
+    if (m_shared_vmobject) {
         m_shared_vmobject->inode_contents_changed({}, offset, size, data);
+        ExecutableCache::the().invalidate(*this);
+    }
 }
 
 void Inode::inode_size_changed(size_t old_size, size_t new_size)
 {
-    if (m_shared_vmobject)
+    if (m_shared_vmobject) {
         m_shared_vmobject->inode_size_changed({}, old_size, new_size);
+        ExecutableCache::the().invalidate(*this);
+    }
 }
 
 int Inode::set_atime(time_t)
@@ -169,6 +204,11 @@ void Inode::set_shared_vmobject(SharedInodeVMObject& vmobject)
     m_shared_vmobject = vmobject.make_weak_ptr();
 }
 
+RefPtr<PhysicalPage> Inode::shared_page(size_t)
+{
+    return nullptr;
+}
+
 bool Inode::bind_socket(LocalSocket& socket)
 {
     LOCKER(m_lock);
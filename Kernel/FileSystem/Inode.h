@@ -38,6 +38,7 @@
 #include <Kernel/Forward.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Lock.h>
+#include <Kernel/UnixTypes.h>
 
 namespace Kernel {
 
@@ -72,6 +73,12 @@ public:
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const = 0;
     virtual RefPtr<Inode> lookup(StringView name) = 0;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* data, FileDescription*) = 0;
+
+    // Scatter/gather variants of read_bytes() and write_bytes(). The default implementations
+    // simply loop over the segments; file systems can override them to do the whole transfer
+    // in one pass (e.g. without re-reading a block that straddles two segments.)
+    virtual ssize_t read_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) const;
+    virtual ssize_t write_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*);
     virtual KResult add_child(InodeIdentifier child_id, const StringView& name, mode_t) = 0;
     virtual KResult remove_child(const StringView& name) = 0;
     virtual size_t directory_entry_count() const = 0;
@@ -103,6 +110,11 @@ public:
     SharedInodeVMObject* shared_vmobject() { return m_shared_vmobject.ptr(); }
     const SharedInodeVMObject* shared_vmobject() const { return m_shared_vmobject.ptr(); }
 
+    // Inodes that keep their contents in physical pages hand them out here, so a shared
+    // mapping of the file maps those very pages instead of a copy of them.
+    virtual bool has_shared_pages() const { return false; }
+    virtual RefPtr<PhysicalPage> shared_page(size_t page_index);
+
     static void sync();
 
     bool has_watchers() const { return !m_watchers.is_empty(); }
@@ -62,6 +62,34 @@ ssize_t InodeFile::write(FileDescription& description, const u8* data, ssize_t c
     return nwritten;
 }
 
+ssize_t InodeFile::readv(FileDescription& description, const iovec* iov, int iov_count)
+{
+    return preadv(description, description.offset(), iov, iov_count);
+}
+
+ssize_t InodeFile::writev(FileDescription& description, const iovec* iov, int iov_count)
+{
+    return pwritev(description, description.offset(), iov, iov_count);
+}
+
+ssize_t InodeFile::preadv(FileDescription& description, off_t offset, const iovec* iov, int iov_count)
+{
+    ssize_t nread = m_inode->read_bytes_vectored(offset, iov, iov_count, &description);
+    if (nread > 0)
+        Thread::current->did_file_read(nread);
+    return nread;
+}
+
+ssize_t InodeFile::pwritev(FileDescription& description, off_t offset, const iovec* iov, int iov_count)
+{
+    ssize_t nwritten = m_inode->write_bytes_vectored(offset, iov, iov_count, &description);
+    if (nwritten > 0) {
+        m_inode->set_mtime(kgettimeofday().tv_sec);
+        Thread::current->did_file_write(nwritten);
+    }
+    return nwritten;
+}
+
 KResultOr<Region*> InodeFile::mmap(Process& process, FileDescription& description, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared)
 {
     ASSERT(offset == 0);
@@ -49,6 +49,10 @@ public:
 
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
+    virtual ssize_t readv(FileDescription&, const iovec*, int iov_count) override;
+    virtual ssize_t writev(FileDescription&, const iovec*, int iov_count) override;
+    virtual ssize_t preadv(FileDescription&, off_t, const iovec*, int iov_count) override;
+    virtual ssize_t pwritev(FileDescription&, off_t, const iovec*, int iov_count) override;
     virtual KResultOr<Region*> mmap(Process&, FileDescription&, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared) override;
 
     virtual String absolute_path(const FileDescription&) const override;
@@ -86,6 +86,7 @@ String InodeWatcher::absolute_path(const FileDescription&) const
 void InodeWatcher::notify_inode_event(Badge<Inode>, Event::Type event_type)
 {
     m_queue.enqueue({ event_type });
+    notify_readiness_observers();
 }
 
 }
@@ -55,6 +55,7 @@ public:
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
     virtual String absolute_path(const FileDescription&) const override;
     virtual const char* class_name() const override { return "InodeWatcher"; };
+    virtual bool has_readiness_notifications() const override { return true; }
 
     void notify_inode_event(Badge<Inode>, Event::Type);
 
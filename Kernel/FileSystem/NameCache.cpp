@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/HashFunctions.h>
+#include <AK/StringView.h>
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/FileSystem/NameCache.h>
+
+//#define NAME_CACHE_DEBUG
+
+namespace Kernel {
+
+static const size_t max_entries = 1024;
+
+NameCache& NameCache::the()
+{
+    static NameCache* the;
+    if (!the)
+        the = new NameCache;
+    return *the;
+}
+
+unsigned NameCache::hash_for(const Custody& parent, const StringView& name)
+{
+    return pair_int_hash(ptr_hash(&parent), name.hash());
+}
+
+auto NameCache::find(Custody& parent, const StringView& name) -> Entry*
+{
+    auto it = m_entries.find(hash_for(parent, name), [&](auto* entry) {
+        return entry->parent == &parent && entry->name == name;
+    });
+    if (it == m_entries.end())
+        return nullptr;
+    return *it;
+}
+
+bool NameCache::lookup(Custody& parent, const StringView& name, RefPtr<Custody>& out_child)
+{
+    LOCKER(m_lock);
+    auto* entry = find(parent, name);
+    if (!entry)
+        return false;
+    m_lru.remove(entry);
+    m_lru.prepend(entry);
+    out_child = entry->child;
+    return true;
+}
+
+void NameCache::add(Custody& parent, const StringView& name, Custody* child, u32 generation)
+{
+    LOCKER(m_lock);
+    if (generation != m_generation)
+        return;
+    if (auto* entry = find(parent, name)) {
+        entry->child = child;
+        m_lru.remove(entry);
+        m_lru.prepend(entry);
+        return;
+    }
+
+    if (m_entries.size() >= max_entries)
+        remove(*m_lru.tail());
+
+    auto* entry = new Entry;
+    entry->parent = &parent;
+    entry->name = name;
+    entry->hash = hash_for(parent, name);
+    entry->child = child;
+    m_entries.set(entry);
+    m_lru.prepend(entry);
+}
+
+void NameCache::remove(Entry& entry)
+{
+    m_entries.remove(&entry);
+    m_lru.remove(&entry);
+    delete &entry;
+}
+
+void NameCache::invalidate(const Inode& directory, const StringView& name)
+{
+    LOCKER(m_lock);
+    ++m_generation;
+    // The same directory can be reached through any number of custodies, so look at all of them.
+    Vector<Entry*> stale_entries;
+    for (auto* entry : m_entries) {
+        if (entry->name == name && entry->parent->inode().identifier() == directory.identifier())
+            stale_entries.append(entry);
+    }
+#ifdef NAME_CACHE_DEBUG
+    if (!stale_entries.is_empty())
+        dbg() << "NameCache: Invalidating " << stale_entries.size() << " entries for '" << name << "' in " << directory.identifier();
+#endif
+    for (auto* entry : stale_entries)
+        remove(*entry);
+}
+
+void NameCache::invalidate_all()
+{
+    LOCKER(m_lock);
+    ++m_generation;
+    while (auto* entry = m_lru.head())
+        remove(*entry);
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/InlineLinkedList.h>
+#include <AK/RefPtr.h>
+#include <AK/String.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Lock.h>
+
+namespace Kernel {
+
+// Remembers what names resolved to in which directories, so that resolving the same
+// paths over and over doesn't look up every component in its directory again.
+//
+// Entries are keyed on the parent's Custody and hold on to the child's Custody, so
+// repeated lookups also reuse the same Custody objects, and thus keep hitting the cache
+// all the way down the path. Names that turned out not to exist are remembered too.
+//
+// VFS invalidates the affected entries whenever it changes a directory, and everything
+// whenever something is mounted or unmounted. Only file systems whose directories can't
+// change behind the VFS's back (see FS::supports_name_cache()) are cached at all.
+class NameCache {
+    AK_MAKE_ETERNAL
+public:
+    static NameCache& the();
+
+    // Returns false on a miss. On a hit, out_child is null if the name is known not to exist.
+    bool lookup(Custody& parent, const StringView& name, RefPtr<Custody>& out_child);
+
+    // Bumped by every invalidation. Grab it before looking a name up in the directory, and
+    // pass it to add(), so that a lookup that raced with a change to the directory is dropped.
+    u32 generation() const { return m_generation; }
+
+    // Pass a null child to remember that the name doesn't exist.
+    void add(Custody& parent, const StringView& name, Custody* child, u32 generation);
+
+    void invalidate(const Inode& directory, const StringView& name);
+    void invalidate_all();
+
+private:
+    NameCache() {}
+
+    struct Entry : public InlineLinkedListNode<Entry> {
+        RefPtr<Custody> parent;
+        String name;
+        unsigned hash { 0 };
+        RefPtr<Custody> child;
+
+        // For InlineLinkedListNode.
+        Entry* m_next { nullptr };
+        Entry* m_prev { nullptr };
+    };
+
+    struct EntryTraits : public GenericTraits<Entry*> {
+        static unsigned hash(const Entry* entry) { return entry->hash; }
+        static bool equals(const Entry* a, const Entry* b) { return a == b; }
+    };
+
+    static unsigned hash_for(const Custody& parent, const StringView& name);
+    Entry* find(Custody& parent, const StringView& name);
+    void remove(Entry&);
+
+    Lock m_lock { "NameCache" };
+    HashTable<Entry*, EntryTraits> m_entries;
+    // Most recently used first.
+    InlineLinkedList<Entry> m_lru;
+    u32 m_generation { 0 };
+};
+
+}
@@ -34,15 +34,19 @@
 #include <AK/JsonValue.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/ExecutableCache.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/DiskBackedFileSystem.h>
+#include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/KParams.h>
+#include <Kernel/KernelLog.h>
 #include <Kernel/Module.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/NetworkAdapter.h>
@@ -54,9 +58,10 @@
 #include <Kernel/TTY/TTY.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PurgeableVMObject.h>
-#include <LibBareMetal/Output/Console.h>
+#include <Kernel/VM/SwapManager.h>
 #include <LibBareMetal/StdLib.h>
 #include <LibC/errno_numbers.h>
+#include <LibC/sys/procstat.h>
 
 namespace Kernel {
 
@@ -79,6 +84,7 @@ enum ProcFileType {
     FI_Root_mounts,
     FI_Root_df,
     FI_Root_all,
+    FI_Root_all_binary,
     FI_Root_memstat,
     FI_Root_cpuinfo,
     FI_Root_inodes,
@@ -90,6 +96,8 @@ enum ProcFileType {
     FI_Root_cmdline,
     FI_Root_modules,
     FI_Root_profile,
+    FI_Root_exec,
+    FI_Root_ksyms,
     FI_Root_self, // symlink
     FI_Root_sys,  // directory
     FI_Root_net,  // directory
@@ -383,9 +391,22 @@ Optional<KBuffer> procfs$devices(InodeIdentifier)
         obj.add("minor", device.minor());
         obj.add("class_name", device.class_name());
 
-        if (device.is_block_device())
+        if (device.is_block_device()) {
             obj.add("type", "block");
-        else if (device.is_character_device())
+            auto& block_device = static_cast<BlockDevice&>(device);
+            obj.add("queue_depth", block_device.queue_depth());
+            obj.add("max_queue_depth", block_device.max_queue_depth());
+            obj.add("completed_requests", block_device.completed_request_count());
+            obj.add("merged_requests", block_device.merged_request_count());
+            auto histogram = obj.add_array("latency_histogram");
+            for (size_t i = 0; i < BlockDevice::latency_histogram_size; ++i)
+                histogram.add(block_device.latency_histogram()[i]);
+            histogram.finish();
+            obj.add("read_cache", block_device.has_read_cache());
+            obj.add("read_cache_hits", block_device.read_cache_hit_count());
+            obj.add("read_cache_misses", block_device.read_cache_miss_count());
+            obj.add("readahead_chunks", block_device.readahead_count());
+        } else if (device.is_character_device())
             obj.add("type", "character");
         else
             ASSERT_NOT_REACHED();
@@ -401,6 +422,34 @@ Optional<KBuffer> procfs$uptime(InodeIdentifier)
     return builder.build();
 }
 
+Optional<KBuffer> procfs$exec(InodeIdentifier)
+{
+    auto& cache = ExecutableCache::the();
+    KBufferBuilder builder;
+    JsonObjectSerializer<KBufferBuilder> json { builder };
+    json.add("exec_count", cache.exec_count());
+    json.add("total_exec_microseconds", cache.total_exec_microseconds());
+    json.add("max_exec_microseconds", cache.max_exec_microseconds());
+    json.add("cached_images", (u32)cache.image_count());
+    json.add("cache_hits", cache.hits());
+    json.add("cache_misses", cache.misses());
+    json.finish();
+    return builder.build();
+}
+
+Optional<KBuffer> procfs$ksyms(InodeIdentifier)
+{
+    // One "address name" line per symbol, sorted by address, for symbolicating offline.
+    if (!ksyms_ready)
+        return {};
+    KBufferBuilder builder;
+    for (u32 i = 0; i < ksym_count; ++i) {
+        auto& ksym = ksym_at(i);
+        builder.appendf("%08x %s\n", ksym.address, ksym.name);
+    }
+    return builder.build();
+}
+
 Optional<KBuffer> procfs$cmdline(InodeIdentifier)
 {
     KBufferBuilder builder;
@@ -702,10 +751,18 @@ Optional<KBuffer> procfs$mm(InodeIdentifier)
 
 Optional<KBuffer> procfs$dmesg(InodeIdentifier)
 {
-    InterruptDisabler disabler;
     KBufferBuilder builder;
-    for (char ch : Console::the().logbuffer())
-        builder.append(ch);
+    KernelLog::Record record;
+    // Stop at what was there when we started, so a chatty kernel can't keep us here forever.
+    u32 end = KernelLog::next_sequence();
+    for (u32 sequence = KernelLog::first_sequence(); sequence != end; ++sequence) {
+        // Anything that's been overwritten in the meantime is just gone.
+        if (KernelLog::read(sequence, record) != KernelLog::ReadResult::Success)
+            continue;
+        if (record.level > LogLevel::Info)
+            continue;
+        builder.append(record.text, record.length);
+    }
     return builder.build();
 }
 
@@ -830,50 +887,81 @@ Optional<KBuffer> procfs$memstat(InodeIdentifier)
     json.add("user_physical_available", MM.user_physical_pages() - MM.user_physical_pages_used());
     json.add("super_physical_allocated", MM.super_physical_pages_used());
     json.add("super_physical_available", MM.super_physical_pages() - MM.super_physical_pages_used());
+    json.add("large_pages_mapped", MM.large_pages_mapped());
+    json.add("large_page_splits", MM.large_page_splits());
+    json.add("reclaim_low_watermark", MM.reclaim_low_watermark());
+    json.add("reclaim_high_watermark", MM.reclaim_high_watermark());
+    json.add("reclaim_count", MM.reclaim_count());
+    json.add("reclaimed_pages", MM.reclaimed_pages());
+    auto& swap = SwapManager::the();
+    json.add("swap_ins", swap.swap_ins());
+    json.add("swap_outs", swap.swap_outs());
+    json.add("swap_writebacks", swap.writebacks());
+    json.add("swap_pool_entries", (u32)swap.pool_entries());
+    json.add("swap_pool_bytes", (u32)swap.pool_bytes());
+    json.add("swap_filled_entries", (u32)swap.filled_entries());
+    json.add("swap_disk_slots_used", (u32)swap.disk_slots_used());
+    json.add("swap_disk_slots_total", (u32)swap.disk_slots_total());
     json.add("kmalloc_call_count", g_kmalloc_call_count);
     json.add("kfree_call_count", g_kfree_call_count);
-    slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
-        auto prefix = String::format("slab_%zu", slab_size);
-        json.add(String::format("%s_num_allocated", prefix.characters()), (u32)num_allocated);
-        json.add(String::format("%s_num_free", prefix.characters()), (u32)num_free);
+    auto pool_stats = kmalloc_pool_statistics();
+    json.add("kmalloc_pool_count", (u32)pool_stats.pool_count);
+    json.add("kmalloc_pool_pages", (u32)pool_stats.total_pages);
+    json.add("kmalloc_free_pages", (u32)pool_stats.free_pages);
+    json.add("kmalloc_large_allocations", (u32)pool_stats.large_allocations);
+    json.add("kmalloc_large_pages", (u32)pool_stats.large_pages);
+    for (size_t i = 0; i < kmalloc_cache_count(); ++i) {
+        auto cache_stats = kmalloc_cache_statistics(i);
+        auto prefix = String::format("kmalloc_%zu", cache_stats.object_size);
+        json.add(String::format("%s_slabs", prefix.characters()), (u32)cache_stats.slab_count);
+        json.add(String::format("%s_num_allocated", prefix.characters()), (u32)cache_stats.objects_in_use);
+        json.add(String::format("%s_num_free", prefix.characters()), (u32)cache_stats.objects_free);
+    }
+    ObjectCache::for_each([&json](const ObjectCache& cache) {
+        json.add(String::format("cache_%s_live", cache.name()), (u32)cache.live_count());
+        json.add(String::format("cache_%s_free", cache.name()), (u32)cache.free_count());
     });
     json.finish();
     return builder.build();
 }
 
-Optional<KBuffer> procfs$all(InodeIdentifier)
+static String pledge_string(const Process& process)
 {
-    InterruptDisabler disabler;
-    auto processes = Process::all_processes();
-    KBufferBuilder builder;
-    JsonArraySerializer array { builder };
-
-    // Keep this in sync with CProcessStatistics.
-    auto build_process = [&](const Process& process) {
-        auto process_object = array.add_object();
-
-        StringBuilder pledge_builder;
+    StringBuilder pledge_builder;
 #define __ENUMERATE_PLEDGE_PROMISE(promise)      \
     if (process.has_promised(Pledge::promise)) { \
         pledge_builder.append(#promise " ");     \
     }
-        ENUMERATE_PLEDGE_PROMISES
+    ENUMERATE_PLEDGE_PROMISES
 #undef __ENUMERATE_PLEDGE_PROMISE
+    return pledge_builder.to_string();
+}
 
-        process_object.add("pledge", pledge_builder.to_string());
+static const char* veil_string(const Process& process)
+{
+    switch (process.veil_state()) {
+    case VeilState::None:
+        return "None";
+    case VeilState::Dropped:
+        return "Dropped";
+    case VeilState::Locked:
+        return "Locked";
+    }
+    ASSERT_NOT_REACHED();
+}
 
-        switch (process.veil_state()) {
-        case VeilState::None:
-            process_object.add("veil", "None");
-            break;
-        case VeilState::Dropped:
-            process_object.add("veil", "Dropped");
-            break;
-        case VeilState::Locked:
-            process_object.add("veil", "Locked");
-            break;
-        }
+Optional<KBuffer> procfs$all(InodeIdentifier)
+{
+    InterruptDisabler disabler;
+    auto processes = Process::all_processes();
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
 
+    // Keep this in sync with CProcessStatistics and procfs$all_binary.
+    auto build_process = [&](const Process& process) {
+        auto process_object = array.add_object();
+        process_object.add("pledge", pledge_string(process));
+        process_object.add("veil", veil_string(process));
         process_object.add("pid", process.pid());
         process_object.add("pgid", process.tty() ? process.tty()->pgid() : 0);
         process_object.add("pgp", process.pgid());
@@ -892,6 +980,8 @@ Optional<KBuffer> procfs$all(InodeIdentifier)
         process_object.add("amount_purgeable_volatile", (u32)process.amount_purgeable_volatile());
         process_object.add("amount_purgeable_nonvolatile", (u32)process.amount_purgeable_nonvolatile());
         process_object.add("icon_id", process.icon_id());
+        process_object.add("minor_faults", process.minor_faults());
+        process_object.add("major_faults", process.major_faults());
         auto thread_array = process_object.add_array("threads");
         process.for_each_thread([&](const Thread& thread) {
             auto thread_object = thread_array.add_object();
@@ -922,10 +1012,112 @@ Optional<KBuffer> procfs$all(InodeIdentifier)
     return builder.build();
 }
 
+Optional<KBuffer> procfs$all_binary(InodeIdentifier)
+{
+    InterruptDisabler disabler;
+    auto processes = Process::all_processes();
+    KBufferBuilder builder;
+
+    auto append = [&](const void* data, size_t size) {
+        builder.append((const char*)data, size);
+    };
+    auto append_string = [&](const StringView& string) {
+        u16 length = min(string.length(), (size_t)0xffff);
+        append(&length, sizeof(length));
+        append(string.characters_without_null_termination(), length);
+    };
+
+    procstat_header header;
+    header.magic = PROCSTAT_MAGIC;
+    header.version = PROCSTAT_VERSION;
+    header.process_count = processes.size() + 1;
+    header.process_record_size = sizeof(procstat_process);
+    header.thread_record_size = sizeof(procstat_thread);
+    append(&header, sizeof(header));
+
+    // Keep this in sync with procfs$all.
+    auto build_process = [&](const Process& process) {
+        procstat_process record;
+        record.pid = process.pid();
+        record.pgid = process.tty() ? process.tty()->pgid() : 0;
+        record.pgp = process.pgid();
+        record.sid = process.sid();
+        record.uid = process.uid();
+        record.gid = process.gid();
+        record.ppid = process.ppid();
+        record.nfds = process.number_of_open_file_descriptors();
+        record.amount_virtual = process.amount_virtual();
+        record.amount_resident = process.amount_resident();
+        record.amount_dirty_private = process.amount_dirty_private();
+        record.amount_clean_inode = process.amount_clean_inode();
+        record.amount_shared = process.amount_shared();
+        record.amount_purgeable_volatile = process.amount_purgeable_volatile();
+        record.amount_purgeable_nonvolatile = process.amount_purgeable_nonvolatile();
+        record.icon_id = process.icon_id();
+        record.minor_faults = process.minor_faults();
+        record.major_faults = process.major_faults();
+        record.thread_count = 0;
+        process.for_each_thread([&](auto&) {
+            ++record.thread_count;
+            return IterationDecision::Continue;
+        });
+        append(&record, sizeof(record));
+        append_string(process.name());
+        append_string(process.tty() ? process.tty()->tty_name() : "notty");
+        append_string(pledge_string(process));
+        append_string(veil_string(process));
+
+        process.for_each_thread([&](const Thread& thread) {
+            procstat_thread thread_record;
+            thread_record.tid = thread.tid();
+            thread_record.times_scheduled = thread.times_scheduled();
+            thread_record.ticks = thread.ticks();
+            thread_record.priority = thread.priority();
+            thread_record.effective_priority = thread.effective_priority();
+            thread_record.syscall_count = thread.syscall_count();
+            thread_record.inode_faults = thread.inode_faults();
+            thread_record.zero_faults = thread.zero_faults();
+            thread_record.cow_faults = thread.cow_faults();
+            thread_record.file_read_bytes = thread.file_read_bytes();
+            thread_record.file_write_bytes = thread.file_write_bytes();
+            thread_record.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+            thread_record.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+            thread_record.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+            thread_record.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+            append(&thread_record, sizeof(thread_record));
+            append_string(thread.name());
+            append_string(thread.state_string());
+            return IterationDecision::Continue;
+        });
+    };
+    build_process(*Scheduler::colonel());
+    for (auto* process : processes)
+        build_process(*process);
+    return builder.build();
+}
+
 Optional<KBuffer> procfs$inodes(InodeIdentifier)
 {
     extern InlineLinkedList<Inode>& all_inodes();
     KBufferBuilder builder;
+
+    VFS::the().for_each_mount([&builder](auto& mount) {
+        if (strcmp(mount.guest_fs().class_name(), "Ext2FS"))
+            return;
+        auto& fs = static_cast<const Ext2FS&>(mount.guest_fs());
+        u32 hits = fs.inode_cache_hits();
+        u32 lookups = hits + fs.inode_cache_misses();
+        builder.appendf("Ext2FS on %s: %u cached, %u unused (%u KB), %u%% hit rate (%u/%u), %u evicted\n",
+            mount.absolute_path().characters(),
+            fs.cached_inode_count(),
+            fs.unused_inode_count(),
+            fs.unused_inode_bytes() / KB,
+            lookups ? (u32)((u64)hits * 100 / lookups) : 0,
+            hits,
+            lookups,
+            fs.inode_cache_evictions());
+    });
+
     InterruptDisabler disabler;
     for (auto& inode : all_inodes()) {
         builder.appendf("Inode{K%x} %02u:%08u (%u)\n", &inode, inode.fsid(), inode.index(), inode.ref_count());
@@ -1228,7 +1420,8 @@ ssize_t ProcFSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
     if (!description) {
         generated_data = (*read_callback)(identifier());
     } else {
-        if (!description->generator_cache().has_value())
+        // Reading from the start again (after a seek back to 0) gets a fresh snapshot.
+        if (!description->generator_cache().has_value() || offset == 0)
             description->generator_cache() = (*read_callback)(identifier());
         generated_data = description->generator_cache();
     }
@@ -1618,6 +1811,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_mounts] = { "mounts", FI_Root_mounts, false, procfs$mounts };
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
+    m_entries[FI_Root_all_binary] = { "all_binary", FI_Root_all_binary, false, procfs$all_binary };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_inodes] = { "inodes", FI_Root_inodes, true, procfs$inodes };
@@ -1630,6 +1824,8 @@ ProcFS::ProcFS()
     m_entries[FI_Root_cmdline] = { "cmdline", FI_Root_cmdline, true, procfs$cmdline };
     m_entries[FI_Root_modules] = { "modules", FI_Root_modules, true, procfs$modules };
     m_entries[FI_Root_profile] = { "profile", FI_Root_profile, false, procfs$profile };
+    m_entries[FI_Root_exec] = { "exec", FI_Root_exec, false, procfs$exec };
+    m_entries[FI_Root_ksyms] = { "ksyms", FI_Root_ksyms, false, procfs$ksyms };
     m_entries[FI_Root_sys] = { "sys", FI_Root_sys, true };
     m_entries[FI_Root_net] = { "net", FI_Root_net, false };
 
@@ -27,6 +27,8 @@
 #include <Kernel/FileSystem/TmpFS.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibBareMetal/StdLib.h>
 
 namespace Kernel {
 
@@ -188,57 +190,169 @@ ssize_t TmpFSInode::read_bytes(off_t offset, ssize_t size, u8* buffer, FileDescr
     ASSERT(size >= 0);
     ASSERT(offset >= 0);
 
-    if (!m_content.has_value())
-        return 0;
-
     if (offset >= m_metadata.size)
         return 0;
 
     if (static_cast<off_t>(size) > m_metadata.size - offset)
         size = m_metadata.size - offset;
 
-    memcpy(buffer, m_content.value().data() + offset, size);
+    read_from_pages(offset, size, buffer);
     return size;
 }
 
-ssize_t TmpFSInode::write_bytes(off_t offset, ssize_t size, const u8* buffer, FileDescription*)
+ssize_t TmpFSInode::read_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription*) const
 {
     LOCKER(m_lock);
     ASSERT(!is_directory());
     ASSERT(offset >= 0);
 
-    off_t old_size = m_metadata.size;
-    off_t new_size = m_metadata.size;
-    if ((offset + size) > new_size)
-        new_size = offset + size;
+    ssize_t nread = 0;
+    for (int i = 0; i < iov_count && offset + nread < m_metadata.size; ++i) {
+        size_t size = min(iov[i].iov_len, (size_t)(m_metadata.size - offset - nread));
+        read_from_pages(offset + nread, size, (u8*)iov[i].iov_base);
+        nread += size;
+    }
+    return nread;
+}
 
-    if (new_size > old_size) {
-        if (m_content.has_value() && m_content.value().capacity() >= (size_t)new_size) {
-            m_content.value().set_size(new_size);
+void TmpFSInode::read_from_pages(off_t offset, size_t size, u8* buffer) const
+{
+    // The destination may be a userspace buffer that faults, so we only hold the
+    // quickmap long enough to copy each page into a bounce buffer.
+    u8 page_buffer[PAGE_SIZE];
+    while (size) {
+        size_t page_index = offset / PAGE_SIZE;
+        size_t offset_in_page = offset % PAGE_SIZE;
+        size_t chunk_size = min(size, PAGE_SIZE - offset_in_page);
+        auto page = m_pages[page_index];
+        if (page.is_null()) {
+            memset(buffer, 0, chunk_size);
         } else {
-            // Grow the content buffer 2x the new sizeto accomodate repeating write() calls.
-            // Note that we're not actually committing physical memory to the buffer
-            // until it's needed. We only grow VM here.
-
-            // FIXME: Fix this so that no memcpy() is necessary, and we can just grow the
-            //        KBuffer and it will add physical pages as needed while keeping the
-            //        existing ones.
-            auto tmp = KBuffer::create_with_size(new_size * 2);
-            tmp.set_size(new_size);
-            if (m_content.has_value())
-                memcpy(tmp.data(), m_content.value().data(), old_size);
-            m_content = move(tmp);
+            {
+                InterruptDisabler disabler;
+                memcpy(page_buffer, MM.quickmap_page(*page) + offset_in_page, chunk_size);
+                MM.unquickmap_page();
+            }
+            memcpy(buffer, page_buffer, chunk_size);
         }
-        m_metadata.size = new_size;
-        set_metadata_dirty(true);
-        set_metadata_dirty(false);
-        inode_size_changed(old_size, new_size);
+        offset += chunk_size;
+        buffer += chunk_size;
+        size -= chunk_size;
     }
+}
 
-    memcpy(m_content.value().data() + offset, buffer, size);
-    inode_contents_changed(offset, size, buffer);
+ssize_t TmpFSInode::write_to_pages(off_t offset, size_t size, const u8* buffer)
+{
+    u8 page_buffer[PAGE_SIZE];
+    ssize_t nwritten = 0;
+    while (size) {
+        size_t page_index = offset / PAGE_SIZE;
+        size_t offset_in_page = offset % PAGE_SIZE;
+        size_t chunk_size = min(size, PAGE_SIZE - offset_in_page);
+        auto page = ensure_page(page_index);
+        if (page.is_null())
+            return nwritten ? nwritten : -ENOMEM;
+        memcpy(page_buffer, buffer, chunk_size);
+        {
+            InterruptDisabler disabler;
+            memcpy(MM.quickmap_page(*page) + offset_in_page, page_buffer, chunk_size);
+            MM.unquickmap_page();
+        }
+        offset += chunk_size;
+        buffer += chunk_size;
+        size -= chunk_size;
+        nwritten += chunk_size;
+    }
+    return nwritten;
+}
 
-    return size;
+RefPtr<PhysicalPage> TmpFSInode::ensure_page(size_t page_index)
+{
+    ASSERT(page_index < m_pages.size());
+    auto& page = m_pages[page_index];
+    if (page.is_null()) {
+        InterruptDisabler disabler;
+        page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+    }
+    return page;
+}
+
+RefPtr<PhysicalPage> TmpFSInode::shared_page(size_t page_index)
+{
+    LOCKER(m_lock);
+    if (page_index >= m_pages.size())
+        return nullptr;
+    return ensure_page(page_index);
+}
+
+void TmpFSInode::resize(off_t new_size)
+{
+    off_t old_size = m_metadata.size;
+    if (new_size == old_size)
+        return;
+
+    if (new_size < old_size && (new_size % PAGE_SIZE)) {
+        // Clear what's left of the last page, so growing the file again reads back zeroes.
+        auto& page = m_pages[new_size / PAGE_SIZE];
+        if (!page.is_null()) {
+            InterruptDisabler disabler;
+            size_t offset_in_page = new_size % PAGE_SIZE;
+            memset(MM.quickmap_page(*page) + offset_in_page, 0, PAGE_SIZE - offset_in_page);
+            MM.unquickmap_page();
+        }
+    }
+
+    // Growing only adds empty slots, the pages themselves are allocated by the first write.
+    m_pages.resize(PAGE_ROUND_UP(new_size) / PAGE_SIZE);
+
+    m_metadata.size = new_size;
+    set_metadata_dirty(true);
+    set_metadata_dirty(false);
+    inode_size_changed(old_size, new_size);
+}
+
+ssize_t TmpFSInode::write_bytes(off_t offset, ssize_t size, const u8* buffer, FileDescription*)
+{
+    LOCKER(m_lock);
+    ASSERT(!is_directory());
+    ASSERT(offset >= 0);
+
+    if (offset + size > m_metadata.size)
+        resize(offset + size);
+
+    ssize_t nwritten = write_to_pages(offset, size, buffer);
+    if (nwritten > 0)
+        inode_contents_changed(offset, nwritten, buffer);
+    return nwritten;
+}
+
+ssize_t TmpFSInode::write_bytes_vectored(off_t offset, const iovec* iov, int iov_count, FileDescription*)
+{
+    LOCKER(m_lock);
+    ASSERT(!is_directory());
+    ASSERT(offset >= 0);
+
+    // Grow once for the whole write, so the page table isn't resized per segment.
+    ssize_t size = 0;
+    for (int i = 0; i < iov_count; ++i)
+        size += iov[i].iov_len;
+    if (!size)
+        return 0;
+    if (offset + size > m_metadata.size)
+        resize(offset + size);
+
+    ssize_t nwritten = 0;
+    for (int i = 0; i < iov_count; ++i) {
+        ssize_t result = write_to_pages(offset + nwritten, iov[i].iov_len, (const u8*)iov[i].iov_base);
+        if (result < 0)
+            return nwritten ? nwritten : result;
+        inode_contents_changed(offset + nwritten, result, (const u8*)iov[i].iov_base);
+        nwritten += result;
+        if ((size_t)result < iov[i].iov_len)
+            break;
+    }
+
+    return nwritten;
 }
 
 RefPtr<Inode> TmpFSInode::lookup(StringView name)
@@ -334,33 +448,7 @@ KResult TmpFSInode::truncate(u64 size)
     LOCKER(m_lock);
     ASSERT(!is_directory());
 
-    if (size == 0)
-        m_content.clear();
-    else if (!m_content.has_value()) {
-        m_content = KBuffer::create_with_size(size);
-    } else if (static_cast<size_t>(size) < m_content.value().capacity()) {
-        size_t prev_size = m_metadata.size;
-        m_content.value().set_size(size);
-        if (prev_size < static_cast<size_t>(size))
-            memset(m_content.value().data() + prev_size, 0, size - prev_size);
-    } else {
-        size_t prev_size = m_metadata.size;
-        KBuffer tmp = KBuffer::create_with_size(size);
-        memcpy(tmp.data(), m_content.value().data(), prev_size);
-        m_content = move(tmp);
-    }
-
-    size_t old_size = m_metadata.size;
-    m_metadata.size = size;
-    set_metadata_dirty(true);
-    set_metadata_dirty(false);
-
-    if (old_size != (size_t)size) {
-        inode_size_changed(old_size, size);
-        if (m_content.has_value())
-            inode_contents_changed(0, size, m_content.value().data());
-    }
-
+    resize(size);
     return KSuccess;
 }
 
@@ -27,10 +27,10 @@
 #pragma once
 
 #include <AK/HashMap.h>
-#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
-#include <Kernel/KBuffer.h>
 
 namespace Kernel {
 
@@ -47,6 +47,7 @@ public:
     virtual const char* class_name() const override { return "TmpFS"; }
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_name_cache() const override { return true; }
 
     virtual InodeIdentifier root_inode() const override;
     virtual RefPtr<Inode> get_inode(InodeIdentifier) const override;
@@ -78,11 +79,13 @@ public:
 
     // ^Inode
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const override;
+    virtual ssize_t read_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) const override;
     virtual InodeMetadata metadata() const override;
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const override;
     virtual RefPtr<Inode> lookup(StringView name) override;
     virtual void flush_metadata() override;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* buffer, FileDescription*) override;
+    virtual ssize_t write_bytes_vectored(off_t, const iovec*, int iov_count, FileDescription*) override;
     virtual KResult add_child(InodeIdentifier child_id, const StringView& name, mode_t) override;
     virtual KResult remove_child(const StringView& name) override;
     virtual size_t directory_entry_count() const override;
@@ -93,16 +96,24 @@ public:
     virtual int set_ctime(time_t) override;
     virtual int set_mtime(time_t) override;
     virtual void one_ref_left() override;
+    virtual bool has_shared_pages() const override { return true; }
+    virtual RefPtr<PhysicalPage> shared_page(size_t page_index) override;
 
 private:
     TmpFSInode(TmpFS& fs, InodeMetadata metadata, InodeIdentifier parent);
     static NonnullRefPtr<TmpFSInode> create(TmpFS&, InodeMetadata metadata, InodeIdentifier parent);
     static NonnullRefPtr<TmpFSInode> create_root(TmpFS&);
 
+    void resize(off_t new_size);
+    RefPtr<PhysicalPage> ensure_page(size_t page_index);
+    void read_from_pages(off_t offset, size_t size, u8* buffer) const;
+    ssize_t write_to_pages(off_t offset, size_t size, const u8* buffer);
+
     InodeMetadata m_metadata;
     InodeIdentifier m_parent;
 
-    Optional<KBuffer> m_content;
+    // File contents, one slot per page. Pages that were never written are null and read as zeroes.
+    Vector<RefPtr<PhysicalPage>> m_pages;
     struct Child {
         FS::DirectoryEntry entry;
         NonnullRefPtr<TmpFSInode> inode;
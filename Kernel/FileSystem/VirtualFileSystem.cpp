@@ -27,10 +27,12 @@
 #include <AK/FileSystemPath.h>
 #include <AK/StringBuilder.h>
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/ExecutableCache.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/DiskBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/NameCache.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
@@ -72,8 +74,8 @@ KResult VFS::mount(FS& file_system, Custody& mount_point, int flags)
     auto& inode = mount_point.inode();
     dbg() << "VFS: Mounting " << file_system.class_name() << " at " << mount_point.absolute_path() << " (inode: " << inode.identifier() << ") with flags " << flags;
     // FIXME: check that this is not already a mount point
-    Mount mount { file_system, &mount_point, flags };
-    m_mounts.append(move(mount));
+    m_mounts.append(make<Mount>(file_system, &mount_point, flags));
+    did_change_mounts();
     return KSuccess;
 }
 
@@ -81,8 +83,8 @@ KResult VFS::bind_mount(Custody& source, Custody& mount_point, int flags)
 {
     dbg() << "VFS: Bind-mounting " << source.absolute_path() << " at " << mount_point.absolute_path();
     // FIXME: check that this is not already a mount point
-    Mount mount { source.inode(), mount_point, flags };
-    m_mounts.append(move(mount));
+    m_mounts.append(make<Mount>(source.inode(), mount_point, flags));
+    did_change_mounts();
     return KSuccess;
 }
 
@@ -94,6 +96,9 @@ KResult VFS::unmount(InodeIdentifier guest_inode_id)
     for (size_t i = 0; i < m_mounts.size(); ++i) {
         auto& mount = m_mounts.at(i);
         if (mount.guest() == guest_inode_id) {
+            // Don't let cached lookups or executables keep the file system busy.
+            NameCache::the().invalidate_all();
+            ExecutableCache::the().invalidate_all_for_fs(guest_inode_id.fsid());
             auto result = mount.guest_fs().prepare_to_unmount();
             if (result.is_error()) {
                 dbg() << "VFS: Failed to unmount!";
@@ -101,6 +106,7 @@ KResult VFS::unmount(InodeIdentifier guest_inode_id)
             }
             dbg() << "VFS: found fs " << mount.guest_fs().fsid() << " at mount index " << i << "! Unmounting...";
             m_mounts.unstable_remove(i);
+            did_change_mounts();
             return KSuccess;
         }
     }
@@ -116,10 +122,10 @@ bool VFS::mount_root(FS& file_system)
         return false;
     }
 
-    Mount mount { file_system, nullptr, MS_NODEV | MS_NOSUID };
+    auto mount = make<Mount>(file_system, nullptr, MS_NODEV | MS_NOSUID);
 
-    auto root_inode_id = mount.guest().fs()->root_inode();
-    auto root_inode = mount.guest().fs()->get_inode(root_inode_id);
+    auto root_inode_id = mount->guest().fs()->root_inode();
+    auto root_inode = mount->guest().fs()->get_inode(root_inode_id);
     if (!root_inode->is_directory()) {
         klog() << "VFS: root inode (" << String::format("%02u", root_inode_id.fsid()) << ":" << String::format("%08u", root_inode_id.index()) << ") for / is not a directory :(";
         return false;
@@ -136,16 +142,27 @@ bool VFS::mount_root(FS& file_system)
     klog() << "VFS: mounted root on " << m_root_inode->fs().class_name() << " (" << device_name << ")";
 
     m_mounts.append(move(mount));
+    did_change_mounts();
     return true;
 }
 
-auto VFS::find_mount_for_host(InodeIdentifier inode) -> Mount*
+void VFS::did_change_mounts()
 {
+    // If two things are mounted on the same host inode, the first one wins, like it always has.
+    m_mounts_by_host.clear();
     for (auto& mount : m_mounts) {
-        if (mount.host() == inode)
-            return &mount;
+        auto host = mount.host();
+        if (host.is_valid() && !m_mounts_by_host.contains(host))
+            m_mounts_by_host.set(host, &mount);
     }
-    return nullptr;
+
+    // Cached lookups may have gone to what used to be (or not be) a mount point.
+    NameCache::the().invalidate_all();
+}
+
+auto VFS::find_mount_for_host(InodeIdentifier inode) -> Mount*
+{
+    return m_mounts_by_host.get(inode).value_or(nullptr);
 }
 
 auto VFS::find_mount_for_guest(InodeIdentifier inode) -> Mount*
@@ -300,7 +317,9 @@ KResult VFS::mknod(StringView path, mode_t mode, dev_t dev, Custody& base)
 
     FileSystemPath p(path);
     dbg() << "VFS::mknod: '" << p.basename() << "' mode=" << mode << " dev=" << dev << " in " << parent_inode.identifier();
-    return parent_inode.fs().create_inode(parent_inode.identifier(), p.basename(), mode, 0, dev, Process::current->uid(), Process::current->gid()).result();
+    auto result = parent_inode.fs().create_inode(parent_inode.identifier(), p.basename(), mode, 0, dev, Process::current->uid(), Process::current->gid()).result();
+    NameCache::the().invalidate(parent_inode, p.basename());
+    return result;
 }
 
 KResultOr<NonnullRefPtr<FileDescription>> VFS::create(StringView path, int options, mode_t mode, Custody& parent_custody, Optional<UidAndGid> owner)
@@ -320,6 +339,7 @@ KResultOr<NonnullRefPtr<FileDescription>> VFS::create(StringView path, int optio
     uid_t uid = owner.has_value() ? owner.value().uid : Process::current->uid();
     gid_t gid = owner.has_value() ? owner.value().gid : Process::current->gid();
     auto inode_or_error = parent_inode.fs().create_inode(parent_inode.identifier(), p.basename(), mode, 0, 0, uid, gid);
+    NameCache::the().invalidate(parent_inode, p.basename());
     if (inode_or_error.is_error())
         return inode_or_error.error();
 
@@ -356,7 +376,9 @@ KResult VFS::mkdir(StringView path, mode_t mode, Custody& base)
 #ifdef VFS_DEBUG
     dbg() << "VFS::mkdir: '" << p.basename() << "' in " << parent_inode.identifier();
 #endif
-    return parent_inode.fs().create_directory(parent_inode.identifier(), p.basename(), mode, Process::current->uid(), Process::current->gid());
+    auto create_result = parent_inode.fs().create_directory(parent_inode.identifier(), p.basename(), mode, Process::current->uid(), Process::current->gid());
+    NameCache::the().invalidate(parent_inode, p.basename());
+    return create_result;
 }
 
 KResult VFS::access(StringView path, int mode, Custody& base)
@@ -467,15 +489,20 @@ KResult VFS::rename(StringView old_path, StringView new_path, Custody& base)
         if (new_inode.is_directory() && !old_inode.is_directory())
             return KResult(-EISDIR);
         auto result = new_parent_inode.remove_child(new_basename);
+        NameCache::the().invalidate(new_parent_inode, new_basename);
         if (result.is_error())
             return result;
+        ExecutableCache::the().invalidate(new_inode);
     }
 
     auto result = new_parent_inode.add_child(old_inode.identifier(), new_basename, old_inode.mode());
+    NameCache::the().invalidate(new_parent_inode, new_basename);
     if (result.is_error())
         return result;
 
-    result = old_parent_inode.remove_child(FileSystemPath(old_path).basename());
+    auto old_basename = FileSystemPath(old_path).basename();
+    result = old_parent_inode.remove_child(old_basename);
+    NameCache::the().invalidate(old_parent_inode, old_basename);
     if (result.is_error())
         return result;
 
@@ -550,7 +577,10 @@ KResult VFS::link(StringView old_path, StringView new_path, Custody& base)
     if (old_inode.is_directory())
         return KResult(-EPERM);
 
-    return parent_inode.add_child(old_inode.identifier(), FileSystemPath(new_path).basename(), old_inode.mode());
+    auto new_basename = FileSystemPath(new_path).basename();
+    auto result = parent_inode.add_child(old_inode.identifier(), new_basename, old_inode.mode());
+    NameCache::the().invalidate(parent_inode, new_basename);
+    return result;
 }
 
 KResult VFS::unlink(StringView path, Custody& base)
@@ -574,10 +604,15 @@ KResult VFS::unlink(StringView path, Custody& base)
             return KResult(-EACCES);
     }
 
-    auto result = parent_inode.remove_child(FileSystemPath(path).basename());
+    auto basename = FileSystemPath(path).basename();
+    auto result = parent_inode.remove_child(basename);
+    NameCache::the().invalidate(parent_inode, basename);
     if (result.is_error())
         return result;
 
+    // Let go of the inode so that it can be freed once the last process running it is gone.
+    ExecutableCache::the().invalidate(inode);
+
     return KSuccess;
 }
 
@@ -598,6 +633,7 @@ KResult VFS::symlink(StringView target, StringView linkpath, Custody& base)
     FileSystemPath p(linkpath);
     dbg() << "VFS::symlink: '" << p.basename() << "' (-> '" << target << "') in " << parent_inode.identifier();
     auto inode_or_error = parent_inode.fs().create_inode(parent_inode.identifier(), p.basename(), 0120644, 0, 0, Process::current->uid(), Process::current->gid());
+    NameCache::the().invalidate(parent_inode, p.basename());
     if (inode_or_error.is_error())
         return inode_or_error.error();
     auto& inode = inode_or_error.value();
@@ -641,7 +677,10 @@ KResult VFS::rmdir(StringView path, Custody& base)
     if (result.is_error())
         return result;
 
-    return parent_inode.remove_child(FileSystemPath(path).basename());
+    auto basename = FileSystemPath(path).basename();
+    result = parent_inode.remove_child(basename);
+    NameCache::the().invalidate(parent_inode, basename);
+    return result;
 }
 
 RefPtr<Inode> VFS::get_inode(InodeIdentifier inode_id)
@@ -814,9 +853,31 @@ KResultOr<NonnullRefPtr<Custody>> VFS::resolve_path_without_veil(StringView path
             continue;
         }
 
-        // Okay, let's look up this part.
-        auto child_inode = parent.inode().lookup(part);
-        if (!child_inode) {
+        // Okay, let's look up this part, unless we've done that recently.
+        bool use_name_cache = parent.inode().fs().supports_name_cache();
+        RefPtr<Custody> child_custody;
+        bool found_in_cache = use_name_cache && NameCache::the().lookup(parent, part, child_custody);
+
+        if (!found_in_cache) {
+            u32 generation = NameCache::the().generation();
+            auto child_inode = parent.inode().lookup(part);
+            if (child_inode) {
+                int mount_flags_for_child = parent.mount_flags();
+
+                // See if there's something mounted on the child; in that case
+                // we would need to return the guest inode, not the host inode.
+                if (auto mount = find_mount_for_host(child_inode->identifier())) {
+                    child_inode = get_inode(mount->guest());
+                    mount_flags_for_child = mount->flags();
+                }
+
+                child_custody = Custody::create(&parent, part, *child_inode, mount_flags_for_child);
+            }
+            if (use_name_cache)
+                NameCache::the().add(parent, part, child_custody, generation);
+        }
+
+        if (!child_custody) {
             if (out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
                 // we found the immediate parent of the file, but the file itself
@@ -826,25 +887,17 @@ KResultOr<NonnullRefPtr<Custody>> VFS::resolve_path_without_veil(StringView path
             return KResult(-ENOENT);
         }
 
-        int mount_flags_for_child = parent.mount_flags();
-
-        // See if there's something mounted on the child; in that case
-        // we would need to return the guest inode, not the host inode.
-        if (auto mount = find_mount_for_host(child_inode->identifier())) {
-            child_inode = get_inode(mount->guest());
-            mount_flags_for_child = mount->flags();
-        }
-
-        custody = Custody::create(&parent, part, *child_inode, mount_flags_for_child);
+        custody = *child_custody;
+        auto& child_inode = custody->inode();
 
-        if (child_inode->metadata().is_symlink()) {
+        if (child_inode.metadata().is_symlink()) {
             if (!have_more_parts) {
                 if (options & O_NOFOLLOW)
                     return KResult(-ELOOP);
                 if (options & O_NOFOLLOW_NOERROR)
                     break;
             }
-            auto symlink_target = child_inode->resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1);
+            auto symlink_target = child_inode.resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1);
             if (symlink_target.is_error() || !have_more_parts)
                 return symlink_target;
 
@@ -153,11 +153,13 @@ private:
 
     Mount* find_mount_for_host(InodeIdentifier);
     Mount* find_mount_for_guest(InodeIdentifier);
+    void did_change_mounts();
 
     Lock m_lock { "VFSLock" };
 
     RefPtr<Inode> m_root_inode;
-    Vector<Mount> m_mounts;
+    NonnullOwnPtrVector<Mount> m_mounts;
+    HashMap<InodeIdentifier, Mount*> m_mounts_by_host;
 
     RefPtr<Custody> m_root_custody;
 };
@@ -33,7 +33,7 @@ class CharacterDevice;
 class Custody;
 class Device;
 class DiskCache;
-class DoubleBuffer;
+class EPoll;
 class File;
 class FileDescription;
 class IPv4Socket;
@@ -54,6 +54,7 @@ class ThreadTracer;
 class Range;
 class RangeAllocator;
 class Region;
+class RingBuffer;
 class Scheduler;
 class SharedBuffer;
 class Socket;
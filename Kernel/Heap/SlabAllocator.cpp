@@ -25,138 +25,57 @@
  */
 
 #include <AK/Assertions.h>
-#include <AK/Memory.h>
+#include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
-#include <Kernel/VM/Region.h>
+#include <LibBareMetal/StdLib.h>
 
-#define SANITIZE_SLABS
+#define SANITIZE_OBJECT_CACHES
 
 namespace Kernel {
 
-template<size_t templated_slab_size>
-class SlabAllocator {
-public:
-    SlabAllocator() {}
+ObjectCache* ObjectCache::s_all_caches;
 
-    void init(size_t size)
-    {
-        m_base = kmalloc_eternal(size);
-        m_end = (u8*)m_base + size;
-        FreeSlab* slabs = (FreeSlab*)m_base;
-        size_t slab_count = size / templated_slab_size;
-        for (size_t i = 1; i < slab_count; ++i) {
-            slabs[i].next = &slabs[i - 1];
-        }
-        slabs[0].next = nullptr;
-        m_freelist = &slabs[slab_count - 1];
-        m_num_allocated = 0;
-        m_num_free = slab_count;
+void* ObjectCache::allocate()
+{
+    InterruptDisabler disabler;
+    if (!m_registered) {
+        m_next_cache = s_all_caches;
+        s_all_caches = this;
+        m_registered = true;
     }
 
-    constexpr size_t slab_size() const { return templated_slab_size; }
-
-    void* alloc()
-    {
-        InterruptDisabler disabler;
-        if (!m_freelist)
-            return kmalloc(slab_size());
-        ASSERT(m_freelist);
-        void* ptr = m_freelist;
-        m_freelist = m_freelist->next;
-        ++m_num_allocated;
-        --m_num_free;
-#ifdef SANITIZE_SLABS
-        memset(ptr, SLAB_ALLOC_SCRUB_BYTE, slab_size());
-#endif
-        return ptr;
-    }
+    ++m_live_count;
+    if (!m_freelist)
+        return kmalloc(m_object_size);
 
-    void dealloc(void* ptr)
-    {
-        InterruptDisabler disabler;
-        ASSERT(ptr);
-        if (ptr < m_base || ptr >= m_end) {
-            kfree(ptr);
-            return;
-        }
-        ((FreeSlab*)ptr)->next = m_freelist;
-#ifdef SANITIZE_SLABS
-        if (slab_size() > sizeof(FreeSlab*))
-            memset(((FreeSlab*)ptr)->padding, SLAB_DEALLOC_SCRUB_BYTE, sizeof(FreeSlab::padding));
+    auto* object = m_freelist;
+    m_freelist = object->next;
+    --m_free_count;
+#ifdef SANITIZE_OBJECT_CACHES
+    memset(object, KMALLOC_SCRUB_BYTE, m_object_size);
 #endif
-        m_freelist = (FreeSlab*)ptr;
-        ++m_num_allocated;
-        --m_num_free;
-    }
-
-    size_t num_allocated() const { return m_num_allocated; }
-    size_t num_free() const { return m_num_free; }
-
-private:
-    struct FreeSlab {
-        FreeSlab* next { nullptr };
-        char padding[templated_slab_size - sizeof(FreeSlab*)];
-    };
-
-    // NOTE: These are not default-initialized to prevent an init-time constructor from overwriting them
-    FreeSlab* m_freelist;
-    size_t m_num_allocated;
-    size_t m_num_free;
-    void* m_base;
-    void* m_end;
-
-    static_assert(sizeof(FreeSlab) == templated_slab_size);
-};
-
-static SlabAllocator<16> s_slab_allocator_16;
-static SlabAllocator<32> s_slab_allocator_32;
-static SlabAllocator<64> s_slab_allocator_64;
-
-static_assert(sizeof(Region) <= s_slab_allocator_64.slab_size());
-
-template<typename Callback>
-void for_each_allocator(Callback callback)
-{
-    callback(s_slab_allocator_16);
-    callback(s_slab_allocator_32);
-    callback(s_slab_allocator_64);
-}
-
-void slab_alloc_init()
-{
-    s_slab_allocator_16.init(128 * KB);
-    s_slab_allocator_32.init(128 * KB);
-    s_slab_allocator_64.init(512 * KB);
+    return object;
 }
 
-void* slab_alloc(size_t slab_size)
+void ObjectCache::deallocate(void* ptr)
 {
-    if (slab_size <= 16)
-        return s_slab_allocator_16.alloc();
-    if (slab_size <= 32)
-        return s_slab_allocator_32.alloc();
-    if (slab_size <= 64)
-        return s_slab_allocator_64.alloc();
-    ASSERT_NOT_REACHED();
-}
-
-void slab_dealloc(void* ptr, size_t slab_size)
-{
-    if (slab_size <= 16)
-        return s_slab_allocator_16.dealloc(ptr);
-    if (slab_size <= 32)
-        return s_slab_allocator_32.dealloc(ptr);
-    if (slab_size <= 64)
-        return s_slab_allocator_64.dealloc(ptr);
-    ASSERT_NOT_REACHED();
-}
+    ASSERT(ptr);
+    InterruptDisabler disabler;
+    ASSERT(m_live_count);
+    --m_live_count;
+    if (m_free_count >= m_max_free) {
+        kfree(ptr);
+        return;
+    }
 
-void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)> callback)
-{
-    for_each_allocator([&](auto& allocator) {
-        callback(allocator.slab_size(), allocator.num_allocated(), allocator.num_free());
-    });
+#ifdef SANITIZE_OBJECT_CACHES
+    memset(ptr, KFREE_SCRUB_BYTE, m_object_size);
+#endif
+    auto* object = static_cast<FreeObject*>(ptr);
+    object->next = m_freelist;
+    m_freelist = object;
+    ++m_free_count;
 }
 
 }
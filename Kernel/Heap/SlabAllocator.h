@@ -26,24 +26,80 @@
 
 #pragma once
 
-#include <AK/Function.h>
 #include <AK/Types.h>
 
 namespace Kernel {
 
-#define SLAB_ALLOC_SCRUB_BYTE 0xab
-#define SLAB_DEALLOC_SCRUB_BYTE 0xbc
+// ObjectCache: A per-type cache of fixed-size kernel objects.
+//
+// Freed objects are kept on a per-type freelist (up to a limit) and handed
+// straight back out by the next allocation, so hot types don't have to go
+// through the general kmalloc() path on every create/destroy cycle.
+//
+// Caches are constant-initialized so they can be used before global
+// constructors have run. A cache registers itself for statistics the
+// first time it hands out an object.
+//
+// Objects are not kept in a constructed state while they're on the freelist.
+// The cache sits behind operator new/delete, so every object is still fully
+// constructed and destroyed as usual. Skipping that would need a separate
+// create/recycle path for each type, and the members of these types (RefPtrs,
+// OwnPtrs, Vectors) have to be released on destruction anyway.
 
-void* slab_alloc(size_t slab_size);
-void slab_dealloc(void*, size_t slab_size);
-void slab_alloc_init();
-void slab_alloc_stats(Function<void(size_t slab_size, size_t allocated, size_t free)>);
+class ObjectCache {
+public:
+    constexpr ObjectCache(const char* name, size_t object_size)
+        : m_name(name)
+        , m_object_size(object_size < sizeof(FreeObject) ? sizeof(FreeObject) : object_size)
+        , m_max_free(object_size >= max_cached_bytes / min_cached_objects ? min_cached_objects : max_cached_bytes / object_size)
+    {
+    }
 
-#define MAKE_SLAB_ALLOCATED(type)                                        \
-public:                                                                  \
-    void* operator new(size_t) { return slab_alloc(sizeof(type)); }      \
-    void operator delete(void* ptr) { slab_dealloc(ptr, sizeof(type)); } \
-                                                                         \
+    void* allocate();
+    void deallocate(void*);
+
+    const char* name() const { return m_name; }
+    size_t object_size() const { return m_object_size; }
+    size_t live_count() const { return m_live_count; }
+    size_t free_count() const { return m_free_count; }
+
+    template<typename Callback>
+    static void for_each(Callback callback)
+    {
+        for (auto* cache = s_all_caches; cache; cache = cache->m_next_cache)
+            callback(*cache);
+    }
+
+private:
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    static constexpr size_t max_cached_bytes = 64 * KB;
+    static constexpr size_t min_cached_objects = 8;
+
+    static ObjectCache* s_all_caches;
+
+    const char* m_name { nullptr };
+    size_t m_object_size { 0 };
+    size_t m_max_free { 0 };
+    size_t m_live_count { 0 };
+    size_t m_free_count { 0 };
+    FreeObject* m_freelist { nullptr };
+    ObjectCache* m_next_cache { nullptr };
+    bool m_registered { false };
+};
+
+#define MAKE_SLAB_ALLOCATED(type)                                               \
+public:                                                                         \
+    static ObjectCache& object_cache()                                          \
+    {                                                                           \
+        static ObjectCache cache { #type, sizeof(type) };                       \
+        return cache;                                                           \
+    }                                                                           \
+    void* operator new(size_t) { return object_cache().allocate(); }            \
+    void operator delete(void* ptr) { object_cache().deallocate(ptr); }         \
+                                                                                \
 private:
 
 }
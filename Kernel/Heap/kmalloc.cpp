@@ -25,34 +25,112 @@
  */
 
 /*
- * Really really *really* Q&D malloc() and free() implementations
- * just to get going. Don't ever let anyone see this shit. :^)
+ * The kernel heap.
+ *
+ * Memory is handed out in whole pages from a list of pools. The first pool is
+ * the static range set aside at boot, further pools are carved out of kernel
+ * regions from the MemoryManager when the heap runs low.
+ *
+ * Requests up to slab_max_object_size are served by per-size-class slab
+ * caches (power-of-two object sizes, one page per slab). Anything larger
+ * gets a page-aligned run of whole pages. The bookkeeping for every page
+ * lives out of line in its pool's HeapPage array, so neither path needs an
+ * in-band allocation header.
  */
 
 #include <AK/Assertions.h>
+#include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
 #include <Kernel/Scheduler.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/WaitQueue.h>
 #include <LibBareMetal/StdLib.h>
 
 #define SANITIZE_KMALLOC
 
-struct AllocationHeader {
-    size_t allocation_size_in_chunks;
-    u8 data[0];
-};
-
 #define BASE_PHYSICAL (0xc0000000 + (4 * MB))
-#define CHUNK_SIZE 32
 #define POOL_SIZE (3 * MB)
 
 #define ETERNAL_BASE_PHYSICAL (0xc0000000 + (2 * MB))
 #define ETERNAL_RANGE_SIZE (2 * MB)
 
-static u8 alloc_map[POOL_SIZE / CHUNK_SIZE / 8];
+static constexpr size_t slab_min_object_size = 16;
+static constexpr size_t slab_max_object_size = 2048;
+static constexpr size_t slab_cache_count = 8;
+static_assert((slab_min_object_size << (slab_cache_count - 1)) == slab_max_object_size);
+
+// Each pool taken from the MemoryManager is this large, including its bookkeeping pages.
+static constexpr size_t grown_pool_size = 1 * MB;
+
+// When fewer free pages than this remain, the finalizer is asked to add another pool.
+// The headroom has to cover everything the MemoryManager allocates while doing so.
+static constexpr size_t low_water_pages = 64;
+
+struct FreeObject {
+    FreeObject* next;
+};
+
+enum class HeapPageType : u8 {
+    Free = 0,
+    Slab,
+    LargeHead,
+    LargeTail,
+};
+
+struct HeapPage {
+    // Links in the owning cache's list of slabs with free objects.
+    HeapPage* prev;
+    HeapPage* next;
+    FreeObject* freelist;
+    u32 large_page_count;
+    u16 objects_in_use;
+    u8 cache_index;
+    HeapPageType type;
+};
+
+struct HeapPool {
+    HeapPool* next;
+    u8* base;
+    size_t page_count;
+    size_t free_page_count;
+    size_t search_hint;
+    u32* bitmap;
+    HeapPage* pages;
+
+    bool contains(const void* ptr) const { return ptr >= base && ptr < base + page_count * PAGE_SIZE; }
+    size_t bitmap_word_count() const { return (page_count + 31) / 32; }
+    size_t index_of(const void* ptr) const { return ((FlatPtr)ptr - (FlatPtr)base) / PAGE_SIZE; }
+    u8* address_of(size_t index) const { return base + index * PAGE_SIZE; }
+};
+
+struct SlabCache {
+    size_t object_size;
+    size_t objects_per_slab;
+    HeapPage* partial_slabs;
+    size_t slab_count;
+    size_t objects_in_use;
+    size_t objects_free;
+};
+
+static constexpr size_t initial_pool_page_count = POOL_SIZE / PAGE_SIZE;
+static u32 s_initial_pool_bitmap[(initial_pool_page_count + 31) / 32];
+static HeapPage s_initial_pool_pages[initial_pool_page_count];
+static HeapPool s_initial_pool;
+
+static HeapPool* s_pools;
+static size_t s_pool_count;
+static size_t s_total_pages;
+static size_t s_free_pages;
+static size_t s_large_allocations;
+static size_t s_large_pages;
+static bool s_growing;
+static bool s_growth_requested;
+
+static SlabCache s_slab_caches[slab_cache_count];
 
 volatile size_t sum_alloc = 0;
 volatile size_t sum_free = POOL_SIZE;
@@ -65,14 +143,363 @@ bool g_dump_kmalloc_stacks;
 static u8* s_next_eternal_ptr;
 static u8* s_end_of_eternal_range;
 
+[[noreturn]] static void kmalloc_panic(const char* message, const void* ptr, size_t size)
+{
+    klog() << "kmalloc(): PANIC! " << message << " (ptr=" << ptr << ", size=" << size << ", sum_free=" << sum_free << ")";
+    Kernel::dump_backtrace();
+    Kernel::hang();
+}
+
+static void add_pool(HeapPool& pool, u8* base, size_t page_count, u32* bitmap, HeapPage* pages)
+{
+    pool.base = base;
+    pool.page_count = page_count;
+    pool.free_page_count = page_count;
+    pool.search_hint = 0;
+    pool.bitmap = bitmap;
+    pool.pages = pages;
+    memset(pool.bitmap, 0, pool.bitmap_word_count() * sizeof(u32));
+    memset(pool.pages, 0, page_count * sizeof(HeapPage));
+
+    // Mark the tail of the last bitmap word as used so the scans never hand it out.
+    if (page_count % 32)
+        pool.bitmap[page_count / 32] = ~((1u << (page_count % 32)) - 1);
+
+    pool.next = s_pools;
+    s_pools = &pool;
+    ++s_pool_count;
+    s_total_pages += page_count;
+    s_free_pages += page_count;
+    sum_free += page_count * PAGE_SIZE;
+}
+
+static HeapPool* pool_containing(const void* ptr)
+{
+    for (auto* pool = s_pools; pool; pool = pool->next) {
+        if (pool->contains(ptr))
+            return pool;
+    }
+    return nullptr;
+}
+
+static void mark_pages(HeapPool& pool, size_t first, size_t count, bool in_use)
+{
+    for (size_t index = first; index < first + count; ++index) {
+        if (in_use)
+            pool.bitmap[index / 32] |= 1u << (index % 32);
+        else
+            pool.bitmap[index / 32] &= ~(1u << (index % 32));
+    }
+}
+
+static ssize_t find_free_run(HeapPool& pool, size_t count)
+{
+    size_t word_count = pool.bitmap_word_count();
+    if (count == 1) {
+        for (size_t n = 0; n < word_count; ++n) {
+            size_t word_index = (pool.search_hint + n) % word_count;
+            u32 free_bits = ~pool.bitmap[word_index];
+            if (!free_bits)
+                continue;
+            pool.search_hint = word_index;
+            return word_index * 32 + __builtin_ctz(free_bits);
+        }
+        return -1;
+    }
+
+    size_t run_start = 0;
+    size_t run_length = 0;
+    for (size_t index = 0; index < pool.page_count;) {
+        u32 word = pool.bitmap[index / 32];
+        if (!(index % 32) && word == 0xffffffff) {
+            // Skip over a completely full word.
+            run_length = 0;
+            index += 32;
+            continue;
+        }
+        if (word & (1u << (index % 32))) {
+            run_length = 0;
+        } else {
+            if (!run_length)
+                run_start = index;
+            if (++run_length == count)
+                return run_start;
+        }
+        ++index;
+    }
+    return -1;
+}
+
+static bool grow_heap()
+{
+    {
+        Kernel::InterruptDisabler disabler;
+        if (s_growing || !Kernel::MemoryManager::is_initialized() || Kernel::g_in_irq)
+            return false;
+        s_growing = true;
+    }
+
+    auto region = MM.allocate_kernel_region(grown_pool_size, "kmalloc", Kernel::Region::Access::Read | Kernel::Region::Access::Write);
+    s_growing = false;
+    if (!region)
+        return false;
+
+    // The pool's own bookkeeping lives in the first pages of the region.
+    u8* region_base = region->vaddr().as_ptr();
+    size_t page_count = grown_pool_size / PAGE_SIZE;
+    size_t bitmap_size = ((page_count + 31) / 32) * sizeof(u32);
+    size_t metadata_size = sizeof(HeapPool) + bitmap_size + page_count * sizeof(HeapPage);
+    size_t metadata_pages = (metadata_size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    // The region now belongs to the heap for good.
+    (void)region.leak_ptr();
+
+    Kernel::InterruptDisabler disabler;
+    auto& pool = *reinterpret_cast<HeapPool*>(region_base);
+    auto* bitmap = reinterpret_cast<u32*>(region_base + sizeof(HeapPool));
+    auto* pages = reinterpret_cast<HeapPage*>(region_base + sizeof(HeapPool) + bitmap_size);
+    add_pool(pool, region_base + metadata_pages * PAGE_SIZE, page_count - metadata_pages, bitmap, pages);
+    return true;
+}
+
+static void request_growth_if_needed()
+{
+    if (s_free_pages >= low_water_pages || s_growth_requested || !Kernel::g_finalizer_wait_queue)
+        return;
+    s_growth_requested = true;
+    Kernel::g_finalizer_has_work = true;
+    Kernel::g_finalizer_wait_queue->wake_all();
+}
+
+void kmalloc_grow_if_needed()
+{
+    {
+        Kernel::InterruptDisabler disabler;
+        if (!s_growth_requested)
+            return;
+        s_growth_requested = false;
+    }
+    while (s_free_pages < low_water_pages) {
+        if (!grow_heap())
+            break;
+    }
+}
+
+static u8* allocate_pages(size_t count)
+{
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (auto* pool = s_pools; pool; pool = pool->next) {
+            if (pool->free_page_count < count)
+                continue;
+            ssize_t first = find_free_run(*pool, count);
+            if (first < 0)
+                continue;
+            mark_pages(*pool, first, count, true);
+            pool->free_page_count -= count;
+            s_free_pages -= count;
+            sum_free -= count * PAGE_SIZE;
+            request_growth_if_needed();
+            return pool->address_of(first);
+        }
+        // Nothing fits; as a last resort, grow synchronously and try once more.
+        if (!grow_heap())
+            break;
+    }
+    return nullptr;
+}
+
+static void free_pages(HeapPool& pool, size_t first, size_t count)
+{
+#ifdef SANITIZE_KMALLOC
+    memset(pool.address_of(first), KFREE_SCRUB_BYTE, count * PAGE_SIZE);
+#endif
+    for (size_t index = first; index < first + count; ++index)
+        pool.pages[index].type = HeapPageType::Free;
+    mark_pages(pool, first, count, false);
+    pool.free_page_count += count;
+    s_free_pages += count;
+    sum_free += count * PAGE_SIZE;
+}
+
+static size_t cache_index_for_size(size_t size)
+{
+    if (size <= slab_min_object_size)
+        return 0;
+    return (32 - __builtin_clz(size - 1)) - __builtin_ctz(slab_min_object_size);
+}
+
+static size_t allocation_size_for_request(size_t size)
+{
+    if (size <= slab_max_object_size)
+        return s_slab_caches[cache_index_for_size(size)].object_size;
+    return PAGE_ROUND_UP(size);
+}
+
+static void link_partial_slab(SlabCache& cache, HeapPage& page)
+{
+    page.prev = nullptr;
+    page.next = cache.partial_slabs;
+    if (cache.partial_slabs)
+        cache.partial_slabs->prev = &page;
+    cache.partial_slabs = &page;
+}
+
+static void unlink_partial_slab(SlabCache& cache, HeapPage& page)
+{
+    if (page.prev)
+        page.prev->next = page.next;
+    else
+        cache.partial_slabs = page.next;
+    if (page.next)
+        page.next->prev = page.prev;
+    page.prev = nullptr;
+    page.next = nullptr;
+}
+
+static HeapPage* create_slab(size_t cache_index)
+{
+    auto& cache = s_slab_caches[cache_index];
+    u8* address = allocate_pages(1);
+    if (!address)
+        return nullptr;
+    auto& pool = *pool_containing(address);
+    auto& page = pool.pages[pool.index_of(address)];
+    page.type = HeapPageType::Slab;
+    page.cache_index = cache_index;
+    page.objects_in_use = 0;
+
+    FreeObject* freelist = nullptr;
+    for (size_t i = cache.objects_per_slab; i > 0; --i) {
+        auto* object = reinterpret_cast<FreeObject*>(address + (i - 1) * cache.object_size);
+        object->next = freelist;
+        freelist = object;
+    }
+    page.freelist = freelist;
+
+    link_partial_slab(cache, page);
+    ++cache.slab_count;
+    cache.objects_free += cache.objects_per_slab;
+    sum_free += cache.objects_per_slab * cache.object_size;
+    return &page;
+}
+
+static void* slab_cache_allocate(size_t cache_index)
+{
+    auto& cache = s_slab_caches[cache_index];
+    auto* page = cache.partial_slabs;
+    if (!page) {
+        page = create_slab(cache_index);
+        if (!page)
+            return nullptr;
+    }
+
+    auto* object = page->freelist;
+    page->freelist = object->next;
+    ++page->objects_in_use;
+    if (!page->freelist)
+        unlink_partial_slab(cache, *page);
+
+    ++cache.objects_in_use;
+    --cache.objects_free;
+    sum_alloc += cache.object_size;
+    sum_free -= cache.object_size;
+    return object;
+}
+
+static void slab_cache_deallocate(HeapPool& pool, HeapPage& page, void* ptr)
+{
+    auto& cache = s_slab_caches[page.cache_index];
+    size_t page_index = &page - pool.pages;
+    u8* slab_base = pool.address_of(page_index);
+    if (((u8*)ptr - slab_base) % cache.object_size)
+        kmalloc_panic("kfree() of misaligned slab object", ptr, cache.object_size);
+
+#ifdef SANITIZE_KMALLOC
+    memset(ptr, KFREE_SCRUB_BYTE, cache.object_size);
+#endif
+    bool was_full = !page.freelist;
+    auto* object = static_cast<FreeObject*>(ptr);
+    object->next = page.freelist;
+    page.freelist = object;
+    --page.objects_in_use;
+    if (was_full)
+        link_partial_slab(cache, page);
+
+    --cache.objects_in_use;
+    ++cache.objects_free;
+    sum_alloc -= cache.object_size;
+    sum_free += cache.object_size;
+
+    // Give an empty slab back to the page pool, unless it's the cache's only spare capacity.
+    if (!page.objects_in_use && cache.objects_free - cache.objects_per_slab >= cache.objects_per_slab) {
+        unlink_partial_slab(cache, page);
+        --cache.slab_count;
+        cache.objects_free -= cache.objects_per_slab;
+        sum_free -= cache.objects_per_slab * cache.object_size;
+        free_pages(pool, page_index, 1);
+    }
+}
+
+static void* allocate_large(size_t size)
+{
+    size_t page_count = PAGE_ROUND_UP(size) / PAGE_SIZE;
+    u8* address = allocate_pages(page_count);
+    if (!address)
+        return nullptr;
+    auto& pool = *pool_containing(address);
+    size_t first = pool.index_of(address);
+    pool.pages[first].type = HeapPageType::LargeHead;
+    pool.pages[first].large_page_count = page_count;
+    for (size_t index = first + 1; index < first + page_count; ++index)
+        pool.pages[index].type = HeapPageType::LargeTail;
+
+    ++s_large_allocations;
+    s_large_pages += page_count;
+    sum_alloc += page_count * PAGE_SIZE;
+    return address;
+}
+
+static void deallocate_large(HeapPool& pool, HeapPage& page, void* ptr)
+{
+    size_t first = &page - pool.pages;
+    if (ptr != pool.address_of(first))
+        kmalloc_panic("kfree() of pointer into the middle of a large allocation", ptr, page.large_page_count * PAGE_SIZE);
+
+    size_t page_count = page.large_page_count;
+    --s_large_allocations;
+    s_large_pages -= page_count;
+    sum_alloc -= page_count * PAGE_SIZE;
+    free_pages(pool, first, page_count);
+}
+
 void kmalloc_init()
 {
-    memset(&alloc_map, 0, sizeof(alloc_map));
     memset((void*)BASE_PHYSICAL, 0, POOL_SIZE);
 
+    s_pools = nullptr;
+    s_pool_count = 0;
+    s_total_pages = 0;
+    s_free_pages = 0;
+    s_large_allocations = 0;
+    s_large_pages = 0;
+    s_growing = false;
+    s_growth_requested = false;
+
     kmalloc_sum_eternal = 0;
     sum_alloc = 0;
-    sum_free = POOL_SIZE;
+    sum_free = 0;
+
+    for (size_t i = 0; i < slab_cache_count; ++i) {
+        auto& cache = s_slab_caches[i];
+        cache.object_size = slab_min_object_size << i;
+        cache.objects_per_slab = PAGE_SIZE / cache.object_size;
+        cache.partial_slabs = nullptr;
+        cache.slab_count = 0;
+        cache.objects_in_use = 0;
+        cache.objects_free = 0;
+    }
+
+    add_pool(s_initial_pool, (u8*)BASE_PHYSICAL, initial_pool_page_count, s_initial_pool_bitmap, s_initial_pool_pages);
 
     s_next_eternal_ptr = (u8*)ETERNAL_BASE_PHYSICAL;
     s_end_of_eternal_range = s_next_eternal_ptr + ETERNAL_RANGE_SIZE;
@@ -103,7 +530,8 @@ void kfree_aligned(void* ptr)
 
 void* kmalloc_page_aligned(size_t size)
 {
-    void* ptr = kmalloc_aligned(size, PAGE_SIZE);
+    // Large allocations are whole pages, so make sure we end up on that path.
+    void* ptr = kmalloc(max(size, slab_max_object_size + 1));
     size_t d = (size_t)ptr;
     ASSERT((d & PAGE_MASK) == d);
     return ptr;
@@ -119,64 +547,19 @@ void* kmalloc_impl(size_t size)
         Kernel::dump_backtrace();
     }
 
-    // We need space for the AllocationHeader at the head of the block.
-    size_t real_size = size + sizeof(AllocationHeader);
+    void* ptr;
+    if (size <= slab_max_object_size)
+        ptr = slab_cache_allocate(cache_index_for_size(size));
+    else
+        ptr = allocate_large(size);
 
-    if (sum_free < real_size) {
-        Kernel::dump_backtrace();
-        klog() << "kmalloc(): PANIC! Out of memory (sucks, dude)\nsum_free=" << sum_free << ", real_size=" << real_size;
-        Kernel::hang();
-    }
-
-    size_t chunks_needed = real_size / CHUNK_SIZE;
-    if (real_size % CHUNK_SIZE)
-        ++chunks_needed;
-
-    size_t chunks_here = 0;
-    size_t first_chunk = 0;
+    if (!ptr)
+        kmalloc_panic("Out of memory", nullptr, size);
 
-    for (size_t i = 0; i < (POOL_SIZE / CHUNK_SIZE / 8); ++i) {
-        if (alloc_map[i] == 0xff) {
-            // Skip over completely full bucket.
-            chunks_here = 0;
-            continue;
-        }
-        // FIXME: This scan can be optimized further with LZCNT.
-        for (size_t j = 0; j < 8; ++j) {
-            if (!(alloc_map[i] & (1 << j))) {
-                if (chunks_here == 0) {
-                    // Mark where potential allocation starts.
-                    first_chunk = i * 8 + j;
-                }
-
-                ++chunks_here;
-
-                if (chunks_here == chunks_needed) {
-                    auto* a = (AllocationHeader*)(BASE_PHYSICAL + (first_chunk * CHUNK_SIZE));
-                    u8* ptr = a->data;
-                    a->allocation_size_in_chunks = chunks_needed;
-
-                    for (size_t k = first_chunk; k < (first_chunk + chunks_needed); ++k) {
-                        alloc_map[k / 8] |= 1 << (k % 8);
-                    }
-
-                    sum_alloc += a->allocation_size_in_chunks * CHUNK_SIZE;
-                    sum_free -= a->allocation_size_in_chunks * CHUNK_SIZE;
 #ifdef SANITIZE_KMALLOC
-                    memset(ptr, KMALLOC_SCRUB_BYTE, (a->allocation_size_in_chunks * CHUNK_SIZE) - sizeof(AllocationHeader));
+    memset(ptr, KMALLOC_SCRUB_BYTE, allocation_size_for_request(size));
 #endif
-                    return ptr;
-                }
-            } else {
-                // This is in use, so restart chunks_here counter.
-                chunks_here = 0;
-            }
-        }
-    }
-
-    klog() << "kmalloc(): PANIC! Out of memory (no suitable block for size " << size << ")";
-    Kernel::dump_backtrace();
-    Kernel::hang();
+    return ptr;
 }
 
 void kfree(void* ptr)
@@ -187,18 +570,34 @@ void kfree(void* ptr)
     Kernel::InterruptDisabler disabler;
     ++g_kfree_call_count;
 
-    auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
-    FlatPtr start = ((FlatPtr)a - (FlatPtr)BASE_PHYSICAL) / CHUNK_SIZE;
+    auto* pool = pool_containing(ptr);
+    if (!pool)
+        kmalloc_panic("kfree() of pointer outside the heap", ptr, 0);
 
-    for (size_t k = start; k < (start + a->allocation_size_in_chunks); ++k)
-        alloc_map[k / 8] &= ~(1 << (k % 8));
-
-    sum_alloc -= a->allocation_size_in_chunks * CHUNK_SIZE;
-    sum_free += a->allocation_size_in_chunks * CHUNK_SIZE;
+    auto& page = pool->pages[pool->index_of(ptr)];
+    switch (page.type) {
+    case HeapPageType::Slab:
+        slab_cache_deallocate(*pool, page, ptr);
+        return;
+    case HeapPageType::LargeHead:
+        deallocate_large(*pool, page, ptr);
+        return;
+    default:
+        kmalloc_panic("kfree() of pointer that was never allocated", ptr, 0);
+    }
+}
 
-#ifdef SANITIZE_KMALLOC
-    memset(a, KFREE_SCRUB_BYTE, a->allocation_size_in_chunks * CHUNK_SIZE);
-#endif
+static size_t allocation_size(void* ptr)
+{
+    auto* pool = pool_containing(ptr);
+    if (!pool)
+        kmalloc_panic("krealloc() of pointer outside the heap", ptr, 0);
+    auto& page = pool->pages[pool->index_of(ptr)];
+    if (page.type == HeapPageType::Slab)
+        return s_slab_caches[page.cache_index].object_size;
+    if (page.type == HeapPageType::LargeHead)
+        return page.large_page_count * PAGE_SIZE;
+    kmalloc_panic("krealloc() of pointer that was never allocated", ptr, 0);
 }
 
 void* krealloc(void* ptr, size_t new_size)
@@ -208,10 +607,8 @@ void* krealloc(void* ptr, size_t new_size)
 
     Kernel::InterruptDisabler disabler;
 
-    auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
-    size_t old_size = a->allocation_size_in_chunks * CHUNK_SIZE;
-
-    if (old_size == new_size)
+    size_t old_size = allocation_size(ptr);
+    if (old_size == allocation_size_for_request(new_size))
         return ptr;
 
     auto* new_ptr = kmalloc(new_size);
@@ -220,6 +617,25 @@ void* krealloc(void* ptr, size_t new_size)
     return new_ptr;
 }
 
+size_t kmalloc_cache_count()
+{
+    return slab_cache_count;
+}
+
+KmallocCacheStatistics kmalloc_cache_statistics(size_t index)
+{
+    ASSERT(index < slab_cache_count);
+    Kernel::InterruptDisabler disabler;
+    auto& cache = s_slab_caches[index];
+    return { cache.object_size, cache.slab_count, cache.objects_in_use, cache.objects_free };
+}
+
+KmallocPoolStatistics kmalloc_pool_statistics()
+{
+    Kernel::InterruptDisabler disabler;
+    return { s_pool_count, s_total_pages, s_free_pages, s_large_allocations, s_large_pages };
+}
+
 void* operator new(size_t size)
 {
     return kmalloc(size);
@@ -41,6 +41,26 @@ void kmalloc_init();
 void* krealloc(void*, size_t);
 void kfree(void*);
 void kfree_aligned(void*);
+void kmalloc_grow_if_needed();
+
+struct KmallocCacheStatistics {
+    size_t object_size;
+    size_t slab_count;
+    size_t objects_in_use;
+    size_t objects_free;
+};
+
+struct KmallocPoolStatistics {
+    size_t pool_count;
+    size_t total_pages;
+    size_t free_pages;
+    size_t large_allocations;
+    size_t large_pages;
+};
+
+size_t kmalloc_cache_count();
+KmallocCacheStatistics kmalloc_cache_statistics(size_t index);
+KmallocPoolStatistics kmalloc_pool_statistics();
 
 extern volatile size_t sum_alloc;
 extern volatile size_t sum_free;
@@ -41,12 +41,14 @@
 #include <AK/LogStream.h>
 #include <AK/Memory.h>
 #include <AK/StringView.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/Region.h>
 
 namespace Kernel {
 
 class KBufferImpl : public RefCounted<KBufferImpl> {
+    MAKE_SLAB_ALLOCATED(KBufferImpl)
 public:
     static NonnullRefPtr<KBufferImpl> create_with_size(size_t size, u8 access, const char* name)
     {
@@ -108,6 +110,7 @@ public:
     void set_size(size_t size) { m_impl->set_size(size); }
 
     const KBufferImpl& impl() const { return m_impl; }
+    KBufferImpl& impl() { return m_impl; }
 
     KBuffer(const ByteBuffer& buffer, u8 access = Region::Access::Read | Region::Access::Write, const char* name = "KBuffer")
         : m_impl(KBufferImpl::copy(buffer.data(), buffer.size(), access, name))
@@ -25,6 +25,7 @@
  */
 
 #include <AK/Demangle.h>
+#include <AK/QuickSort.h>
 #include <AK/TemporaryChange.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/KSyms.h>
@@ -40,6 +41,12 @@ u32 ksym_highest_address = 0;
 u32 ksym_count = 0;
 bool ksyms_ready = false;
 
+// Open-addressed table of (index + 1) into s_ksyms, hashed by name. Only module loading
+// looks symbols up by name, so it's built the first time someone does.
+static u32* s_ksym_name_table;
+static u32 s_ksym_name_table_size;
+static Lock* s_ksym_name_table_lock;
+
 static u8 parse_hex_digit(char nibble)
 {
     if (nibble >= '0' && nibble <= '9')
@@ -48,11 +55,39 @@ static u8 parse_hex_digit(char nibble)
     return 10 + (nibble - 'a');
 }
 
+static void build_ksym_name_table()
+{
+    s_ksym_name_table_size = 1;
+    while (s_ksym_name_table_size < ksym_count * 2)
+        s_ksym_name_table_size <<= 1;
+    auto* table = static_cast<u32*>(kmalloc_eternal(sizeof(u32) * s_ksym_name_table_size));
+    memset(table, 0, sizeof(u32) * s_ksym_name_table_size);
+
+    u32 mask = s_ksym_name_table_size - 1;
+    for (u32 i = 0; i < ksym_count; ++i) {
+        u32 slot = string_hash(s_ksyms[i].name, strlen(s_ksyms[i].name)) & mask;
+        while (table[slot])
+            slot = (slot + 1) & mask;
+        table[slot] = i + 1;
+    }
+    s_ksym_name_table = table;
+}
+
 u32 address_for_kernel_symbol(const StringView& name)
 {
-    for (unsigned i = 0; i < ksym_count; ++i) {
-        if (!strncmp(name.characters_without_null_termination(), s_ksyms[i].name, name.length()))
-            return s_ksyms[i].address;
+    if (!ksyms_ready)
+        return 0;
+    {
+        LOCKER(*s_ksym_name_table_lock);
+        if (!s_ksym_name_table)
+            build_ksym_name_table();
+    }
+
+    u32 mask = s_ksym_name_table_size - 1;
+    for (u32 slot = string_hash(name.characters_without_null_termination(), name.length()) & mask; s_ksym_name_table[slot]; slot = (slot + 1) & mask) {
+        auto& ksym = s_ksyms[s_ksym_name_table[slot] - 1];
+        if (!strncmp(name.characters_without_null_termination(), ksym.name, name.length()) && !ksym.name[name.length()])
+            return ksym.address;
     }
     return 0;
 }
@@ -61,11 +96,24 @@ const KSym* ksymbolicate(u32 address)
 {
     if (address < ksym_lowest_address || address > ksym_highest_address)
         return nullptr;
-    for (unsigned i = 0; i < ksym_count; ++i) {
-        if (address < s_ksyms[i + 1].address)
-            return &s_ksyms[i];
+
+    // Find the last symbol at or below the address.
+    u32 low = 0;
+    u32 high = ksym_count;
+    while (low + 1 < high) {
+        u32 middle = low + (high - low) / 2;
+        if (s_ksyms[middle].address <= address)
+            low = middle;
+        else
+            high = middle;
     }
-    return nullptr;
+    return &s_ksyms[low];
+}
+
+const KSym& ksym_at(u32 index)
+{
+    ASSERT(index < ksym_count);
+    return s_ksyms[index];
 }
 
 static void load_ksyms_from_data(const ByteBuffer& buffer)
@@ -84,8 +132,9 @@ static void load_ksyms_from_data(const ByteBuffer& buffer)
     klog() << "Loading ksyms...";
 
     unsigned current_ksym_index = 0;
+    bool is_sorted = true;
 
-    while (bufptr < buffer.end_pointer()) {
+    while (bufptr < buffer.end_pointer() && current_ksym_index < ksym_count) {
         for (unsigned i = 0; i < 8; ++i)
             address = (address << 4) | parse_hex_digit(*(bufptr++));
         bufptr += 3;
@@ -102,6 +151,8 @@ static void load_ksyms_from_data(const ByteBuffer& buffer)
         name[bufptr - start_of_name] = '\0';
         ksym.name = name;
 
+        if (current_ksym_index && ksym.address < s_ksyms[current_ksym_index - 1].address)
+            is_sorted = false;
         if (ksym.address < ksym_lowest_address)
             ksym_lowest_address = ksym.address;
         if (ksym.address > ksym_highest_address)
@@ -110,6 +161,13 @@ static void load_ksyms_from_data(const ByteBuffer& buffer)
         ++bufptr;
         ++current_ksym_index;
     }
+    ksym_count = current_ksym_index;
+
+    // kernel.map comes out of `nm -n`, so this is normally a no-op, but lookups depend on it.
+    if (!is_sorted)
+        quick_sort(s_ksyms, s_ksyms + ksym_count, [](auto& a, auto& b) { return a.address < b.address; });
+
+    s_ksym_name_table_lock = new Lock("KSyms");
     klog() << "ok";
     ksyms_ready = true;
 }
@@ -38,9 +38,11 @@ struct KSym {
 
 u32 address_for_kernel_symbol(const StringView& name);
 const KSym* ksymbolicate(u32 address);
+const KSym& ksym_at(u32 index);
 void load_ksyms();
 
 extern bool ksyms_ready;
+extern u32 ksym_count;
 extern u32 ksym_lowest_address;
 extern u32 ksym_highest_address;
 
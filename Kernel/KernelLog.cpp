@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/KParams.h>
+#include <Kernel/KernelLog.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
+#include <LibBareMetal/Output/Console.h>
+#include <LibBareMetal/Output/kstdio.h>
+#include <LibBareMetal/StdLib.h>
+
+namespace Kernel {
+
+// Writers claim a sequence number (and with it, a slot) with a single atomic increment.
+// While a slot is being filled in its tag is 0, and once it's done the tag is set to the
+// sequence number + 1. Readers copy a record out and then check that the tag didn't change
+// underneath them, so they never have to wait for a writer (or a writer for them.)
+struct LogSlot {
+    Atomic<u32> tag;
+    LogLevel level;
+    u8 length;
+    u64 timestamp_us;
+    char text[KernelLog::max_record_length];
+};
+
+static LogSlot s_slots[KernelLog::record_count];
+static Atomic<u32> s_next_sequence;
+static LogLevel s_console_level = LogLevel::Info;
+
+static Thread* s_drain_thread;
+static WaitQueue* s_drain_wait_queue;
+static Atomic<bool> s_drain_requested;
+static Atomic<bool> s_draining;
+static u32 s_drain_sequence;
+
+static u64 now_us()
+{
+    if (!TimeManagement::initialized())
+        return 0;
+    return g_uptime * 1000000 / TimeManagement::the().ticks_per_second();
+}
+
+static bool is_ready(u32 sequence)
+{
+    return s_slots[sequence % KernelLog::record_count].tag.load(AK::memory_order_acquire) == sequence + 1;
+}
+
+static void drain(bool force)
+{
+    do {
+        if (s_draining.exchange(true) && !force)
+            return;
+        KernelLog::Record record;
+        for (;;) {
+            auto result = KernelLog::read(s_drain_sequence, record);
+            if (result == KernelLog::ReadResult::NotReady)
+                break;
+            if (result == KernelLog::ReadResult::Overwritten) {
+                s_drain_sequence = KernelLog::first_sequence();
+                continue;
+            }
+            ++s_drain_sequence;
+            kernel_log_emit(record.text, record.length, record.level <= s_console_level);
+        }
+        s_draining.store(false);
+        // Someone may have finished a record (and found us busy) after we stopped looking.
+    } while (is_ready(s_drain_sequence));
+}
+
+static void request_drain()
+{
+    // Until there's a drain thread (and whenever there's no scheduler to run it), drain right here.
+    if (!s_drain_thread || !Thread::current) {
+        drain(false);
+        return;
+    }
+    if (!s_drain_requested.exchange(true))
+        s_drain_wait_queue->wake_all();
+}
+
+void KernelLog::write(LogLevel level, const char* characters, size_t length)
+{
+    auto timestamp = now_us();
+    while (length) {
+        size_t chunk_length = min(length, max_record_length);
+        u32 sequence = s_next_sequence.fetch_add(1, AK::memory_order_acq_rel);
+        auto& slot = s_slots[sequence % record_count];
+        slot.tag.store(0);
+        slot.level = level;
+        slot.length = chunk_length;
+        slot.timestamp_us = timestamp;
+        memcpy(slot.text, characters, chunk_length);
+        slot.tag.store(sequence + 1, AK::memory_order_release);
+        characters += chunk_length;
+        length -= chunk_length;
+    }
+    request_drain();
+}
+
+KernelLog::ReadResult KernelLog::read(u32 sequence, Record& record)
+{
+    auto& slot = s_slots[sequence % record_count];
+    u32 tag = slot.tag.load(AK::memory_order_acquire);
+    if (tag != sequence + 1) {
+        if (tag && (i32)(tag - 1 - sequence) > 0)
+            return ReadResult::Overwritten;
+        // The slot may also be in the middle of being reused for a newer record.
+        if ((i32)(s_next_sequence.load(AK::memory_order_acquire) - sequence) > (i32)record_count)
+            return ReadResult::Overwritten;
+        return ReadResult::NotReady;
+    }
+
+    record.sequence = sequence;
+    record.level = slot.level;
+    record.timestamp_us = slot.timestamp_us;
+    record.length = slot.length;
+    memcpy(record.text, slot.text, record.length);
+
+    asm volatile("" ::: "memory");
+    if (slot.tag.load(AK::memory_order_acquire) != sequence + 1)
+        return ReadResult::Overwritten;
+    return ReadResult::Success;
+}
+
+u32 KernelLog::first_sequence()
+{
+    u32 next = next_sequence();
+    return next > record_count ? next - record_count : 0;
+}
+
+u32 KernelLog::next_sequence()
+{
+    return s_next_sequence.load(AK::memory_order_acquire);
+}
+
+LogLevel KernelLog::console_level()
+{
+    return s_console_level;
+}
+
+void KernelLog::set_console_level(LogLevel level)
+{
+    s_console_level = level;
+}
+
+void KernelLog::drain_thread_main()
+{
+    if (KParams::the().has("loglevel")) {
+        bool ok;
+        unsigned level = KParams::the().get("loglevel").to_uint(ok);
+        if (ok && level <= (unsigned)LogLevel::Debug)
+            set_console_level((LogLevel)level);
+    }
+
+    s_drain_wait_queue = new WaitQueue;
+    s_drain_thread = Thread::current;
+    for (;;) {
+        {
+            InterruptDisabler disabler;
+            if (!s_drain_requested.load())
+                Thread::current->wait_on(*s_drain_wait_queue);
+            s_drain_requested.store(false);
+        }
+        drain(false);
+    }
+}
+
+void KernelLog::flush()
+{
+    drain(true);
+    if (Console::is_initialized())
+        Console::the().flush();
+}
+
+}
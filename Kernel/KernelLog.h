@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Same numbering as syslog, lower is more important.
+enum class LogLevel : u8 {
+    Emergency = 0,
+    Alert,
+    Critical,
+    Error,
+    Warning,
+    Notice,
+    Info,
+    Debug,
+};
+
+// The kernel log: a ring of timestamped records that klog() and dbg() (and anything else
+// that logs) add to without taking locks or disabling interrupts, so it's safe and cheap to
+// log from anywhere. A drain thread puts the records out on the console and serial port,
+// and readers (/proc/dmesg, /dev/kmsg) walk it by sequence number at their own pace.
+class KernelLog {
+public:
+    static const size_t max_record_length = 128;
+    static const size_t record_count = 1024;
+
+    struct Record {
+        u32 sequence { 0 };
+        LogLevel level { LogLevel::Info };
+        u64 timestamp_us { 0 };
+        size_t length { 0 };
+        char text[max_record_length];
+    };
+
+    enum class ReadResult {
+        Success,
+        // The record hasn't been written (completely) yet.
+        NotReady,
+        // The record has already been overwritten by newer ones.
+        Overwritten,
+    };
+
+    static void write(LogLevel, const char*, size_t);
+    static ReadResult read(u32 sequence, Record&);
+
+    // The oldest record that may still be around, and the sequence number the next record will get.
+    static u32 first_sequence();
+    static u32 next_sequence();
+
+    // Messages at or below this level are shown on the console.
+    static LogLevel console_level();
+    static void set_console_level(LogLevel);
+
+    static void drain_thread_main();
+
+    // Put everything logged so far out right now, for when we're about to halt.
+    static void flush();
+};
+
+}
@@ -182,6 +182,11 @@ bool IPv4Socket::can_write(const FileDescription&) const
     return is_connected();
 }
 
+bool IPv4Socket::is_hung_up(const FileDescription&) const
+{
+    return m_role != Role::Listener && protocol_is_disconnected();
+}
+
 int IPv4Socket::allocate_local_port_if_needed()
 {
     if (m_local_port)
@@ -387,6 +392,7 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
         m_can_read = true;
     }
     m_bytes_received += packet_size;
+    notify_readiness_observers();
 #ifdef IPV4_SOCKET_DEBUG
     if (buffer_mode() == BufferMode::Bytes)
         dbg() << "IPv4Socket(" << this << "): did_receive " << packet_size << " bytes, total_received=" << m_bytes_received;
@@ -573,6 +579,7 @@ void IPv4Socket::shut_down_for_reading()
 {
     Socket::shut_down_for_reading();
     m_can_read = true;
+    notify_readiness_observers();
 }
 
 }
@@ -28,12 +28,12 @@
 
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedList.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/RingBuffer.h>
 
 namespace Kernel {
 
@@ -58,6 +58,7 @@ public:
     virtual void detach(FileDescription&) override;
     virtual bool can_read(const FileDescription&) const override;
     virtual bool can_write(const FileDescription&) const override;
+    virtual bool is_hung_up(const FileDescription&) const override;
     virtual ssize_t sendto(FileDescription&, const void*, size_t, int, const sockaddr*, socklen_t) override;
     virtual ssize_t recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) override;
     virtual KResult setsockopt(int level, int option, const void*, socklen_t) override;
@@ -124,7 +125,7 @@ private:
 
     SinglyLinkedList<ReceivedPacket> m_receive_queue;
 
-    DoubleBuffer m_receive_buffer;
+    RingBuffer m_receive_buffer;
 
     u16 m_local_port { 0 };
     u16 m_peer_port { 0 };
@@ -28,11 +28,11 @@
 
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedList.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/RingBuffer.h>
 
 class IPv4SocketTuple {
 public:
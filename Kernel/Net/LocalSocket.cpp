@@ -215,6 +215,7 @@ void LocalSocket::attach(FileDescription& description)
         ASSERT(m_connect_side_fd != &description);
         m_accept_side_fd_open = true;
     }
+    notify_readiness_observers();
 }
 
 void LocalSocket::detach(FileDescription& description)
@@ -225,6 +226,7 @@ void LocalSocket::detach(FileDescription& description)
         ASSERT(m_accept_side_fd_open);
         m_accept_side_fd_open = false;
     }
+    notify_readiness_observers();
 }
 
 bool LocalSocket::can_read(const FileDescription& description) const
@@ -259,17 +261,27 @@ bool LocalSocket::can_write(const FileDescription& description) const
     return false;
 }
 
+bool LocalSocket::is_hung_up(const FileDescription& description) const
+{
+    auto role = this->role(description);
+    if (role == Role::Accepted || role == Role::Connected)
+        return !has_attached_peer(description);
+    return false;
+}
+
 ssize_t LocalSocket::sendto(FileDescription& description, const void* data, size_t data_size, int, const sockaddr*, socklen_t)
 {
     if (!has_attached_peer(description))
         return -EPIPE;
     ssize_t nwritten = send_buffer_for(description).write((const u8*)data, data_size);
-    if (nwritten > 0)
+    if (nwritten > 0) {
         Thread::current->did_unix_socket_write(nwritten);
+        notify_readiness_observers();
+    }
     return nwritten;
 }
 
-DoubleBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
+RingBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Accepted)
@@ -279,7 +291,7 @@ DoubleBuffer& LocalSocket::receive_buffer_for(FileDescription& description)
     ASSERT_NOT_REACHED();
 }
 
-DoubleBuffer& LocalSocket::send_buffer_for(FileDescription& description)
+RingBuffer& LocalSocket::send_buffer_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Connected)
@@ -307,8 +319,10 @@ ssize_t LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t
         return 0;
     ASSERT(!buffer_for_me.is_empty());
     int nread = buffer_for_me.read((u8*)buffer, buffer_size);
-    if (nread > 0)
+    if (nread > 0) {
         Thread::current->did_unix_socket_read(nread);
+        notify_readiness_observers();
+    }
     return nread;
 }
 
@@ -27,8 +27,8 @@
 #pragma once
 
 #include <AK/InlineLinkedList.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/RingBuffer.h>
 
 namespace Kernel {
 
@@ -57,6 +57,7 @@ public:
     virtual void detach(FileDescription&) override;
     virtual bool can_read(const FileDescription&) const override;
     virtual bool can_write(const FileDescription&) const override;
+    virtual bool is_hung_up(const FileDescription&) const override;
     virtual ssize_t sendto(FileDescription&, const void*, size_t, int, const sockaddr*, socklen_t) override;
     virtual ssize_t recvfrom(FileDescription&, void*, size_t, int flags, sockaddr*, socklen_t*) override;
     virtual KResult getsockopt(FileDescription&, int level, int option, void*, socklen_t*) override;
@@ -69,8 +70,8 @@ private:
     virtual bool is_local() const override { return true; }
     bool has_attached_peer(const FileDescription&) const;
     static Lockable<InlineLinkedList<LocalSocket>>& all_sockets();
-    DoubleBuffer& receive_buffer_for(FileDescription&);
-    DoubleBuffer& send_buffer_for(FileDescription&);
+    RingBuffer& receive_buffer_for(FileDescription&);
+    RingBuffer& send_buffer_for(FileDescription&);
 
     // An open socket file on the filesystem.
     RefPtr<FileDescription> m_file;
@@ -97,8 +98,8 @@ private:
     bool m_accept_side_fd_open { false };
     sockaddr_un m_address { 0, { 0 } };
 
-    DoubleBuffer m_for_client;
-    DoubleBuffer m_for_server;
+    RingBuffer m_for_client;
+    RingBuffer m_for_server;
 
     // for InlineLinkedList
     LocalSocket* m_prev { nullptr };
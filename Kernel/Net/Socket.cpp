@@ -69,6 +69,7 @@ void Socket::set_setup_state(SetupState new_setup_state)
 #endif
 
     m_setup_state = new_setup_state;
+    notify_readiness_observers();
 }
 
 RefPtr<Socket> Socket::accept()
@@ -85,6 +86,7 @@ RefPtr<Socket> Socket::accept()
     client->m_acceptor = { process.pid(), process.uid(), process.gid() };
     client->m_connected = true;
     client->m_role = Role::Accepted;
+    client->notify_readiness_observers();
     return client;
 }
 
@@ -97,6 +99,7 @@ KResult Socket::queue_connection_from(NonnullRefPtr<Socket> peer)
     if (m_pending.size() >= m_backlog)
         return KResult(-ECONNREFUSED);
     m_pending.append(peer);
+    notify_readiness_observers();
     return KSuccess;
 }
 
@@ -175,6 +178,7 @@ KResult Socket::shutdown(int how)
         shut_down_for_reading();
     m_shut_down_for_reading |= (how & SHUT_RD) != 0;
     m_shut_down_for_writing |= (how & SHUT_WR) != 0;
+    notify_readiness_observers();
     return KSuccess;
 }
 
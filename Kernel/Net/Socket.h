@@ -90,7 +90,11 @@ public:
     virtual Role role(const FileDescription&) const { return m_role; }
 
     bool is_connected() const { return m_connected; }
-    void set_connected(bool connected) { m_connected = connected; }
+    void set_connected(bool connected)
+    {
+        m_connected = connected;
+        notify_readiness_observers();
+    }
 
     bool can_accept() const { return !m_pending.is_empty(); }
     RefPtr<Socket> accept();
@@ -153,6 +157,7 @@ protected:
 
 private:
     virtual bool is_socket() const final { return true; }
+    virtual bool has_readiness_notifications() const final { return true; }
 
     Lock m_lock { "Socket" };
 
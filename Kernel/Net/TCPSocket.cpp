@@ -60,6 +60,8 @@ void TCPSocket::set_state(State new_state)
         LOCKER(closing_sockets().lock());
         closing_sockets().resource().remove(tuple());
     }
+
+    notify_readiness_observers();
 }
 
 Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_sockets()
@@ -183,8 +185,20 @@ int TCPSocket::protocol_send(const void* data, size_t data_length)
 
 void TCPSocket::send_tcp_packet(u16 flags, const void* payload, size_t payload_size)
 {
-    auto buffer = ByteBuffer::create_zeroed(sizeof(TCPPacket) + payload_size);
-    auto& tcp_packet = *(TCPPacket*)(buffer.data());
+    // Only packets that may need retransmission outlive this function and need a heap buffer.
+    // Bare ACK/FIN/RST packets are by far the most common and are built on the stack instead.
+    bool needs_retransmit = (flags & TCPFlags::SYN) || payload_size > 0;
+
+    u8 control_packet_buffer[sizeof(TCPPacket)];
+    ByteBuffer buffer;
+    u8* packet_data = control_packet_buffer;
+    if (needs_retransmit) {
+        buffer = ByteBuffer::create_uninitialized(sizeof(TCPPacket) + payload_size);
+        packet_data = buffer.data();
+    }
+    memset(packet_data, 0, sizeof(TCPPacket));
+
+    auto& tcp_packet = *(TCPPacket*)packet_data;
     ASSERT(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
@@ -202,10 +216,11 @@ void TCPSocket::send_tcp_packet(u16 flags, const void* payload, size_t payload_s
         m_sequence_number += payload_size;
     }
 
-    memcpy(tcp_packet.payload(), payload, payload_size);
+    if (payload_size)
+        memcpy(tcp_packet.payload(), payload, payload_size);
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
 
-    if (tcp_packet.has_syn() || payload_size > 0) {
+    if (needs_retransmit) {
         LOCKER(m_not_acked_lock);
         m_not_acked.append({ m_sequence_number, move(buffer) });
         send_outgoing_packets();
@@ -217,10 +232,10 @@ void TCPSocket::send_tcp_packet(u16 flags, const void* payload, size_t payload_s
 
     routing_decision.adapter->send_ipv4(
         routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-        buffer.data(), buffer.size(), ttl());
+        control_packet_buffer, sizeof(control_packet_buffer), ttl());
 
     m_packets_out++;
-    m_bytes_out += buffer.size();
+    m_bytes_out += sizeof(control_packet_buffer);
 }
 
 void TCPSocket::send_outgoing_packets()
@@ -183,6 +183,7 @@ private:
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
     virtual bool protocol_is_disconnected() const override;
+    virtual bool has_pending_error(const FileDescription&) const override { return has_error(); }
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen() override;
 
@@ -24,107 +24,124 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/JsonArraySerializer.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonObjectSerializer.h>
+#include <AK/StringBuilder.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/PerformanceEventBuffer.h>
+#include <LibC/sys/profile.h>
 
 namespace Kernel {
 
+static const size_t max_event_stack_depth = 32;
+
 PerformanceEventBuffer::PerformanceEventBuffer()
     : m_buffer(KBuffer::create_with_size(4 * MB))
 {
 }
 
-KResult PerformanceEventBuffer::append(int type, FlatPtr arg1, FlatPtr arg2)
+void* PerformanceEventBuffer::allocate_record(u16 type, size_t size)
 {
-    if (count() >= capacity())
-        return KResult(-ENOBUFS);
-
-    PerformanceEvent event;
-    event.type = type;
+    size = align_up_to(size, sizeof(u32));
+    if (size > 0xffff || m_size + size > m_buffer.size())
+        return nullptr;
+    auto* header = reinterpret_cast<profile_record_header*>(m_buffer.data() + m_size);
+    memset(header, 0, size);
+    header->type = type;
+    header->size = size;
+    m_size += size;
+    return header;
+}
 
+KResult PerformanceEventBuffer::append(int type, FlatPtr arg1, FlatPtr arg2)
+{
     switch (type) {
     case PERF_EVENT_MALLOC:
-        event.data.malloc.size = arg1;
-        event.data.malloc.ptr = arg2;
 #ifdef VERY_DEBUG
-        dbg() << "PERF_EVENT_MALLOC: " << (void*)event.data.malloc.ptr << " (" << event.data.malloc.size << ")";
+        dbg() << "PERF_EVENT_MALLOC: " << (void*)arg2 << " (" << arg1 << ")";
 #endif
         break;
     case PERF_EVENT_FREE:
-        event.data.free.ptr = arg1;
 #ifdef VERY_DEBUG
-        dbg() << "PERF_EVENT_FREE: " << (void*)event.data.free.ptr;
+        dbg() << "PERF_EVENT_FREE: " << (void*)arg1;
 #endif
         break;
+    case PERF_EVENT_TRACE_BEGIN:
+    case PERF_EVENT_TRACE_END:
+    case PERF_EVENT_TRACE_INSTANT:
+        break;
     default:
         return KResult(-EINVAL);
     }
 
-    FlatPtr ebp;
-    asm volatile("movl %%ebp, %%eax"
-                 : "=a"(ebp));
-    //copy_from_user(&ebp, (FlatPtr*)current->get_register_dump_from_stack().ebp);
+    // The end of a traced scope is only ever looked at together with its beginning,
+    // so skip the stack walk and keep the record small.
     Vector<FlatPtr> backtrace;
-    {
+    if (type != PERF_EVENT_TRACE_END) {
+        FlatPtr ebp;
+        asm volatile("movl %%ebp, %%eax"
+                     : "=a"(ebp));
         SmapDisabler disabler;
         backtrace = Thread::current->raw_backtrace(ebp);
     }
-    event.stack_size = min(sizeof(event.stack) / sizeof(FlatPtr), static_cast<size_t>(backtrace.size()));
-    memcpy(event.stack, backtrace.data(), event.stack_size * sizeof(FlatPtr));
+
+    // The first entry is the frame pointer we started from, and the kernel frames
+    // are always the same trip through sys$perf_event(), so only keep user frames.
+    Vector<FlatPtr, max_event_stack_depth> frames;
+    for (size_t i = 1; i < backtrace.size() && frames.size() < max_event_stack_depth; ++i) {
+        if (backtrace[i] < 0xc0000000)
+            frames.append(backtrace[i]);
+    }
+
+    auto* event = static_cast<profile_event*>(allocate_record(PROFILE_RECORD_EVENT, sizeof(profile_event) + frames.size() * sizeof(u32)));
+    if (!event)
+        return KResult(-ENOBUFS);
+
+    event->tid = Thread::current->tid();
+    event->timestamp = g_uptime;
+    event->type = type;
+    event->arg1 = arg1;
+    event->arg2 = arg2;
+    event->frame_count = frames.size();
+    auto* event_frames = reinterpret_cast<u32*>(event + 1);
+    for (size_t i = 0; i < frames.size(); ++i)
+        event_frames[i] = frames[i];
 
 #ifdef VERY_DEBUG
-    for (size_t i = 0; i < event.stack_size; ++i)
-        dbg() << "    " << (void*)event.stack[i];
+    for (size_t i = 0; i < frames.size(); ++i)
+        dbg() << "    " << (void*)frames[i];
 #endif
 
-    event.timestamp = g_uptime;
-    at(m_count++) = event;
     return KSuccess;
 }
 
-PerformanceEvent& PerformanceEventBuffer::at(size_t index)
+KResult PerformanceEventBuffer::append_tracepoint_name(u32 id, const String& name)
 {
-    ASSERT(index < capacity());
-    auto* events = reinterpret_cast<PerformanceEvent*>(m_buffer.data());
-    return events[index];
+    auto* tracepoint = static_cast<profile_tracepoint*>(allocate_record(PROFILE_RECORD_TRACEPOINT, sizeof(profile_tracepoint) + name.length()));
+    if (!tracepoint)
+        return KResult(-ENOBUFS);
+    tracepoint->id = id;
+    tracepoint->name_length = name.length();
+    memcpy(tracepoint + 1, name.characters(), name.length());
+    return KSuccess;
 }
 
-KBuffer PerformanceEventBuffer::to_json(pid_t pid, const String& executable_path) const
+KBuffer PerformanceEventBuffer::to_binary(pid_t pid, const String& process_name, const String& executable_path) const
 {
     KBufferBuilder builder;
 
-    JsonObjectSerializer object(builder);
-    object.add("pid", pid);
-    object.add("executable", executable_path);
-
-    auto array = object.add_array("events");
-    for (size_t i = 0; i < m_count; ++i) {
-        auto& event = at(i);
-        auto event_object = array.add_object();
-        switch (event.type) {
-        case PERF_EVENT_MALLOC:
-            event_object.add("type", "malloc");
-            event_object.add("ptr", static_cast<u64>(event.data.malloc.ptr));
-            event_object.add("size", static_cast<u64>(event.data.malloc.size));
-            break;
-        case PERF_EVENT_FREE:
-            event_object.add("type", "free");
-            event_object.add("ptr", static_cast<u64>(event.data.free.ptr));
-            break;
-        }
-        event_object.add("timestamp", event.timestamp);
-        auto stack_array = event_object.add_array("stack");
-        for (size_t j = 0; j < event.stack_size; ++j) {
-            stack_array.add(event.stack[j]);
-        }
-        stack_array.finish();
-        event_object.finish();
-    }
-    array.finish();
-    object.finish();
+    size_t strings_length = process_name.length() + executable_path.length();
+    profile_process process;
+    process.header.type = PROFILE_RECORD_PROCESS;
+    process.header.size = align_up_to(sizeof(process) + strings_length, sizeof(u32));
+    process.pid = pid;
+    process.name_length = process_name.length();
+    process.executable_length = executable_path.length();
+    builder.append(reinterpret_cast<const char*>(&process), sizeof(process));
+    builder.append(process_name.characters(), process_name.length());
+    builder.append(executable_path.characters(), executable_path.length());
+    for (size_t i = sizeof(process) + strings_length; i < process.header.size; ++i)
+        builder.append('\0');
+
+    builder.append(reinterpret_cast<const char*>(m_buffer.data()), m_size);
     return builder.build();
 }
 
@@ -31,49 +31,23 @@
 
 namespace Kernel {
 
-struct [[gnu::packed]] MallocPerformanceEvent
-{
-    size_t size;
-    FlatPtr ptr;
-};
-
-struct [[gnu::packed]] FreePerformanceEvent
-{
-    size_t size;
-    FlatPtr ptr;
-};
-
-struct [[gnu::packed]] PerformanceEvent
-{
-    u8 type { 0 };
-    u8 stack_size { 0 };
-    u64 timestamp;
-    union {
-        MallocPerformanceEvent malloc;
-        FreePerformanceEvent free;
-    } data;
-    FlatPtr stack[32];
-};
-
+// Events a process reports through perf_event(), stored back to back as the
+// variable-length records described in <LibC/sys/profile.h>.
 class PerformanceEventBuffer {
 public:
     PerformanceEventBuffer();
 
     KResult append(int type, FlatPtr arg1, FlatPtr arg2);
+    KResult append_tracepoint_name(u32 id, const String& name);
 
-    size_t capacity() const { return m_buffer.size() / sizeof(PerformanceEvent); }
-    size_t count() const { return m_count; }
-    const PerformanceEvent& at(size_t index) const
-    {
-        return const_cast<PerformanceEventBuffer&>(*this).at(index);
-    }
+    size_t size() const { return m_size; }
 
-    KBuffer to_json(pid_t, const String& executable_path) const;
+    KBuffer to_binary(pid_t, const String& process_name, const String& executable_path) const;
 
 private:
-    PerformanceEvent& at(size_t index);
+    void* allocate_record(u16 type, size_t size);
 
-    size_t m_count { 0 };
+    size_t m_size { 0 };
     KBuffer m_buffer;
 };
 
@@ -38,8 +38,10 @@
 #include <Kernel/Devices/NullDevice.h>
 #include <Kernel/Devices/PCSpeaker.h>
 #include <Kernel/Devices/RandomDevice.h>
+#include <Kernel/ExecutableCache.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/DevPtsFS.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -71,6 +73,7 @@
 #include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/PurgeableVMObject.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/VM/SwapManager.h>
 #include <LibBareMetal/IO.h>
 #include <LibBareMetal/Output/Console.h>
 #include <LibBareMetal/StdLib.h>
@@ -540,6 +543,8 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
             && !validate_inode_mmap_prot(*this, prot, static_cast<const InodeVMObject&>(whole_region->vmobject()).inode(), whole_region->is_shared())) {
             return -EACCES;
         }
+        if (prot & PROT_WRITE)
+            whole_region->prepare_for_write_access();
         whole_region->set_readable(prot & PROT_READ);
         whole_region->set_writable(prot & PROT_WRITE);
         whole_region->set_executable(prot & PROT_EXEC);
@@ -566,6 +571,8 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
 
         size_t new_range_offset_in_vmobject = old_region->offset_in_vmobject() + (range_to_mprotect.base().get() - old_region->range().base().get());
         auto& new_region = allocate_split_region(*old_region, range_to_mprotect, new_range_offset_in_vmobject);
+        if (prot & PROT_WRITE)
+            new_region.prepare_for_write_access();
         new_region.set_readable(prot & PROT_READ);
         new_region.set_writable(prot & PROT_WRITE);
         new_region.set_executable(prot & PROT_EXEC);
@@ -682,21 +689,45 @@ int Process::sys$gethostname(char* buffer, ssize_t size)
     return 0;
 }
 
+void Process::inherit_into_child(Process& child) const
+{
+    child.m_root_directory = m_root_directory;
+    child.m_root_directory_relative_to_global_root = m_root_directory_relative_to_global_root;
+    child.m_promises = m_promises;
+    child.m_execpromises = m_execpromises;
+    child.m_veil_state = m_veil_state;
+    child.m_unveiled_paths = m_unveiled_paths;
+    child.m_fds = m_fds;
+    child.m_sid = m_sid;
+    child.m_pgid = m_pgid;
+    child.m_umask = m_umask;
+    child.m_extra_gids = m_extra_gids;
+}
+
+bool Process::copy_string_list_from_user(const Syscall::StringListArgument& list, Vector<String>& output)
+{
+    if (!list.length)
+        return true;
+    if (!validate_read_typed(list.strings, list.length))
+        return false;
+    Vector<Syscall::StringArgument, 32> strings;
+    strings.resize(list.length);
+    copy_from_user(strings.data(), list.strings, list.length * sizeof(Syscall::StringArgument));
+    for (size_t i = 0; i < list.length; ++i) {
+        auto string = validate_and_copy_string_from_user(strings[i]);
+        if (string.is_null())
+            return false;
+        output.append(move(string));
+    }
+    return true;
+}
+
 pid_t Process::sys$fork(RegisterState& regs)
 {
     REQUIRE_PROMISE(proc);
     Thread* child_first_thread = nullptr;
     auto* child = new Process(child_first_thread, m_name, m_uid, m_gid, m_pid, m_ring, m_cwd, m_executable, m_tty, this);
-    child->m_root_directory = m_root_directory;
-    child->m_root_directory_relative_to_global_root = m_root_directory_relative_to_global_root;
-    child->m_promises = m_promises;
-    child->m_execpromises = m_execpromises;
-    child->m_veil_state = m_veil_state;
-    child->m_unveiled_paths = m_unveiled_paths;
-    child->m_fds = m_fds;
-    child->m_sid = m_sid;
-    child->m_pgid = m_pgid;
-    child->m_umask = m_umask;
+    inherit_into_child(*child);
 
 #ifdef FORK_DEBUG
     dbg() << "fork: child=" << child;
@@ -706,15 +737,15 @@ pid_t Process::sys$fork(RegisterState& regs)
 #ifdef FORK_DEBUG
         dbg() << "fork: cloning Region{" << &region << "} '" << region.name() << "' @ " << region.vaddr();
 #endif
+        // The child's page tables are populated lazily by page faults,
+        // so a child that goes straight to exec() never pays for them.
         auto& child_region = child->add_region(region.clone());
-        child_region.map(child->page_directory());
+        child_region.set_page_directory(child->page_directory());
 
         if (&region == m_master_tls_region)
             child->m_master_tls_region = child_region.make_weak_ptr();
     }
 
-    child->m_extra_gids = m_extra_gids;
-
     auto& child_tss = child_first_thread->m_tss;
     child_tss.eax = 0; // fork() returns 0 in the child :^)
     child_tss.ebx = regs.ebx;
@@ -806,9 +837,13 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
         return -ENOENT;
 
     auto& inode = interpreter_description ? *interpreter_description->inode() : *main_program_description->inode();
-    auto vmobject = SharedInodeVMObject::create_with_inode(inode);
+    auto image = ExecutableCache::the().get(inode);
+    if (!image) {
+        klog() << "do_exec: Failure loading " << path.characters();
+        return -ENOEXEC;
+    }
 
-    if (static_cast<const SharedInodeVMObject&>(*vmobject).writable_mappings()) {
+    if (static_cast<const SharedInodeVMObject&>(image->vmobject()).writable_mappings()) {
         dbg() << "Refusing to execute a write-mapped program";
         return -ETXTBSY;
     }
@@ -828,8 +863,6 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     dbg() << "Process " << pid() << " exec: PD=" << m_page_directory.ptr() << " created";
 #endif
 
-    InodeMetadata loader_metadata;
-
     // FIXME: Hoooo boy this is a hack if I ever saw one.
     //      This is the 'random' offset we're giving to our ET_DYN exectuables to start as.
     //      It also happens to be the static Virtual Addresss offset every static exectuable gets :)
@@ -838,17 +871,8 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     u32 totally_random_offset = interpreter_description ? 0x08000000 : 0;
 
     // FIXME: We should be able to load both the PT_INTERP interpreter and the main program... once the RTLD is smart enough
-    if (interpreter_description) {
-        loader_metadata = interpreter_description->metadata();
-        // we don't need the interpreter file desciption after we've loaded (or not) it into memory
-        interpreter_description = nullptr;
-    } else {
-        loader_metadata = main_program_description->metadata();
-    }
-
-    auto region = MM.allocate_kernel_region_with_vmobject(*vmobject, PAGE_ROUND_UP(loader_metadata.size), "ELF loading", Region::Access::Read);
-    if (!region)
-        return -ENOMEM;
+    // we don't need the interpreter file desciption after we've loaded (or not) it into memory
+    interpreter_description = nullptr;
 
     Region* master_tls_region { nullptr };
     size_t master_tls_size = 0;
@@ -856,48 +880,48 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     u32 entry_eip = 0;
 
     MM.enter_process_paging_scope(*this);
-    OwnPtr<ELFLoader> loader;
     {
         ArmedScopeGuard rollback_regions_guard([&]() {
-            ASSERT(Process::current == this);
             m_page_directory = move(old_page_directory);
             m_regions = move(old_regions);
-            MM.enter_process_paging_scope(*this);
+            // NOTE: sys$spawn() runs exec() on behalf of a brand new process, so go back to the caller's address space.
+            MM.enter_process_paging_scope(*Process::current);
         });
-        loader = make<ELFLoader>(region->vaddr().as_ptr(), loader_metadata.size);
-        // Load the correct executable -- either interp or main program.
+        // Map the correct executable -- either interp or main program.
         // FIXME: Once we actually load both interp and main, we'll need to be more clever about this.
         //     In that case, both will be ET_DYN objects, so they'll both be completely relocatable.
         //     That means, we can put them literally anywhere in User VM space (ASLR anyone?).
         // ALSO FIXME: Reminder to really really fix that 'totally random offset' business.
-        loader->map_section_hook = [&](VirtualAddress vaddr, size_t size, size_t alignment, size_t offset_in_image, bool is_readable, bool is_writable, bool is_executable, const String& name) -> u8* {
-            ASSERT(size);
-            ASSERT(alignment == PAGE_SIZE);
+        for (auto& segment : image->segments()) {
             int prot = 0;
-            if (is_readable)
+            if (segment.is_readable)
                 prot |= PROT_READ;
-            if (is_writable)
+            if (segment.is_writable)
                 prot |= PROT_WRITE;
-            if (is_executable)
+            if (segment.is_executable)
                 prot |= PROT_EXEC;
-            if (auto* region = allocate_region_with_vmobject(vaddr.offset(totally_random_offset), size, *vmobject, offset_in_image, String(name), prot)) {
+            auto vaddr = segment.vaddr.offset(totally_random_offset);
+            if (segment.is_writable) {
+                // Start out sharing the cached image's pages and copy them on the first write.
+                auto name = String::format("elf-alloc-%s%s", segment.is_readable ? "r" : "", "w");
+                auto* region = allocate_region_with_vmobject(vaddr, segment.data->size(), segment.data->clone(), 0, name, prot);
+                if (!region) {
+                    klog() << "do_exec: Failure loading " << path.characters();
+                    return -ENOEXEC;
+                }
+                for (size_t i = 0; i < region->page_count(); ++i)
+                    region->set_should_cow(i, true);
+                region->remap();
+            } else {
+                auto name = String::format("elf-map-%s%s", segment.is_readable ? "r" : "", segment.is_executable ? "x" : "");
+                auto* region = allocate_region_with_vmobject(vaddr, segment.size_in_memory, image->vmobject(), segment.offset_in_image, name, prot);
+                if (!region) {
+                    klog() << "do_exec: Failure loading " << path.characters();
+                    return -ENOEXEC;
+                }
                 region->set_shared(true);
-                return region->vaddr().as_ptr();
             }
-            return nullptr;
-        };
-        loader->alloc_section_hook = [&](VirtualAddress vaddr, size_t size, size_t alignment, bool is_readable, bool is_writable, const String& name) -> u8* {
-            ASSERT(size);
-            ASSERT(alignment == PAGE_SIZE);
-            int prot = 0;
-            if (is_readable)
-                prot |= PROT_READ;
-            if (is_writable)
-                prot |= PROT_WRITE;
-            if (auto* region = allocate_region(vaddr.offset(totally_random_offset), size, String(name), prot))
-                return region->vaddr().as_ptr();
-            return nullptr;
-        };
+        }
 
         // FIXME: Move TLS region allocation to userspace: LibC and the dynamic loader.
         //     LibC if we end up with a statically linked executable, and the
@@ -905,30 +929,30 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
         //     that gets loaded as part of DT_NEEDED processing, and via dlopen()
         //     If that doesn't happen quickly, at least pass the location of the TLS region
         //     some ELF Auxilliary Vector so the loader can use it/create new ones as necessary.
-        loader->tls_section_hook = [&](size_t size, size_t alignment) {
-            ASSERT(size);
-            master_tls_region = allocate_region({}, size, String(), PROT_READ | PROT_WRITE);
-            master_tls_size = size;
-            master_tls_alignment = alignment;
-            return master_tls_region->vaddr().as_ptr();
-        };
-        bool success = loader->load();
-        if (!success) {
-            klog() << "do_exec: Failure loading " << path.characters();
-            return -ENOEXEC;
+        if (image->has_tls()) {
+            master_tls_region = allocate_region({}, image->tls_size(), String(), PROT_READ | PROT_WRITE);
+            if (!master_tls_region) {
+                klog() << "do_exec: Failure loading " << path.characters();
+                return -ENOEXEC;
+            }
+            master_tls_size = image->tls_size();
+            master_tls_alignment = image->tls_alignment();
+            if (!image->tls_image().is_empty())
+                copy_to_user(master_tls_region->vaddr().as_ptr(), image->tls_image().data(), image->tls_image().size());
         }
+
         // FIXME: Validate that this virtual address is within executable region,
         //     instead of just non-null. You could totally have a DSO with entry point of
         //     the beginning of the text segement.
-        if (!loader->entry().offset(totally_random_offset).get()) {
-            klog() << "do_exec: Failure loading " << path.characters() << ", entry pointer is invalid! (" << loader->entry().offset(totally_random_offset) << ")";
+        if (!image->entry().offset(totally_random_offset).get()) {
+            klog() << "do_exec: Failure loading " << path.characters() << ", entry pointer is invalid! (" << image->entry().offset(totally_random_offset) << ")";
             return -ENOEXEC;
         }
 
         rollback_regions_guard.disarm();
 
         // NOTE: At this point, we've committed to the new executable.
-        entry_eip = loader->entry().offset(totally_random_offset).get();
+        entry_eip = image->entry().offset(totally_random_offset).get();
 
         kill_threads_except_self();
 
@@ -946,7 +970,10 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     m_unveiled_paths.clear();
 
     // Copy of the master TLS region that we will clone for new threads
-    m_master_tls_region = master_tls_region->make_weak_ptr();
+    if (master_tls_region)
+        m_master_tls_region = master_tls_region->make_weak_ptr();
+    else
+        m_master_tls_region = nullptr;
 
     auto main_program_metadata = main_program_description->metadata();
 
@@ -957,10 +984,6 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
             m_egid = main_program_metadata.gid;
     }
 
-    Thread::current->set_default_signal_dispositions();
-    Thread::current->m_signal_mask = 0;
-    Thread::current->m_pending_signals = 0;
-
     m_futex_queues.clear();
 
     m_region_lookup_cache = {};
@@ -986,6 +1009,10 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     }
     ASSERT(new_main_thread);
 
+    new_main_thread->set_default_signal_dispositions();
+    new_main_thread->m_signal_mask = 0;
+    new_main_thread->m_pending_signals = 0;
+
     // NOTE: We create the new stack before disabling interrupts since it will zero-fault
     //       and we don't want to deal with faults after this point.
     u32 new_userspace_esp = new_main_thread->make_userspace_stack_for_main_thread(move(arguments), move(environment));
@@ -1037,6 +1064,8 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
 
     if (was_profiling)
         Profiling::did_exec(path);
+    if (Profiling::is_streaming())
+        Profiling::did_exec_for_stream(*this);
 
     new_main_thread->set_state(Thread::State::Skip1SchedulerPass);
     big_lock().force_unlock_if_locked();
@@ -1208,6 +1237,7 @@ int Process::exec(String path, Vector<String> arguments, Vector<String> environm
 
     // The bulk of exec() is done by do_exec(), which ensures that all locals
     // are cleaned up by the time we yield-teleport below.
+    auto exec_start = kgettimeofday();
     int rc = do_exec(move(description), move(arguments), move(environment), move(interpreter_description));
 
     m_exec_tid = 0;
@@ -1215,6 +1245,10 @@ int Process::exec(String path, Vector<String> arguments, Vector<String> environm
     if (rc < 0)
         return rc;
 
+    timeval exec_time;
+    timeval_sub(kgettimeofday(), exec_start, exec_time);
+    ExecutableCache::the().did_exec((u64)exec_time.tv_sec * 1000000 + exec_time.tv_usec);
+
     if (Process::current == this) {
         Scheduler::yield();
         ASSERT_NOT_REACHED();
@@ -1246,29 +1280,12 @@ int Process::sys$execve(const Syscall::SC_execve_params* user_params)
         path = path_arg.value();
     }
 
-    auto copy_user_strings = [&](const auto& list, auto& output) {
-        if (!list.length)
-            return true;
-        if (!validate_read_typed(list.strings, list.length))
-            return false;
-        Vector<Syscall::StringArgument, 32> strings;
-        strings.resize(list.length);
-        copy_from_user(strings.data(), list.strings, list.length * sizeof(Syscall::StringArgument));
-        for (size_t i = 0; i < list.length; ++i) {
-            auto string = validate_and_copy_string_from_user(strings[i]);
-            if (string.is_null())
-                return false;
-            output.append(move(string));
-        }
-        return true;
-    };
-
     Vector<String> arguments;
-    if (!copy_user_strings(params.arguments, arguments))
+    if (!copy_string_list_from_user(params.arguments, arguments))
         return -EFAULT;
 
     Vector<String> environment;
-    if (!copy_user_strings(params.environment, environment))
+    if (!copy_string_list_from_user(params.environment, environment))
         return -EFAULT;
 
     int rc = exec(move(path), move(arguments), move(environment));
@@ -1276,6 +1293,73 @@ int Process::sys$execve(const Syscall::SC_execve_params* user_params)
     return rc;
 }
 
+pid_t Process::sys$spawn(const Syscall::SC_spawn_params* user_params)
+{
+    REQUIRE_PROMISE(proc);
+    REQUIRE_PROMISE(exec);
+
+    Syscall::SC_spawn_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.arguments.length > ARG_MAX || params.environment.length > ARG_MAX)
+        return -E2BIG;
+
+    String path;
+    {
+        auto path_arg = get_syscall_path_argument(params.path);
+        if (path_arg.is_error())
+            return path_arg.error();
+        path = path_arg.value();
+    }
+
+    Vector<String> arguments;
+    if (!copy_string_list_from_user(params.arguments, arguments))
+        return -EFAULT;
+
+    Vector<String> environment;
+    if (!copy_string_list_from_user(params.environment, environment))
+        return -EFAULT;
+
+    // Catch the common failures while we can still report them to the caller.
+    {
+        auto description_or_error = VFS::the().open(path, O_EXEC, 0, current_directory());
+        if (description_or_error.is_error())
+            return description_or_error.error();
+    }
+
+    // Unlike fork(), the child starts out with an empty address space that exec() fills in,
+    // so nothing from our own address space is ever cloned or copied.
+    Thread* child_first_thread = nullptr;
+    auto* child = new Process(child_first_thread, m_name, m_uid, m_gid, m_pid, m_ring, m_cwd, m_executable, m_tty);
+    inherit_into_child(*child);
+    child->m_euid = m_euid;
+    child->m_egid = m_egid;
+
+    int rc = child->exec(move(path), move(arguments), move(environment));
+
+    // exec() switched to the child's paging scope to set it up.
+    MM.enter_process_paging_scope(*this);
+
+    if (rc < 0) {
+        // Like posix_spawn() implementations that fork first, report a late exec() failure as exit status 127.
+        dbg() << "spawn: exec() failed in child with " << rc;
+        child->m_termination_status = 127;
+        child->m_termination_signal = 0;
+        child_first_thread->set_should_die();
+        child_first_thread->set_state(Thread::State::Dying);
+    }
+
+    {
+        InterruptDisabler disabler;
+        g_processes->prepend(child);
+    }
+#ifdef TASK_DEBUG
+    klog() << "Process " << child->pid() << " (" << child->name().characters() << ") spawned by " << m_pid;
+#endif
+    return child->pid();
+}
+
 Process* Process::create_user_process(Thread*& first_thread, const String& path, uid_t uid, gid_t gid, pid_t parent_pid, int& error, Vector<String>&& arguments, Vector<String>&& environment, TTY* tty)
 {
     auto parts = path.split('/');
@@ -1604,26 +1688,33 @@ int Process::sys$ptsname_r(int fd, char* buffer, ssize_t size)
     return 0;
 }
 
-ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+KResultOr<size_t> Process::copy_iovecs_from_user(Vector<iovec, 32>& vecs, const iovec* user_iov, int iov_count, bool will_write_to_buffers)
 {
-    REQUIRE_PROMISE(stdio);
-    if (iov_count < 0)
-        return -EINVAL;
-
-    if (!validate_read_typed(iov, iov_count))
-        return -EFAULT;
+    if (iov_count < 0 || iov_count > IOV_MAX)
+        return KResult(-EINVAL);
+    if (!validate_read_typed(user_iov, iov_count))
+        return KResult(-EFAULT);
 
     u64 total_length = 0;
-    Vector<iovec, 32> vecs;
     vecs.resize(iov_count);
-    copy_from_user(vecs.data(), iov, iov_count * sizeof(iovec));
+    copy_from_user(vecs.data(), user_iov, iov_count * sizeof(iovec));
     for (auto& vec : vecs) {
-        if (!validate_read(vec.iov_base, vec.iov_len))
-            return -EFAULT;
+        if (will_write_to_buffers ? !validate_write(vec.iov_base, vec.iov_len) : !validate_read(vec.iov_base, vec.iov_len))
+            return KResult(-EFAULT);
         total_length += vec.iov_len;
         if (total_length > INT32_MAX)
-            return -EINVAL;
+            return KResult(-EINVAL);
     }
+    return total_length;
+}
+
+ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    auto total_length_or_error = copy_iovecs_from_user(vecs, iov, iov_count, false);
+    if (total_length_or_error.is_error())
+        return total_length_or_error.error();
 
     auto description = file_description(fd);
     if (!description)
@@ -1632,21 +1723,91 @@ ssize_t Process::sys$writev(int fd, const struct iovec* iov, int iov_count)
     if (!description->is_writable())
         return -EBADF;
 
-    int nwritten = 0;
-    for (auto& vec : vecs) {
-        int rc = do_write(*description, (const u8*)vec.iov_base, vec.iov_len);
-        if (rc < 0) {
-            if (nwritten == 0)
-                return rc;
-            return nwritten;
+    return do_writev(*description, vecs, total_length_or_error.value());
+}
+
+ssize_t Process::sys$readv(int fd, const struct iovec* iov, int iov_count)
+{
+    REQUIRE_PROMISE(stdio);
+    Vector<iovec, 32> vecs;
+    auto total_length_or_error = copy_iovecs_from_user(vecs, iov, iov_count, true);
+    if (total_length_or_error.is_error())
+        return total_length_or_error.error();
+    if (total_length_or_error.value() == 0)
+        return 0;
+
+    auto description = file_description(fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (description->is_directory())
+        return -EISDIR;
+    if (description->is_blocking()) {
+        if (!description->can_read()) {
+            if (Thread::current->block<Thread::ReadBlocker>(*description) != Thread::BlockResult::WokeNormally)
+                return -EINTR;
+            if (!description->can_read())
+                return -EAGAIN;
         }
-        nwritten += rc;
     }
+    return description->readv(vecs.data(), vecs.size());
+}
 
-    return nwritten;
+ssize_t Process::sys$preadv(const Syscall::SC_preadv_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_preadv_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.offset < 0)
+        return -EINVAL;
+
+    Vector<iovec, 32> vecs;
+    auto total_length_or_error = copy_iovecs_from_user(vecs, params.iov, params.iov_count, true);
+    if (total_length_or_error.is_error())
+        return total_length_or_error.error();
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_readable())
+        return -EBADF;
+    if (description->is_directory())
+        return -EISDIR;
+    return description->preadv(params.offset, vecs.data(), vecs.size());
+}
+
+ssize_t Process::sys$pwritev(const Syscall::SC_pwritev_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_pwritev_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.offset < 0)
+        return -EINVAL;
+
+    Vector<iovec, 32> vecs;
+    auto total_length_or_error = copy_iovecs_from_user(vecs, params.iov, params.iov_count, false);
+    if (total_length_or_error.is_error())
+        return total_length_or_error.error();
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+    if (!description->is_writable())
+        return -EBADF;
+    return description->pwritev(params.offset, vecs.data(), vecs.size());
 }
 
 ssize_t Process::do_write(FileDescription& description, const u8* data, int data_size)
+{
+    Vector<iovec, 32> vecs;
+    vecs.append({ const_cast<u8*>(data), (size_t)data_size });
+    return do_writev(description, vecs, data_size);
+}
+
+ssize_t Process::do_writev(FileDescription& description, Vector<iovec, 32>& vecs, size_t total_length)
 {
     ssize_t nwritten = 0;
     if (!description.is_blocking()) {
@@ -1661,9 +1822,12 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
         description.seek(0, SEEK_END);
     }
 
-    while (nwritten < data_size) {
+    // Hand as much of the vector to the file as it will take at once, then skip past
+    // whatever was written and retry with the rest.
+    size_t first_vec = 0;
+    while ((size_t)nwritten < total_length) {
 #ifdef IO_DEBUG
-        dbg() << "while " << nwritten << " < " << size;
+        dbg() << "while " << nwritten << " < " << total_length;
 #endif
         if (!description.can_write()) {
 #ifdef IO_DEBUG
@@ -1674,7 +1838,7 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
                     return -EINTR;
             }
         }
-        ssize_t rc = description.write(data + nwritten, data_size - nwritten);
+        ssize_t rc = description.writev(vecs.data() + first_vec, vecs.size() - first_vec);
 #ifdef IO_DEBUG
         dbg() << "   -> write returned " << rc;
 #endif
@@ -1686,10 +1850,174 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
         if (rc == 0)
             break;
         nwritten += rc;
+        for (size_t remaining = rc; remaining;) {
+            auto& vec = vecs[first_vec];
+            if (remaining < vec.iov_len) {
+                vec.iov_base = (u8*)vec.iov_base + remaining;
+                vec.iov_len -= remaining;
+                break;
+            }
+            remaining -= vec.iov_len;
+            ++first_vec;
+        }
+        while (first_vec < vecs.size() && vecs[first_vec].iov_len == 0)
+            ++first_vec;
     }
     return nwritten;
 }
 
+ssize_t Process::do_transfer(FileDescription& in_description, off_t* in_position, FileDescription& out_description, off_t* out_position, size_t count, bool nonblocking)
+{
+    static const size_t max_chunk_size = 64 * KB;
+    if (count == 0)
+        return 0;
+    if (count > INT32_MAX)
+        count = INT32_MAX;
+
+    // Transfer through a kernel bounce buffer so the data never has to visit userspace.
+    auto buffer = KBuffer::create_with_size(PAGE_ROUND_UP(min(count, max_chunk_size)), Region::Access::Read | Region::Access::Write, "Transfer buffer");
+    ssize_t ntransferred = 0;
+    while ((size_t)ntransferred < count) {
+        size_t chunk_size = min(count - ntransferred, buffer.size());
+
+        ssize_t nread;
+        if (in_position) {
+            nread = in_description.inode()->read_bytes(*in_position, chunk_size, buffer.data(), &in_description);
+        } else {
+            if (!in_description.can_read()) {
+                if (ntransferred)
+                    break;
+                if (nonblocking || !in_description.is_blocking())
+                    return -EAGAIN;
+                if (Thread::current->block<Thread::ReadBlocker>(in_description) != Thread::BlockResult::WokeNormally)
+                    return -EINTR;
+            }
+            nread = in_description.read(buffer.data(), chunk_size);
+        }
+        if (nread < 0)
+            return ntransferred ? ntransferred : nread;
+        if (nread == 0)
+            break;
+
+        ssize_t nwritten;
+        if (out_position) {
+            nwritten = out_description.inode()->write_bytes(*out_position, nread, buffer.data(), &out_description);
+        } else {
+            if (nonblocking && !out_description.can_write()) {
+                nwritten = -EAGAIN;
+            } else {
+                nwritten = do_write(out_description, buffer.data(), nread);
+            }
+        }
+        if (nwritten < 0)
+            return ntransferred ? ntransferred : nwritten;
+
+        if (in_position)
+            *in_position += nwritten;
+        if (out_position)
+            *out_position += nwritten;
+        ntransferred += nwritten;
+        if (nwritten < nread)
+            break;
+    }
+    return ntransferred;
+}
+
+ssize_t Process::sys$sendfile(const Syscall::SC_sendfile_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto in_description = file_description(params.in_fd);
+    auto out_description = file_description(params.out_fd);
+    if (!in_description || !out_description)
+        return -EBADF;
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return -EBADF;
+    if (!in_description->inode() || in_description->is_directory())
+        return -EINVAL;
+
+    off_t position;
+    if (params.offset) {
+        if (!validate_read_and_copy_typed(&position, params.offset))
+            return -EFAULT;
+        if (position < 0)
+            return -EINVAL;
+    } else {
+        position = in_description->offset();
+    }
+
+    ssize_t rc = do_transfer(*in_description, &position, *out_description, nullptr, params.count, false);
+    if (rc < 0)
+        return rc;
+
+    if (params.offset) {
+        if (!validate_write_typed(params.offset))
+            return -EFAULT;
+        copy_to_user(params.offset, &position);
+    } else {
+        in_description->seek(position, SEEK_SET);
+    }
+    return rc;
+}
+
+ssize_t Process::sys$splice(const Syscall::SC_splice_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_splice_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto in_description = file_description(params.in_fd);
+    auto out_description = file_description(params.out_fd);
+    if (!in_description || !out_description)
+        return -EBADF;
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return -EBADF;
+    if (!in_description->is_fifo() && !out_description->is_fifo())
+        return -EINVAL;
+    if (in_description->is_directory() || out_description->is_directory())
+        return -EINVAL;
+
+    auto copy_position = [&](off_t* user_position, FileDescription& description, off_t& position) -> int {
+        if (!user_position)
+            return 0;
+        if (description.is_fifo() || !description.inode())
+            return -ESPIPE;
+        if (!validate_read_and_copy_typed(&position, user_position))
+            return -EFAULT;
+        if (position < 0)
+            return -EINVAL;
+        return 0;
+    };
+
+    off_t in_position = 0;
+    off_t out_position = 0;
+    if (int rc = copy_position(params.in_offset, *in_description, in_position))
+        return rc;
+    if (int rc = copy_position(params.out_offset, *out_description, out_position))
+        return rc;
+
+    bool nonblocking = params.flags & SPLICE_F_NONBLOCK;
+    ssize_t rc = do_transfer(*in_description, params.in_offset ? &in_position : nullptr, *out_description, params.out_offset ? &out_position : nullptr, params.count, nonblocking);
+    if (rc < 0)
+        return rc;
+
+    if (params.in_offset) {
+        if (!validate_write_typed(params.in_offset))
+            return -EFAULT;
+        copy_to_user(params.in_offset, &in_position);
+    }
+    if (params.out_offset) {
+        if (!validate_write_typed(params.out_offset))
+            return -EFAULT;
+        copy_to_user(params.out_offset, &out_position);
+    }
+    return rc;
+}
+
 ssize_t Process::sys$write(int fd, const u8* data, ssize_t size)
 {
     REQUIRE_PROMISE(stdio);
@@ -1814,6 +2142,20 @@ int Process::sys$fcntl(int fd, int cmd, u32 arg)
     case F_SETFL:
         description->set_file_flags(arg);
         break;
+    case F_GETPIPE_SZ:
+        if (!description->is_fifo())
+            return -EBADF;
+        return description->fifo()->buffer_capacity();
+    case F_SETPIPE_SZ: {
+        if (!description->is_fifo())
+            return -EBADF;
+        if (arg > PIPE_MAX_SIZE && !is_superuser())
+            return -EPERM;
+        auto result = description->fifo()->set_buffer_capacity(arg);
+        if (result.is_error())
+            return result;
+        return description->fifo()->buffer_capacity();
+    }
     default:
         ASSERT_NOT_REACHED();
     }
@@ -2922,6 +3264,97 @@ int Process::sys$poll(pollfd* fds, int nfds, int timeout)
     return fds_with_revents;
 }
 
+int Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    if ((flags & EPOLL_CLOEXEC) != flags)
+        return -EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    m_fds[fd].set(FileDescription::create(EPoll::create()), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[fd].description->set_readable(true);
+    return fd;
+}
+
+int Process::sys$epoll_ctl(const Syscall::SC_epoll_ctl_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_ctl_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    auto& epoll = static_cast<EPoll&>(epoll_description->file());
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL) {
+        if (!validate_read_and_copy_typed(&event, params.event))
+            return -EFAULT;
+    }
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return epoll.add(params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll.modify(params.fd, *description, event);
+    case EPOLL_CTL_DEL:
+        return epoll.remove(params.fd, *description);
+    default:
+        return -EINVAL;
+    }
+}
+
+int Process::sys$epoll_wait(const Syscall::SC_epoll_wait_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_wait_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.max_events <= 0)
+        return -EINVAL;
+    // There can't be more events than file descriptors, and capping it here keeps the size below from overflowing.
+    params.max_events = min(params.max_events, max_open_file_descriptors());
+    if (!validate_write(params.events, params.max_events * sizeof(epoll_event)))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    NonnullRefPtr<EPoll> epoll = static_cast<EPoll&>(epoll_description->file());
+
+    if (params.timeout != 0 && !epoll->has_pending_events()) {
+        timeval deadline;
+        bool has_timeout = params.timeout > 0;
+        if (has_timeout) {
+            timeval relative_timeout { params.timeout / 1000, (params.timeout % 1000) * 1000 };
+            timeval_add(Scheduler::time_since_boot(), relative_timeout, deadline);
+        }
+        if (Thread::current->block<Thread::EPollBlocker>(*epoll, deadline, has_timeout) != Thread::BlockResult::WokeNormally)
+            return -EINTR;
+        // The process lock was dropped while we were blocked, so re-validate the output buffer.
+        if (!validate_write(params.events, params.max_events * sizeof(epoll_event)))
+            return -EFAULT;
+    }
+
+    Vector<epoll_event> events;
+    epoll->collect_pending_events(events, params.max_events);
+    copy_to_user(params.events, events.data(), events.size() * sizeof(epoll_event));
+    return events.size();
+}
+
 Custody& Process::current_directory()
 {
     if (!m_cwd)
@@ -3043,8 +3476,8 @@ void Process::finalize()
         auto description_or_error = VFS::the().open(String::format("perfcore.%d", m_pid), O_CREAT | O_EXCL, 0400, current_directory(), UidAndGid { m_uid, m_gid });
         if (!description_or_error.is_error()) {
             auto& description = description_or_error.value();
-            auto json = m_perf_event_buffer->to_json(m_pid, m_executable ? m_executable->absolute_path() : "");
-            description->write(json.data(), json.size());
+            auto data = m_perf_event_buffer->to_binary(m_pid, m_name, m_executable ? m_executable->absolute_path() : "");
+            description->write(data.data(), data.size());
         }
     }
 
@@ -4094,6 +4527,27 @@ int Process::sys$umount(const char* user_mountpoint, size_t mountpoint_length)
     return VFS::the().unmount(guest_inode_id);
 }
 
+int Process::sys$swapon(const char* user_path, size_t path_length)
+{
+    if (!is_superuser())
+        return -EPERM;
+
+    REQUIRE_NO_PROMISES;
+
+    if (!validate_read(user_path, path_length))
+        return -EFAULT;
+
+    auto path = get_syscall_path_argument(user_path, path_length);
+    if (path.is_error())
+        return path.error();
+
+    auto description_or_error = VFS::the().open(path.value(), O_RDWR, 0, current_directory());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    return SwapManager::the().swapon(description_or_error.value());
+}
+
 void Process::FileDescriptionAndFlags::clear()
 {
     description = nullptr;
@@ -4819,6 +5273,19 @@ int Process::sys$perf_event(int type, FlatPtr arg1, FlatPtr arg2)
 {
     if (!m_perf_event_buffer)
         m_perf_event_buffer = make<PerformanceEventBuffer>();
+
+    if (type == PERF_EVENT_TRACEPOINT_NAME) {
+        Syscall::StringArgument user_name;
+        if (!validate_read_and_copy_typed(&user_name, reinterpret_cast<const Syscall::StringArgument*>(arg2)))
+            return -EFAULT;
+        if (user_name.length > 255)
+            return -ENAMETOOLONG;
+        auto name = validate_and_copy_string_from_user(user_name);
+        if (name.is_null())
+            return -EFAULT;
+        return m_perf_event_buffer->append_tracepoint_name(arg1, name);
+    }
+
     return m_perf_event_buffer->append(type, arg1, arg2);
 }
 
@@ -190,6 +190,9 @@ public:
     ssize_t sys$read(int fd, u8*, ssize_t);
     ssize_t sys$write(int fd, const u8*, ssize_t);
     ssize_t sys$writev(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$readv(int fd, const struct iovec* iov, int iov_count);
+    ssize_t sys$preadv(const Syscall::SC_preadv_params*);
+    ssize_t sys$pwritev(const Syscall::SC_pwritev_params*);
     int sys$fstat(int fd, stat*);
     int sys$stat(const Syscall::SC_stat_params*);
     int sys$lseek(int fd, off_t, int whence);
@@ -205,6 +208,11 @@ public:
     int sys$purge(int mode);
     int sys$select(const Syscall::SC_select_params*);
     int sys$poll(pollfd*, int nfds, int timeout);
+    int sys$epoll_create(int flags);
+    int sys$epoll_ctl(const Syscall::SC_epoll_ctl_params*);
+    int sys$epoll_wait(const Syscall::SC_epoll_wait_params*);
+    ssize_t sys$sendfile(const Syscall::SC_sendfile_params*);
+    ssize_t sys$splice(const Syscall::SC_splice_params*);
     ssize_t sys$get_dir_entries(int fd, void*, ssize_t);
     int sys$getcwd(char*, ssize_t);
     int sys$chdir(const char*, size_t);
@@ -221,6 +229,7 @@ public:
     int sys$ttyname_r(int fd, char*, ssize_t);
     int sys$ptsname_r(int fd, char*, ssize_t);
     pid_t sys$fork(RegisterState&);
+    pid_t sys$spawn(const Syscall::SC_spawn_params*);
     int sys$execve(const Syscall::SC_execve_params*);
     int sys$getdtablesize();
     int sys$dup(int oldfd);
@@ -247,6 +256,7 @@ public:
     int sys$rmdir(const char* pathname, size_t path_length);
     int sys$mount(const Syscall::SC_mount_params*);
     int sys$umount(const char* mountpoint, size_t mountpoint_length);
+    int sys$swapon(const char* path, size_t path_length);
     int sys$chmod(const char* pathname, size_t path_length, mode_t);
     int sys$fchmod(int fd, mode_t);
     int sys$chown(const Syscall::SC_chown_params*);
@@ -361,10 +371,17 @@ public:
     size_t amount_purgeable_volatile() const;
     size_t amount_purgeable_nonvolatile() const;
 
+    // Minor faults were resolved without I/O, major faults had to read from an inode.
+    unsigned minor_faults() const { return m_minor_faults; }
+    unsigned major_faults() const { return m_major_faults; }
+    void did_minor_fault() { ++m_minor_faults; }
+    void did_major_fault() { ++m_major_faults; }
+
     int exec(String path, Vector<String> arguments, Vector<String> environment, int recusion_depth = 0);
 
     bool is_superuser() const { return m_euid == 0; }
 
+    Range allocate_range(VirtualAddress, size_t, size_t alignment = PAGE_SIZE);
     Region* allocate_region_with_vmobject(VirtualAddress, size_t, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, const String& name, int prot);
     Region* allocate_region(VirtualAddress, size_t, const String& name, int prot = PROT_READ | PROT_WRITE, bool commit = true);
     Region* allocate_region_with_vmobject(const Range&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, const String& name, int prot);
@@ -416,15 +433,18 @@ private:
     Process(Thread*& first_thread, const String& name, uid_t, gid_t, pid_t ppid, RingLevel, RefPtr<Custody> cwd = nullptr, RefPtr<Custody> executable = nullptr, TTY* = nullptr, Process* fork_parent = nullptr);
     static pid_t allocate_pid();
 
-    Range allocate_range(VirtualAddress, size_t, size_t alignment = PAGE_SIZE);
-
     Region& add_region(NonnullOwnPtr<Region>);
 
     void kill_threads_except_self();
+    void inherit_into_child(Process&) const;
+    bool copy_string_list_from_user(const Syscall::StringListArgument&, Vector<String>& output);
     void kill_all_threads();
 
     int do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description);
     ssize_t do_write(FileDescription&, const u8*, int data_size);
+    ssize_t do_writev(FileDescription&, Vector<iovec, 32>&, size_t total_length);
+    KResultOr<size_t> copy_iovecs_from_user(Vector<iovec, 32>&, const iovec* user_iov, int iov_count, bool will_write_to_buffers);
+    ssize_t do_transfer(FileDescription& in_description, off_t* in_position, FileDescription& out_description, off_t* out_position, size_t count, bool nonblocking);
 
     KResultOr<NonnullRefPtr<FileDescription>> find_elf_interpreter_for_executable(const String& path, char (&first_page)[PAGE_SIZE], int nread, size_t file_size);
 
@@ -509,6 +529,9 @@ private:
 
     int m_icon_id { -1 };
 
+    unsigned m_minor_faults { 0 };
+    unsigned m_major_faults { 0 };
+
     u32 m_priority_boost { 0 };
 
     u32 m_promises { 0 };
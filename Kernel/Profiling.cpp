@@ -31,6 +31,11 @@
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
 #include <Kernel/Profiling.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <LibC/sys/profile.h>
 #include <LibELF/ELFLoader.h>
 
 namespace Kernel {
@@ -103,6 +108,263 @@ void for_each_sample(Function<void(Sample&)> callback)
     }
 }
 
+// The stream is a ring of variable-sized records, written from the timer interrupt
+// and drained by whoever has /dev/profile open. There's only one CPU to sample,
+// so there's only one ring. The positions only ever increase; since the capacity
+// is a power of two, the difference is always the number of buffered bytes.
+static constexpr size_t stream_capacity = 1 * MB;
+static constexpr size_t max_stream_frame_count = 64;
+static constexpr size_t max_scanned_stack_words = 1024;
+
+static KBufferImpl* s_stream_buffer;
+static size_t s_stream_read_position;
+static size_t s_stream_write_position;
+static bool s_streaming;
+static unsigned s_stream_interval_ticks;
+static unsigned s_ticks_until_stream_sample;
+static u32 s_stream_flags;
+static u32 s_lost_samples;
+
+static size_t stream_space()
+{
+    return stream_capacity - (s_stream_write_position - s_stream_read_position);
+}
+
+static void stream_write(const void* data, size_t size)
+{
+    size_t offset = s_stream_write_position & (stream_capacity - 1);
+    size_t bytes_before_wrap = min(size, stream_capacity - offset);
+    memcpy(s_stream_buffer->data() + offset, data, bytes_before_wrap);
+    memcpy(s_stream_buffer->data(), (const u8*)data + bytes_before_wrap, size - bytes_before_wrap);
+    s_stream_write_position += size;
+}
+
+static void stream_peek(size_t position, void* data, size_t size)
+{
+    size_t offset = position & (stream_capacity - 1);
+    size_t bytes_before_wrap = min(size, stream_capacity - offset);
+    memcpy(data, s_stream_buffer->data() + offset, bytes_before_wrap);
+    memcpy((u8*)data + bytes_before_wrap, s_stream_buffer->data(), size - bytes_before_wrap);
+}
+
+static bool emit_record(profile_record_header& header, size_t record_size, const void* payload, size_t payload_size)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    static const u8 padding[sizeof(u32)] {};
+    size_t size = align_up_to(record_size + payload_size, sizeof(u32));
+    if (size > 0xffff || stream_space() < size)
+        return false;
+    header.size = size;
+    stream_write(&header, record_size);
+    stream_write(payload, payload_size);
+    stream_write(padding, size - record_size - payload_size);
+    return true;
+}
+
+static void emit_process_record(Process& process)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    String executable_path;
+    if (process.executable())
+        executable_path = process.executable()->absolute_path();
+
+    StringBuilder builder;
+    builder.append(process.name());
+    builder.append(executable_path);
+    auto strings = builder.build();
+
+    profile_process record;
+    record.header.type = PROFILE_RECORD_PROCESS;
+    record.pid = process.pid();
+    record.name_length = process.name().length();
+    record.executable_length = executable_path.length();
+    emit_record(record.header, sizeof(record), strings.characters(), strings.length());
+}
+
+bool is_streaming()
+{
+    return s_streaming;
+}
+
+void start_streaming()
+{
+    InterruptDisabler disabler;
+    ASSERT(!s_streaming);
+    if (!s_stream_buffer) {
+        s_stream_buffer = RefPtr<KBufferImpl>(KBuffer::create_with_size(stream_capacity, Region::Access::Read | Region::Access::Write, "Profile stream").impl()).leak_ref();
+        s_stream_buffer->region().commit();
+    }
+    s_stream_read_position = 0;
+    s_stream_write_position = 0;
+    s_stream_interval_ticks = 1;
+    s_ticks_until_stream_sample = 1;
+    s_stream_flags = 0;
+    s_lost_samples = 0;
+
+    // Let the reader know who's who before the first sample comes in.
+    emit_process_record(*Scheduler::colonel());
+    for (auto* process : Process::all_processes())
+        emit_process_record(*process);
+
+    s_streaming = true;
+}
+
+void stop_streaming()
+{
+    InterruptDisabler disabler;
+    s_streaming = false;
+}
+
+void set_stream_frequency(unsigned hz)
+{
+    ASSERT(hz);
+    InterruptDisabler disabler;
+    s_stream_interval_ticks = max((unsigned)TimeManagement::the().ticks_per_second() / hz, 1u);
+    s_ticks_until_stream_sample = min(s_ticks_until_stream_sample, s_stream_interval_ticks);
+}
+
+void set_stream_flags(u32 flags)
+{
+    InterruptDisabler disabler;
+    s_stream_flags = flags;
+}
+
+void did_exec_for_stream(Process& process)
+{
+    InterruptDisabler disabler;
+    if (s_streaming)
+        emit_process_record(process);
+}
+
+static size_t walk_stack(Process& process, FlatPtr ebp, FlatPtr* frames, size_t capacity)
+{
+    size_t count = 0;
+    for (FlatPtr* stack_ptr = (FlatPtr*)ebp; count < capacity && process.validate_read_from_kernel(VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2) && MM.can_read_without_faulting(process, VirtualAddress(stack_ptr), sizeof(FlatPtr) * 2); stack_ptr = (FlatPtr*)*stack_ptr) {
+        FlatPtr retaddr = stack_ptr[1];
+        if (!retaddr)
+            break;
+        frames[count++] = retaddr;
+    }
+    return count;
+}
+
+static bool is_user_code_address(Process& process, FlatPtr address)
+{
+    if (!is_user_address(VirtualAddress(address)))
+        return false;
+    auto* region = MM.region_from_vaddr(process, VirtualAddress(address));
+    return region && region->is_executable();
+}
+
+// For code built without frame pointers: treat anything on the stack that points
+// into executable memory as a return address. This finds stale frames too, but
+// it's a lot better than nothing.
+static size_t scan_user_stack(Process& process, FlatPtr esp, FlatPtr* frames, size_t capacity)
+{
+    auto* stack_region = MM.region_from_vaddr(process, VirtualAddress(esp));
+    if (!stack_region)
+        return 0;
+    FlatPtr stack_end = stack_region->vaddr().offset(stack_region->size()).get();
+
+    size_t count = 0;
+    esp &= ~(sizeof(FlatPtr) - 1);
+    for (size_t i = 0; i < max_scanned_stack_words && count < capacity; ++i) {
+        FlatPtr address = esp + i * sizeof(FlatPtr);
+        if (address >= stack_end)
+            break;
+        if ((i == 0 || !(address & ~PAGE_MASK)) && !MM.can_read_without_faulting(process, VirtualAddress(address), sizeof(FlatPtr)))
+            break;
+        FlatPtr value = *(FlatPtr*)address;
+        if (is_user_code_address(process, value))
+            frames[count++] = value;
+    }
+    return count;
+}
+
+void sample_for_stream(const RegisterState& regs)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (!s_streaming || !Thread::current)
+        return;
+    if (--s_ticks_until_stream_sample)
+        return;
+    s_ticks_until_stream_sample = s_stream_interval_ticks;
+
+    if (s_lost_samples) {
+        profile_lost lost;
+        lost.header.type = PROFILE_RECORD_LOST;
+        lost.count = s_lost_samples;
+        if (!emit_record(lost.header, sizeof(lost), nullptr, 0)) {
+            ++s_lost_samples;
+            return;
+        }
+        s_lost_samples = 0;
+    }
+
+    SmapDisabler disabler;
+    auto& process = Thread::current->process();
+    bool in_kernel = (regs.cs & 3) == 0;
+
+    FlatPtr frames[max_stream_frame_count];
+    size_t frame_count = 0;
+    u32 flags = in_kernel ? PROFILE_SAMPLE_IN_KERNEL : 0;
+    frames[frame_count++] = regs.eip;
+    frame_count += walk_stack(process, regs.ebp, frames + 1, max_stream_frame_count - 1);
+
+    if (!in_kernel && (s_stream_flags & PROFILE_FLAG_SCAN_STACKS)) {
+        // If the frame pointer chain led anywhere but into code, ebp wasn't a frame pointer.
+        bool frames_look_valid = frame_count > 1;
+        for (size_t i = 1; i < frame_count && frames_look_valid; ++i)
+            frames_look_valid = is_user_code_address(process, frames[i]);
+        if (!frames_look_valid) {
+            frame_count = 1 + scan_user_stack(process, regs.userspace_esp, frames + 1, max_stream_frame_count - 1);
+            flags |= PROFILE_SAMPLE_SCANNED;
+        }
+    }
+
+    profile_sample sample;
+    sample.header.type = PROFILE_RECORD_SAMPLE;
+    sample.pid = process.pid();
+    sample.tid = Thread::current->tid();
+    sample.timestamp = g_uptime;
+    sample.flags = flags;
+    sample.frame_count = frame_count;
+    if (!emit_record(sample.header, sizeof(sample), frames, frame_count * sizeof(FlatPtr)))
+        ++s_lost_samples;
+}
+
+bool stream_has_records()
+{
+    return s_stream_read_position != s_stream_write_position;
+}
+
+ssize_t read_stream(u8* buffer, size_t size)
+{
+    // Only hand out whole records. The writer never touches the bytes between the
+    // read and write positions, so they can be copied out with interrupts enabled.
+    size_t read_position;
+    size_t nread = 0;
+    {
+        InterruptDisabler disabler;
+        read_position = s_stream_read_position;
+        while (read_position + nread != s_stream_write_position) {
+            profile_record_header header;
+            stream_peek(read_position + nread, &header, sizeof(header));
+            if (nread + header.size > size)
+                break;
+            nread += header.size;
+        }
+    }
+    if (!nread)
+        return stream_has_records() ? -EINVAL : 0;
+
+    stream_peek(read_position, buffer, nread);
+
+    InterruptDisabler disabler;
+    s_stream_read_position += nread;
+    return nread;
+}
+
 }
 
 }
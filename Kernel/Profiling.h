@@ -33,6 +33,7 @@
 namespace Kernel {
 
 class Process;
+struct RegisterState;
 
 namespace Profiling {
 
@@ -54,6 +55,18 @@ void stop();
 void did_exec(const String& new_executable_path);
 void for_each_sample(Function<void(Sample&)>);
 
+// System-wide sampling, streamed to userspace through /dev/profile.
+// See <LibC/sys/profile.h> for the record format.
+bool is_streaming();
+void start_streaming();
+void stop_streaming();
+void set_stream_frequency(unsigned hz);
+void set_stream_flags(u32);
+void sample_for_stream(const RegisterState&);
+void did_exec_for_stream(Process&);
+bool stream_has_records();
+ssize_t read_stream(u8* buffer, size_t size);
+
 }
 
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StdLibExtras.h>
+#include <Kernel/RingBuffer.h>
+
+namespace Kernel {
+
+static size_t round_up_to_power_of_two(size_t value)
+{
+    size_t result = PAGE_SIZE;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+RingBuffer::RingBuffer(size_t capacity)
+    : m_storage(KBuffer::create_with_size(round_up_to_power_of_two(capacity), Region::Access::Read | Region::Access::Write, "RingBuffer"))
+    , m_capacity(round_up_to_power_of_two(capacity))
+{
+}
+
+ssize_t RingBuffer::write(const u8* data, ssize_t size)
+{
+    if (!size)
+        return 0;
+    ASSERT(size > 0);
+    LOCKER(m_write_lock);
+    size_t write_position = m_write_position.load(AK::memory_order_relaxed);
+    size_t space = m_capacity - (write_position - m_read_position.load(AK::memory_order_acquire));
+    size_t bytes_to_write = min(static_cast<size_t>(size), space);
+    size_t offset = write_position & (m_capacity - 1);
+    size_t bytes_before_wrap = min(bytes_to_write, m_capacity - offset);
+    memcpy(m_storage.data() + offset, data, bytes_before_wrap);
+    memcpy(m_storage.data(), data + bytes_before_wrap, bytes_to_write - bytes_before_wrap);
+    m_write_position.store(write_position + bytes_to_write, AK::memory_order_release);
+    return bytes_to_write;
+}
+
+ssize_t RingBuffer::read(u8* data, ssize_t size)
+{
+    if (!size)
+        return 0;
+    ASSERT(size > 0);
+    LOCKER(m_read_lock);
+    size_t read_position = m_read_position.load(AK::memory_order_relaxed);
+    size_t available = m_write_position.load(AK::memory_order_acquire) - read_position;
+    size_t nread = min(static_cast<size_t>(size), available);
+    size_t offset = read_position & (m_capacity - 1);
+    size_t bytes_before_wrap = min(nread, m_capacity - offset);
+    memcpy(data, m_storage.data() + offset, bytes_before_wrap);
+    memcpy(data + bytes_before_wrap, m_storage.data(), nread - bytes_before_wrap);
+    m_read_position.store(read_position + nread, AK::memory_order_release);
+    return nread;
+}
+
+KResult RingBuffer::set_capacity(size_t capacity)
+{
+    if (capacity > max_capacity)
+        return KResult(-EINVAL);
+    capacity = round_up_to_power_of_two(capacity);
+    Locker write_locker(m_write_lock);
+    Locker read_locker(m_read_lock);
+    if (capacity == m_capacity)
+        return KSuccess;
+    size_t used = used_bytes();
+    if (used > capacity)
+        return KResult(-EBUSY);
+
+    auto new_storage = KBuffer::create_with_size(capacity, Region::Access::Read | Region::Access::Write, "RingBuffer");
+    size_t read_position = m_read_position.load(AK::memory_order_relaxed);
+    size_t offset = read_position & (m_capacity - 1);
+    size_t bytes_before_wrap = min(used, m_capacity - offset);
+    memcpy(new_storage.data(), m_storage.data() + offset, bytes_before_wrap);
+    memcpy(new_storage.data() + bytes_before_wrap, m_storage.data(), used - bytes_before_wrap);
+
+    m_storage = move(new_storage);
+    m_capacity = capacity;
+    m_read_position.store(0, AK::memory_order_release);
+    m_write_position.store(used, AK::memory_order_release);
+    return KSuccess;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Types.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Lock.h>
+
+namespace Kernel {
+
+// A byte ring buffer for one producer and one consumer at a time.
+// Writers serialize against each other, and readers against each other, but
+// a reader never has to wait for a writer (or vice versa.)
+class RingBuffer {
+public:
+    static constexpr size_t default_capacity = 65536;
+    static constexpr size_t max_capacity = 64 * MB;
+
+    explicit RingBuffer(size_t capacity = default_capacity);
+
+    ssize_t write(const u8*, ssize_t);
+    ssize_t read(u8*, ssize_t);
+
+    bool is_empty() const { return used_bytes() == 0; }
+    size_t space_for_writing() const { return m_capacity - used_bytes(); }
+    size_t capacity() const { return m_capacity; }
+
+    // The capacity is rounded up to a power of two. Fails with EBUSY if the
+    // currently buffered data wouldn't fit in the new capacity.
+    KResult set_capacity(size_t);
+
+private:
+    size_t used_bytes() const { return m_write_position.load(AK::memory_order_acquire) - m_read_position.load(AK::memory_order_acquire); }
+
+    KBuffer m_storage;
+    size_t m_capacity { 0 };
+
+    // These only ever increase (and wrap around.) Since the capacity is a power of two,
+    // the difference is always the number of buffered bytes.
+    Atomic<size_t> m_read_position { 0 };
+    Atomic<size_t> m_write_position { 0 };
+
+    Lock m_write_lock { "RingBuffer:Write" };
+    Lock m_read_lock { "RingBuffer:Read" };
+};
+
+}
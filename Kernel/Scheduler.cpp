@@ -26,6 +26,7 @@
 
 #include <AK/QuickSort.h>
 #include <AK/TemporaryChange.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/Socket.h>
 #include <Kernel/Process.h>
@@ -242,6 +243,22 @@ bool Thread::SelectBlocker::should_unblock(Thread& thread, time_t now_sec, long
     return false;
 }
 
+Thread::EPollBlocker::EPollBlocker(EPoll& epoll, const timeval& deadline, bool has_timeout)
+    : m_epoll(epoll)
+    , m_deadline(deadline)
+    , m_has_timeout(has_timeout)
+{
+}
+
+bool Thread::EPollBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
+{
+    if (m_has_timeout) {
+        if (now_sec > m_deadline.tv_sec || (now_sec == m_deadline.tv_sec && now_usec >= m_deadline.tv_usec))
+            return true;
+    }
+    return m_epoll->has_pending_events();
+}
+
 Thread::WaitBlocker::WaitBlocker(int wait_options, pid_t& waitee_pid)
     : m_wait_options(wait_options)
     , m_waitee_pid(waitee_pid)
@@ -613,6 +630,9 @@ void Scheduler::timer_tick(const RegisterState& regs)
         }
     }
 
+    if (Profiling::is_streaming())
+        Profiling::sample_for_stream(regs);
+
     TimerQueue::the().fire();
 
     if (Thread::current->tick())
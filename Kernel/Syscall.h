@@ -35,6 +35,8 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
+struct iovec;
 struct timeval;
 struct timespec;
 struct sockaddr;
@@ -182,7 +184,17 @@ namespace Kernel {
     __ENUMERATE_SYSCALL(perf_event)           \
     __ENUMERATE_SYSCALL(shutdown)             \
     __ENUMERATE_SYSCALL(get_stack_bounds)     \
-    __ENUMERATE_SYSCALL(ptrace)
+    __ENUMERATE_SYSCALL(ptrace)               \
+    __ENUMERATE_SYSCALL(epoll_create)         \
+    __ENUMERATE_SYSCALL(epoll_ctl)            \
+    __ENUMERATE_SYSCALL(epoll_wait)           \
+    __ENUMERATE_SYSCALL(sendfile)             \
+    __ENUMERATE_SYSCALL(splice)               \
+    __ENUMERATE_SYSCALL(readv)                \
+    __ENUMERATE_SYSCALL(preadv)               \
+    __ENUMERATE_SYSCALL(pwritev)              \
+    __ENUMERATE_SYSCALL(spawn)                \
+    __ENUMERATE_SYSCALL(swapon)
 
 namespace Syscall {
 
@@ -266,6 +278,50 @@ struct SC_select_params {
     struct timeval* timeout;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    int timeout;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    i32* offset; // off_t
+    size_t count;
+};
+
+struct SC_splice_params {
+    int in_fd;
+    i32* in_offset; // off_t
+    int out_fd;
+    i32* out_offset; // off_t
+    size_t count;
+    unsigned flags;
+};
+
+struct SC_preadv_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    i32 offset; // off_t
+};
+
+struct SC_pwritev_params {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    i32 offset; // off_t
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
@@ -362,6 +418,12 @@ struct SC_execve_params {
     StringListArgument environment;
 };
 
+struct SC_spawn_params {
+    StringArgument path;
+    StringListArgument arguments;
+    StringListArgument environment;
+};
+
 struct SC_readlink_params {
     StringArgument path;
     MutableBufferArgument<char, size_t> buffer;
@@ -63,7 +63,10 @@ ssize_t MasterPTY::read(FileDescription&, u8* buffer, ssize_t size)
 {
     if (!m_slave && m_buffer.is_empty())
         return 0;
-    return m_buffer.read(buffer, size);
+    ssize_t nread = m_buffer.read(buffer, size);
+    if (nread > 0 && m_slave)
+        m_slave->notify_readiness_observers();
+    return nread;
 }
 
 ssize_t MasterPTY::write(FileDescription&, const u8* buffer, ssize_t size)
@@ -93,8 +96,10 @@ void MasterPTY::notify_slave_closed(Badge<SlavePTY>)
 #endif
     // +1 ref for my MasterPTY::m_slave
     // +1 ref for FileDescription::m_device
-    if (m_slave->ref_count() == 2)
+    if (m_slave->ref_count() == 2) {
         m_slave = nullptr;
+        notify_readiness_observers();
+    }
 }
 
 ssize_t MasterPTY::on_slave_write(const u8* data, ssize_t size)
@@ -102,6 +107,7 @@ ssize_t MasterPTY::on_slave_write(const u8* data, ssize_t size)
     if (m_closed)
         return -EIO;
     m_buffer.write(data, size);
+    notify_readiness_observers();
     return size;
 }
 
@@ -28,7 +28,7 @@
 
 #include <AK/Badge.h>
 #include <Kernel/Devices/CharacterDevice.h>
-#include <Kernel/DoubleBuffer.h>
+#include <Kernel/RingBuffer.h>
 
 namespace Kernel {
 
@@ -54,15 +54,17 @@ private:
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
     virtual bool can_read(const FileDescription&) const override;
     virtual bool can_write(const FileDescription&) const override;
+    virtual bool is_hung_up(const FileDescription&) const override { return !m_slave; }
     virtual void close() override;
     virtual bool is_master_pty() const override { return true; }
+    virtual bool has_readiness_notifications() const override { return true; }
     virtual int ioctl(FileDescription&, unsigned request, unsigned arg) override;
     virtual const char* class_name() const override { return "MasterPTY"; }
 
     RefPtr<SlavePTY> m_slave;
     unsigned m_index;
     bool m_closed { false };
-    DoubleBuffer m_buffer;
+    RingBuffer m_buffer;
     String m_pts_name;
 };
 
@@ -88,6 +88,11 @@ bool SlavePTY::can_read(const FileDescription& description) const
     return TTY::can_read(description);
 }
 
+bool SlavePTY::is_hung_up(const FileDescription&) const
+{
+    return m_master->is_closed();
+}
+
 ssize_t SlavePTY::read(FileDescription& description, u8* buffer, ssize_t size)
 {
     if (m_master->is_closed())
@@ -50,6 +50,7 @@ private:
     virtual bool can_read(const FileDescription&) const override;
     virtual ssize_t read(FileDescription&, u8*, ssize_t) override;
     virtual bool can_write(const FileDescription&) const override;
+    virtual bool is_hung_up(const FileDescription&) const override;
     virtual const char* class_name() const override { return "SlavePTY"; }
     virtual void close() override;
 
@@ -162,6 +162,7 @@ void TTY::emit(u8 ch)
             //We use '\0' to delimit the end
             //of a line.
             m_input_buffer.enqueue('\0');
+            notify_readiness_observers();
             return;
         }
         if (is_kill(ch)) {
@@ -182,6 +183,7 @@ void TTY::emit(u8 ch)
     }
     m_input_buffer.enqueue(ch);
     echo(ch);
+    notify_readiness_observers();
 }
 
 bool TTY::can_do_backspace() const
@@ -364,6 +366,7 @@ void TTY::set_size(unsigned short columns, unsigned short rows)
 void TTY::hang_up()
 {
     generate_signal(SIGHUP);
+    notify_readiness_observers();
 }
 
 }
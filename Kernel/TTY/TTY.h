@@ -28,7 +28,7 @@
 
 #include <AK/CircularDeque.h>
 #include <Kernel/Devices/CharacterDevice.h>
-#include <Kernel/DoubleBuffer.h>
+#include <Kernel/RingBuffer.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel {
@@ -91,6 +91,7 @@ protected:
 private:
     // ^CharacterDevice
     virtual bool is_tty() const final override { return true; }
+    virtual bool has_readiness_notifications() const final override { return true; }
 
     CircularDeque<u8, 1024> m_input_buffer;
     pid_t m_pgid { 0 };
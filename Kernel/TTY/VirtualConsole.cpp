@@ -25,10 +25,13 @@
  */
 
 #include "VirtualConsole.h"
+#include <AK/Atomic.h>
 #include <AK/String.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Devices/KeyboardDevice.h>
 #include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Thread.h>
+#include <Kernel/WaitQueue.h>
 #include <LibBareMetal/IO.h>
 #include <LibBareMetal/StdLib.h>
 
@@ -38,6 +41,34 @@ static u8* s_vga_buffer;
 static VirtualConsole* s_consoles[6];
 static int s_active_console;
 
+// The VGA text buffer has room for ~200 rows, so we can scroll by moving the start
+// address for quite a while before having to copy the screen back to the top.
+static const u16 max_vga_start_row = 160;
+
+static Thread* s_flush_thread;
+static WaitQueue* s_flush_wait_queue;
+static Atomic<bool> s_flush_requested;
+
+// Kernel output waiting to be put on the active console. Anyone can add to it, including
+// IRQ handlers that interrupted another writer, without taking a lock or disabling interrupts.
+// A slot holds 0x100 | character once it's been written, and 0 once it's been consumed.
+// It's consumed with interrupts disabled, so there's only ever one reader at a time.
+static const u32 log_ring_size = 4096;
+static Atomic<u16> s_log_ring[log_ring_size];
+static Atomic<u32> s_log_ring_head;
+static Atomic<u32> s_log_ring_tail;
+
+static bool log_ring_enqueue(u8 ch)
+{
+    u32 head = s_log_ring_head.load(AK::memory_order_relaxed);
+    do {
+        if (head - s_log_ring_tail.load(AK::memory_order_acquire) >= log_ring_size)
+            return false;
+    } while (!s_log_ring_head.compare_exchange_strong(head, head + 1, AK::memory_order_acq_rel));
+    s_log_ring[head % log_ring_size].store(0x100 | ch, AK::memory_order_release);
+    return true;
+}
+
 void VirtualConsole::get_vga_cursor(u8& row, u8& column)
 {
     u16 value;
@@ -51,7 +82,8 @@ void VirtualConsole::get_vga_cursor(u8& row, u8& column)
 
 void VirtualConsole::flush_vga_cursor()
 {
-    u16 value = m_current_vga_start_address + (m_cursor_row * columns() + m_cursor_column);
+    // While looking at the scrollback, this pushes the cursor off the bottom of the screen.
+    u16 value = m_current_vga_start_address + ((m_cursor_row + m_view_offset) * columns() + m_cursor_column);
     IO::out8(0x3d4, 0x0e);
     IO::out8(0x3d5, MSB(value));
     IO::out8(0x3d4, 0x0f);
@@ -79,6 +111,7 @@ VirtualConsole::VirtualConsole(unsigned index, InitialContents initial_contents)
 {
     sprintf(m_tty_name, "/dev/tty%u", m_index);
     set_size(80, 25);
+    ASSERT(rows() < 32);
     m_horizontal_tabs = static_cast<u8*>(kmalloc_eternal(columns()));
     for (unsigned i = 0; i < columns(); ++i)
         m_horizontal_tabs[i] = (i % 8) == 0;
@@ -86,15 +119,15 @@ VirtualConsole::VirtualConsole(unsigned index, InitialContents initial_contents)
     m_horizontal_tabs[columns() - 1] = 1;
 
     s_consoles[index] = this;
-    m_buffer = (u8*)kmalloc_eternal(rows() * columns() * 2);
+    m_line_count = rows() + scrollback_line_count;
+    m_cells = static_cast<u16*>(kmalloc_eternal(m_line_count * columns() * sizeof(u16)));
+    for (unsigned i = 0; i < m_line_count * columns(); ++i)
+        m_cells[i] = 0x0720;
     if (initial_contents == AdoptCurrentVGABuffer) {
-        memcpy(m_buffer, s_vga_buffer, rows() * columns() * 2);
+        memcpy(m_cells, s_vga_buffer, rows() * columns() * sizeof(u16));
         get_vga_cursor(m_cursor_row, m_cursor_column);
-    } else {
-        u16* line_mem = reinterpret_cast<u16*>(m_buffer);
-        for (u16 i = 0; i < rows() * columns(); ++i)
-            line_mem[i] = 0x0720;
     }
+    mark_all_dirty();
 }
 
 VirtualConsole::~VirtualConsole()
@@ -104,11 +137,12 @@ VirtualConsole::~VirtualConsole()
 
 void VirtualConsole::clear()
 {
-    u16* linemem = m_active ? (u16*)s_vga_buffer : (u16*)m_buffer;
-    for (u16 i = 0; i < rows() * columns(); ++i)
-        linemem[i] = 0x0720;
-    if (m_active)
-        set_vga_start_row(0);
+    for (unsigned row = 0; row < rows(); ++row) {
+        auto* cells = line(row);
+        for (unsigned column = 0; column < columns(); ++column)
+            cells[column] = 0x0720;
+    }
+    mark_all_dirty();
     set_cursor(0, 0);
 }
 
@@ -144,14 +178,14 @@ void VirtualConsole::set_active(bool b)
 
     m_active = b;
     if (!m_active) {
-        memcpy(m_buffer, m_current_vga_window, rows() * columns() * 2);
         KeyboardDevice::the().set_client(nullptr);
         return;
     }
 
-    memcpy(s_vga_buffer, m_buffer, rows() * columns() * 2);
     set_vga_start_row(0);
-    flush_vga_cursor();
+    m_pending_hardware_scroll = 0;
+    mark_all_dirty();
+    flush_dirty_lines();
 
     KeyboardDevice::the().set_client(this);
 }
@@ -356,7 +390,8 @@ void VirtualConsole::escape$J(const Vector<unsigned>& params)
         clear();
         break;
     case 3:
-        // FIXME: <esc>[3J should also clear the scrollback buffer.
+        m_scrollback_lines = 0;
+        m_view_offset = 0;
         clear();
         break;
     }
@@ -405,31 +440,21 @@ void VirtualConsole::execute_escape_sequence(u8 final)
     m_intermediates.clear();
 }
 
-void VirtualConsole::clear_vga_row(u16 row)
-{
-    u16* linemem = (u16*)&m_current_vga_window[row * 160];
-    for (u16 i = 0; i < columns(); ++i)
-        linemem[i] = 0x0720;
-}
-
 void VirtualConsole::scroll_up()
 {
     if (m_cursor_row == (rows() - 1)) {
-        if (m_active) {
-            if (m_vga_start_row >= 160) {
-                memcpy(s_vga_buffer, m_current_vga_window + 160, (rows() - 1) * columns() * 2);
-                set_vga_start_row(0);
-                clear_vga_row(24);
-            } else {
-                set_vga_start_row(m_vga_start_row + 1);
-                clear_vga_row(24);
-            }
-        } else {
-            memmove(m_buffer, m_buffer + 160, 160 * 24);
-            u16* linemem = (u16*)&m_buffer[24 * 160];
-            for (u16 i = 0; i < columns(); ++i)
-                linemem[i] = 0x0720;
-        }
+        // The top line becomes scrollback, and the oldest scrollback line becomes the new bottom line.
+        m_first_line = (m_first_line + 1) % m_line_count;
+        if (m_scrollback_lines < scrollback_line_count)
+            ++m_scrollback_lines;
+        auto* cells = line(rows() - 1);
+        for (unsigned column = 0; column < columns(); ++column)
+            cells[column] = 0x0720;
+
+        // Everything on screen moved up a row, and flush will move the VGA window to match.
+        m_dirty_rows >>= 1;
+        mark_dirty(rows() - 1);
+        ++m_pending_hardware_scroll;
     } else {
         ++m_cursor_row;
     }
@@ -442,22 +467,111 @@ void VirtualConsole::set_cursor(unsigned row, unsigned column)
     ASSERT(column < columns());
     m_cursor_row = row;
     m_cursor_column = column;
-    if (m_active)
-        flush_vga_cursor();
 }
 
 void VirtualConsole::put_character_at(unsigned row, unsigned column, u8 ch)
 {
     ASSERT(row < rows());
     ASSERT(column < columns());
-    u16 cur = (row * 160) + (column * 2);
-    if (m_active) {
-        u16 cur = (row * 160) + (column * 2);
-        m_current_vga_window[cur] = ch;
-        m_current_vga_window[cur + 1] = m_current_attribute;
-    } else {
-        m_buffer[cur] = ch;
-        m_buffer[cur + 1] = m_current_attribute;
+    line(row)[column] = (m_current_attribute << 8) | ch;
+    mark_dirty(row);
+}
+
+void VirtualConsole::scroll_view(int delta)
+{
+    int new_offset = (int)m_view_offset + delta;
+    if (new_offset < 0)
+        new_offset = 0;
+    if (new_offset > (int)m_scrollback_lines)
+        new_offset = m_scrollback_lines;
+    if ((unsigned)new_offset == m_view_offset)
+        return;
+    m_view_offset = new_offset;
+    mark_all_dirty();
+}
+
+void VirtualConsole::flush_dirty_lines()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (!m_active || m_graphical)
+        return;
+
+    if (m_pending_hardware_scroll) {
+        // Scroll the VGA window instead of redrawing, as long as there's room for it
+        // and we're not looking at the scrollback.
+        if (!m_view_offset && m_pending_hardware_scroll < rows() && m_vga_start_row + m_pending_hardware_scroll <= max_vga_start_row) {
+            set_vga_start_row(m_vga_start_row + m_pending_hardware_scroll);
+        } else {
+            set_vga_start_row(0);
+            mark_all_dirty();
+        }
+        m_pending_hardware_scroll = 0;
+    }
+
+    for (unsigned row = 0; m_dirty_rows && row < rows(); ++row) {
+        if (!(m_dirty_rows & (1u << row)))
+            continue;
+        memcpy(m_current_vga_window + row * columns() * sizeof(u16), line_in_view(row), columns() * sizeof(u16));
+        m_dirty_rows &= ~(1u << row);
+    }
+    flush_vga_cursor();
+}
+
+void VirtualConsole::flush()
+{
+    InterruptDisabler disabler;
+    drain_log_ring();
+    flush_dirty_lines();
+}
+
+void VirtualConsole::request_flush()
+{
+    // Until there's a flush thread to do it (and when the scheduler isn't around to run it),
+    // just do it right away.
+    if (!s_flush_thread || !Thread::current) {
+        if (s_active_console != -1)
+            s_consoles[s_active_console]->flush();
+        return;
+    }
+    if (!s_flush_requested.exchange(true))
+        s_flush_wait_queue->wake_all();
+}
+
+void VirtualConsole::drain_log_ring()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    auto* console = s_active_console != -1 ? s_consoles[s_active_console] : nullptr;
+    u32 tail = s_log_ring_tail.load(AK::memory_order_relaxed);
+    for (;;) {
+        auto& slot = s_log_ring[tail % log_ring_size];
+        u16 value = slot.load(AK::memory_order_acquire);
+        // Either empty, or a writer has reserved the slot but not filled it in yet.
+        if (!(value & 0x100))
+            break;
+        slot.store(0, AK::memory_order_relaxed);
+        s_log_ring_tail.store(++tail, AK::memory_order_release);
+        if (!console)
+            continue;
+        auto old_attribute = console->m_current_attribute;
+        console->m_current_attribute = 0x03;
+        console->on_char(value & 0xff);
+        console->m_current_attribute = old_attribute;
+    }
+}
+
+void VirtualConsole::flush_thread_main()
+{
+    s_flush_wait_queue = new WaitQueue;
+    s_flush_thread = Thread::current;
+    for (;;) {
+        {
+            InterruptDisabler disabler;
+            if (!s_flush_requested.load())
+                Thread::current->wait_on(*s_flush_wait_queue);
+            s_flush_requested.store(false);
+        }
+        if (s_active_console != -1)
+            s_consoles[s_active_console]->flush();
     }
 }
 
@@ -547,6 +661,17 @@ void VirtualConsole::on_key_pressed(KeyboardDevice::Event key)
 
     if (!key.is_press())
         return;
+    if (key.shift() && (key.key == Key_PageUp || key.key == Key_PageDown)) {
+        InterruptDisabler disabler;
+        scroll_view(key.key == Key_PageUp ? rows() / 2 : -(int)(rows() / 2));
+        request_flush();
+        return;
+    }
+    if (m_view_offset) {
+        InterruptDisabler disabler;
+        scroll_view(-(int)m_view_offset);
+        request_flush();
+    }
     if (key.ctrl()) {
         if (key.character >= 'a' && key.character <= 'z') {
             emit(key.character - 'a' + 1);
@@ -561,18 +686,29 @@ void VirtualConsole::on_key_pressed(KeyboardDevice::Event key)
 
 void VirtualConsole::on_sysconsole_receive(u8 ch)
 {
-    InterruptDisabler disabler;
-    auto old_attribute = m_current_attribute;
-    m_current_attribute = 0x03;
-    on_char(ch);
-    m_current_attribute = old_attribute;
+    if (!log_ring_enqueue(ch)) {
+        // The flush thread has fallen this far behind, so catch up right here.
+        {
+            InterruptDisabler disabler;
+            drain_log_ring();
+        }
+        log_ring_enqueue(ch);
+    }
+    if (ch == '\n' || !s_flush_thread)
+        request_flush();
 }
 
 ssize_t VirtualConsole::on_tty_write(const u8* data, ssize_t size)
 {
-    InterruptDisabler disabler;
-    for (ssize_t i = 0; i < size; ++i)
-        on_char(data[i]);
+    {
+        InterruptDisabler disabler;
+        // Keep kernel and userspace output in the order it was produced.
+        drain_log_ring();
+        scroll_view(-(int)m_view_offset);
+        for (ssize_t i = 0; i < size; ++i)
+            on_char(data[i]);
+    }
+    request_flush();
     return size;
 }
 
@@ -48,6 +48,9 @@ public:
     static void switch_to(unsigned);
     static void initialize();
 
+    // Puts queued kernel output and dirty lines on the screen in the background.
+    static void flush_thread_main();
+
     bool is_graphical() { return m_graphical; }
     void set_graphical(bool graphical);
 
@@ -57,6 +60,7 @@ private:
 
     // ^ConsoleImplementation
     virtual void on_sysconsole_receive(u8) override;
+    virtual void flush() override;
 
     // ^TTY
     virtual ssize_t on_tty_write(const u8*, ssize_t) override;
@@ -72,7 +76,27 @@ private:
     void get_vga_cursor(u8& row, u8& column);
     void flush_vga_cursor();
 
-    u8* m_buffer;
+    static void request_flush();
+    static void drain_log_ring();
+    void flush_dirty_lines();
+
+    // The screen and its scrollback live in one ring of lines, so scrolling only moves
+    // m_first_line. Only lines marked dirty are copied out to VGA memory on flush.
+    static const unsigned scrollback_line_count = 200;
+    u16* line(unsigned row) { return &m_cells[((m_first_line + row) % m_line_count) * columns()]; }
+    u16* line_in_view(unsigned row) { return &m_cells[((m_first_line + m_line_count - m_view_offset + row) % m_line_count) * columns()]; }
+    void mark_dirty(unsigned row) { m_dirty_rows |= 1u << row; }
+    void mark_all_dirty() { m_dirty_rows = (1u << rows()) - 1; }
+    void scroll_view(int delta);
+
+    u16* m_cells { nullptr };
+    unsigned m_line_count { 0 };
+    unsigned m_first_line { 0 };
+    unsigned m_scrollback_lines { 0 };
+    unsigned m_view_offset { 0 };
+    u32 m_dirty_rows { 0 };
+    unsigned m_pending_hardware_scroll { 0 };
+
     unsigned m_index;
     bool m_active { false };
     bool m_graphical { false };
@@ -97,7 +121,6 @@ private:
     u8 m_saved_cursor_column { 0 };
     u8 m_current_attribute { 0x07 };
 
-    void clear_vga_row(u16 row);
     void set_vga_start_row(u16 row);
     u16 m_vga_start_row { 0 };
     u16 m_current_vga_start_address { 0 };
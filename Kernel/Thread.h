@@ -34,6 +34,7 @@
 #include <AK/Vector.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/UnixTypes.h>
@@ -63,6 +64,8 @@ struct ThreadSpecificData {
 #define THREAD_PRIORITY_MAX 99
 
 class Thread {
+    MAKE_SLAB_ALLOCATED(Thread)
+
     friend class Process;
     friend class Scheduler;
 
@@ -227,6 +230,18 @@ public:
         const FDVector& m_select_exceptional_fds;
     };
 
+    class EPollBlocker final : public Blocker {
+    public:
+        EPollBlocker(EPoll&, const timeval& deadline, bool has_timeout);
+        virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual const char* state_string() const override { return "EPolling"; }
+
+    private:
+        NonnullRefPtr<EPoll> m_epoll;
+        timeval m_deadline;
+        bool m_has_timeout { false };
+    };
+
     class WaitBlocker final : public Blocker {
     public:
         WaitBlocker(int wait_options, pid_t& waitee_pid);
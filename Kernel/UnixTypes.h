@@ -30,6 +30,10 @@
 
 #define PERF_EVENT_MALLOC 1
 #define PERF_EVENT_FREE 2
+#define PERF_EVENT_TRACEPOINT_NAME 3
+#define PERF_EVENT_TRACE_BEGIN 4
+#define PERF_EVENT_TRACE_END 5
+#define PERF_EVENT_TRACE_INSTANT 6
 
 #define WNOHANG 1
 #define WUNTRACED 2
@@ -72,6 +76,10 @@
 #define F_SETFD 2
 #define F_GETFL 3
 #define F_SETFL 4
+#define F_SETPIPE_SZ 1031
+#define F_GETPIPE_SZ 1032
+
+#define PIPE_MAX_SIZE (1 * MB)
 
 #define FD_CLOEXEC 1
 
@@ -373,6 +381,36 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN POLLIN
+#define EPOLLPRI POLLPRI
+#define EPOLLOUT POLLOUT
+#define EPOLLERR POLLERR
+#define EPOLLHUP POLLHUP
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_CLOEXEC O_CLOEXEC
+
+#define SPLICE_F_MOVE 1
+#define SPLICE_F_NONBLOCK 2
+#define SPLICE_F_MORE 4
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -491,6 +529,8 @@ struct iovec {
     size_t iov_len;
 };
 
+#define IOV_MAX 1024
+
 struct sched_param {
     int sched_priority;
 };
@@ -70,9 +70,23 @@ AnonymousVMObject::AnonymousVMObject(PhysicalAddress paddr, size_t size)
 
 AnonymousVMObject::AnonymousVMObject(const AnonymousVMObject& other)
     : VMObject(other)
+    , m_swap_entries(other.m_swap_entries)
 {
 }
 
+RefPtr<SwapEntry> AnonymousVMObject::swap_entry(size_t page_index) const
+{
+    auto it = m_swap_entries.find(page_index);
+    if (it == m_swap_entries.end())
+        return nullptr;
+    return (*it).value;
+}
+
+void AnonymousVMObject::set_swap_entry(size_t page_index, NonnullRefPtr<SwapEntry> entry)
+{
+    m_swap_entries.set(page_index, move(entry));
+}
+
 AnonymousVMObject::~AnonymousVMObject()
 {
 }
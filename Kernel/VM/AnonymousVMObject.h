@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
+#include <Kernel/VM/SwapManager.h>
 #include <Kernel/VM/VMObject.h>
 #include <LibBareMetal/Memory/PhysicalAddress.h>
 
@@ -40,6 +42,13 @@ public:
     static NonnullRefPtr<AnonymousVMObject> create_with_physical_page(PhysicalPage&);
     virtual NonnullRefPtr<VMObject> clone() override;
 
+    // Pages that have been swapped out have a null physical page and an entry here.
+    RefPtr<SwapEntry> swap_entry(size_t page_index) const;
+    void set_swap_entry(size_t page_index, NonnullRefPtr<SwapEntry>);
+    void clear_swap_entry(size_t page_index) { m_swap_entries.remove(page_index); }
+    bool has_swapped_pages() const { return !m_swap_entries.is_empty(); }
+    size_t swapped_page_count() const { return m_swap_entries.size(); }
+
 protected:
     explicit AnonymousVMObject(size_t);
     explicit AnonymousVMObject(const AnonymousVMObject&);
@@ -54,6 +63,8 @@ private:
     AnonymousVMObject(AnonymousVMObject&&) = delete;
 
     virtual bool is_anonymous() const override { return true; }
+
+    HashMap<size_t, NonnullRefPtr<SwapEntry>> m_swap_entries;
 };
 
 }
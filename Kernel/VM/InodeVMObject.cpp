@@ -93,9 +93,14 @@ void InodeVMObject::inode_contents_changed(Badge<Inode>, off_t offset, ssize_t s
 {
     (void)size;
     (void)data;
-    InterruptDisabler disabler;
     ASSERT(offset >= 0);
 
+    // Writes went straight into the pages we have mapped, there's nothing to refresh.
+    if (m_inode->has_shared_pages())
+        return;
+
+    InterruptDisabler disabler;
+
     // FIXME: Only invalidate the parts that actually changed.
     for (auto& physical_page : m_physical_pages)
         physical_page = nullptr;
@@ -28,18 +28,29 @@
 #include "Process.h"
 #include <AK/Assertions.h>
 #include <AK/Memory.h>
+#include <AK/QuickSort.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Devices/MemoryPressureDevice.h>
+#include <Kernel/ExecutableCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/KParams.h>
 #include <Kernel/Multiboot.h>
+#include <Kernel/Time/TimeManagement.h>
 #include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/ContiguousVMObject.h>
+#include <Kernel/VM/InodeVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PhysicalRegion.h>
 #include <Kernel/VM/PurgeableVMObject.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/VM/SwapManager.h>
+#include <Kernel/WaitQueue.h>
 #include <LibBareMetal/StdLib.h>
+#include <LibC/sys/memory_pressure.h>
 
 //#define MM_DEBUG
 //#define PAGE_FAULT_DEBUG
@@ -51,21 +62,50 @@ extern FlatPtr end_of_kernel_bss;
 namespace Kernel {
 
 static MemoryManager* s_the;
+static WaitQueue* s_reclaim_wait_queue;
 
 MemoryManager& MM
 {
     return *s_the;
 }
 
+bool MemoryManager::is_initialized()
+{
+    return s_the;
+}
+
 MemoryManager::MemoryManager()
 {
     m_kernel_page_directory = PageDirectory::create_kernel_page_directory();
     parse_memory_map();
     write_cr3(kernel_page_directory().cr3());
     setup_low_identity_mapping();
+
+    // boot.S maps the first 8 MB above the 3 GB mark with large pages.
+    auto* kernel_pd = quickmap_pd(kernel_page_directory(), 3);
+    for (size_t i = 0; i < 512; ++i) {
+        if (kernel_pd[i].is_present() && kernel_pd[i].is_huge())
+            ++m_large_pages_mapped;
+    }
+
     protect_kernel_image();
 
     m_shared_zero_page = allocate_user_physical_page();
+
+    auto read_page_count_param = [](const char* key, size_t& value) {
+        if (!KParams::the().has(key))
+            return;
+        bool ok;
+        unsigned page_count = KParams::the().get(key).to_uint(ok);
+        if (ok)
+            value = min(page_count, 64u);
+    };
+    read_page_count_param("fault_around", m_fault_around_pages);
+    read_page_count_param("precommit", m_precommit_pages);
+
+    m_reclaim_low_watermark = max(m_user_physical_pages / 32, 64u);
+    m_reclaim_high_watermark = m_reclaim_low_watermark * 2;
+    s_reclaim_wait_queue = new WaitQueue;
 }
 
 MemoryManager::~MemoryManager()
@@ -74,18 +114,33 @@ MemoryManager::~MemoryManager()
 
 void MemoryManager::protect_kernel_image()
 {
+    // The kernel image is mapped with large pages, so only split the ones that
+    // straddle a boundary between segments with different protections.
+    auto for_each_mapping_in = [this](FlatPtr start, FlatPtr end, auto callback) {
+        for (FlatPtr vaddr = start; vaddr < end;) {
+            auto& pde = this->pde(kernel_page_directory(), VirtualAddress(vaddr));
+            if (pde.is_huge() && !(vaddr % LARGE_PAGE_SIZE) && vaddr + LARGE_PAGE_SIZE <= end) {
+                callback(pde);
+                flush_tlb(VirtualAddress(vaddr));
+                vaddr += LARGE_PAGE_SIZE;
+                continue;
+            }
+            callback(ensure_pte(kernel_page_directory(), VirtualAddress(vaddr)));
+            flush_tlb(VirtualAddress(vaddr));
+            vaddr += PAGE_SIZE;
+        }
+    };
+
     // Disable writing to the kernel text and rodata segments.
-    for (size_t i = (FlatPtr)&start_of_kernel_text; i < (FlatPtr)&start_of_kernel_data; i += PAGE_SIZE) {
-        auto& pte = ensure_pte(kernel_page_directory(), VirtualAddress(i));
-        pte.set_writable(false);
-    }
+    for_each_mapping_in((FlatPtr)&start_of_kernel_text, (FlatPtr)&start_of_kernel_data, [](auto& entry) {
+        entry.set_writable(false);
+    });
 
     if (g_cpu_supports_nx) {
         // Disable execution of the kernel data and bss segments.
-        for (size_t i = (FlatPtr)&start_of_kernel_data; i < (FlatPtr)&end_of_kernel_bss; i += PAGE_SIZE) {
-            auto& pte = ensure_pte(kernel_page_directory(), VirtualAddress(i));
-            pte.set_execute_disabled(true);
-        }
+        for_each_mapping_in((FlatPtr)&start_of_kernel_data, (FlatPtr)&end_of_kernel_bss, [](auto& entry) {
+            entry.set_execute_disabled(true);
+        });
     }
 }
 
@@ -187,16 +242,28 @@ void MemoryManager::parse_memory_map()
         m_user_physical_pages += region.finalize_capacity();
 }
 
-const PageTableEntry* MemoryManager::pte(const PageDirectory& page_directory, VirtualAddress vaddr)
+static inline u32 page_table_key(VirtualAddress vaddr)
+{
+    // One page table covers 2 MB, so this is the page directory pointer table index
+    // and the page directory index glued together.
+    return vaddr.get() >> 21;
+}
+
+PageDirectoryEntry& MemoryManager::pde(PageDirectory& page_directory, VirtualAddress vaddr)
 {
     ASSERT_INTERRUPTS_DISABLED();
     u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
     u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+    return quickmap_pd(page_directory, page_directory_table_index)[page_directory_index];
+}
+
+const PageTableEntry* MemoryManager::pte(const PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
-    auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
-    const PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present())
+    const PageDirectoryEntry& pde = this->pde(const_cast<PageDirectory&>(page_directory), vaddr);
+    if (!pde.is_present() || pde.is_huge())
         return nullptr;
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
@@ -205,31 +272,122 @@ const PageTableEntry* MemoryManager::pte(const PageDirectory& page_directory, Vi
 PageTableEntry& MemoryManager::ensure_pte(PageDirectory& page_directory, VirtualAddress vaddr)
 {
     ASSERT_INTERRUPTS_DISABLED();
-    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x3;
-    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
-    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
-    PageDirectoryEntry& pde = pd[page_directory_index];
+    PageDirectoryEntry& pde = this->pde(page_directory, vaddr);
+    if (pde.is_present() && pde.is_huge())
+        split_large_page(page_directory, vaddr);
     if (!pde.is_present()) {
 #ifdef MM_DEBUG
-        dbg() << "MM: PDE " << page_directory_index << " not present (requested for " << vaddr << "), allocating";
+        dbg() << "MM: PDE " << page_table_key(vaddr) << " not present (requested for " << vaddr << "), allocating";
 #endif
         auto page_table = allocate_user_physical_page(ShouldZeroFill::Yes);
 #ifdef MM_DEBUG
-        dbg() << "MM: PD K" << &page_directory << " (" << (&page_directory == m_kernel_page_directory ? "Kernel" : "User") << ") at " << PhysicalAddress(page_directory.cr3()) << " allocated page table #" << page_directory_index << " (for " << vaddr << ") at " << page_table->paddr();
+        dbg() << "MM: PD K" << &page_directory << " (" << (&page_directory == m_kernel_page_directory ? "Kernel" : "User") << ") at " << PhysicalAddress(page_directory.cr3()) << " allocated page table #" << page_table_key(vaddr) << " (for " << vaddr << ") at " << page_table->paddr();
 #endif
         pde.set_page_table_base(page_table->paddr().get());
         pde.set_user_allowed(true);
         pde.set_present(true);
         pde.set_writable(true);
         pde.set_global(&page_directory == m_kernel_page_directory.ptr());
-        page_directory.m_physical_pages.set(page_directory_index, move(page_table));
+        page_directory.m_physical_pages.set(page_table_key(vaddr), move(page_table));
     }
 
     return quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
 
+bool MemoryManager::map_large_page(PageDirectory& page_directory, VirtualAddress vaddr, PhysicalAddress paddr, const Region& region)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(!(vaddr.get() % LARGE_PAGE_SIZE));
+    if (paddr.get() % LARGE_PAGE_SIZE)
+        return false;
+
+    auto& pde = this->pde(page_directory, vaddr);
+    bool had_page_table = pde.is_present() && !pde.is_huge();
+    if (!pde.is_present() || !pde.is_huge())
+        ++m_large_pages_mapped;
+
+    // The caller's region covers this entire page table, so whatever is left in it is stale.
+    if (had_page_table)
+        page_directory.m_physical_pages.remove(page_table_key(vaddr));
+
+    pde.clear();
+    pde.set_page_table_base(paddr.get());
+    pde.set_huge(true);
+    pde.set_present(true);
+    pde.set_writable(region.is_writable());
+    pde.set_user_allowed(region.is_user_accessible());
+    pde.set_cache_disabled(!region.is_cacheable());
+    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    if (g_cpu_supports_nx)
+        pde.set_execute_disabled(!region.is_executable());
+
+    if (had_page_table)
+        flush_entire_tlb();
+    else
+        flush_tlb(vaddr);
+#ifdef MM_DEBUG
+    dbg() << "MM: Mapped large page " << vaddr << " => " << paddr << " for " << region.name();
+#endif
+    return true;
+}
+
+bool MemoryManager::unmap_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(!(vaddr.get() % LARGE_PAGE_SIZE));
+    auto& pde = this->pde(page_directory, vaddr);
+    if (!pde.is_present() || !pde.is_huge())
+        return false;
+    pde.clear();
+    flush_tlb(vaddr);
+    --m_large_pages_mapped;
+    return true;
+}
+
+void MemoryManager::split_large_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    auto base = VirtualAddress(vaddr.get() & ~(LARGE_PAGE_SIZE - 1));
+    auto& pde = this->pde(page_directory, base);
+    ASSERT(pde.is_present() && pde.is_huge());
+
+    // Replace the large page with a page table mapping the same 512 small pages, so
+    // that the caller can change protections or mappings for just one of them.
+    auto large_page_base = (FlatPtr)pde.page_table_base() & ~(LARGE_PAGE_SIZE - 1);
+    auto page_table = allocate_user_physical_page(ShouldZeroFill::No);
+    auto* ptes = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < LARGE_PAGE_PAGE_COUNT; ++i) {
+        auto& pte = ptes[i];
+        pte.clear();
+        pte.set_physical_page_base(large_page_base + i * PAGE_SIZE);
+        pte.set_present(true);
+        pte.set_writable(pde.is_writable());
+        pte.set_user_allowed(pde.is_user_allowed());
+        pte.set_write_through(pde.is_write_through());
+        pte.set_cache_disabled(pde.is_cache_disabled());
+        pte.set_global(pde.is_global());
+        if (g_cpu_supports_nx)
+            pte.set_execute_disabled(pde.is_execute_disabled());
+    }
+
+    pde.clear();
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_present(true);
+    pde.set_writable(true);
+    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    page_directory.m_physical_pages.set(page_table_key(base), move(page_table));
+    flush_tlb(base);
+
+    --m_large_pages_mapped;
+    ++m_large_page_splits;
+#ifdef MM_DEBUG
+    dbg() << "MM: Split large page at " << base;
+#endif
+}
+
 void MemoryManager::initialize()
 {
     s_the = new MemoryManager;
@@ -307,7 +465,7 @@ PageFaultResponse MemoryManager::handle_page_fault(const PageFault& fault)
 OwnPtr<Region> MemoryManager::allocate_contiguous_kernel_region(size_t size, const StringView& name, u8 access, bool user_accessible, bool cacheable)
 {
     ASSERT(!(size % PAGE_SIZE));
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, size >= LARGE_PAGE_SIZE ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.is_valid())
         return nullptr;
     auto vmobject = ContiguousVMObject::create_with_size(size);
@@ -335,7 +493,8 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(size_t size, const StringVi
 OwnPtr<Region> MemoryManager::allocate_kernel_region(PhysicalAddress paddr, size_t size, const StringView& name, u8 access, bool user_accessible, bool cacheable)
 {
     ASSERT(!(size % PAGE_SIZE));
-    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size);
+    bool large_page_aligned = size >= LARGE_PAGE_SIZE && !(paddr.get() % LARGE_PAGE_SIZE);
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, large_page_aligned ? LARGE_PAGE_SIZE : PAGE_SIZE);
     if (!range.is_valid())
         return nullptr;
     auto vmobject = AnonymousVMObject::create_for_physical_range(paddr, size);
@@ -442,9 +601,94 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
     }
 
     ++m_user_physical_pages_used;
+
+    if (m_user_physical_pages - m_user_physical_pages_used < m_reclaim_low_watermark && !m_reclaim_requested) {
+        m_reclaim_requested = true;
+        s_reclaim_wait_queue->wake_all();
+    }
+
     return page;
 }
 
+void MemoryManager::wait_for_memory_pressure()
+{
+    if (MemoryPressureDevice::the().level() != MEMORY_PRESSURE_NORMAL) {
+        // Keep checking while we're under pressure, so listeners hear when it's over.
+        Thread::current->sleep(TimeManagement::the().ticks_per_second());
+        return;
+    }
+    InterruptDisabler disabler;
+    if (!m_reclaim_requested)
+        Thread::current->wait_on(*s_reclaim_wait_queue);
+    m_reclaim_requested = false;
+}
+
+void MemoryManager::reclaim()
+{
+    auto free_pages = [this] { return m_user_physical_pages - m_user_physical_pages_used; };
+    auto& pressure = MemoryPressureDevice::the();
+
+    if (free_pages() >= m_reclaim_low_watermark) {
+        pressure.set_level(MEMORY_PRESSURE_NORMAL);
+        return;
+    }
+
+    // Tell userspace first, so it can start dropping its own caches while we work.
+    pressure.set_level(free_pages() < m_reclaim_low_watermark / 2 ? MEMORY_PRESSURE_CRITICAL : MEMORY_PRESSURE_LOW);
+
+    ++m_reclaim_count;
+    unsigned free_pages_before = free_pages();
+
+    Vector<NonnullRefPtr<PurgeableVMObject>> volatile_vmobjects;
+    Vector<NonnullRefPtr<InodeVMObject>> inode_vmobjects;
+    {
+        InterruptDisabler disabler;
+        for_each_vmobject([&](auto& vmobject) {
+            if (vmobject.is_purgeable() && static_cast<PurgeableVMObject&>(vmobject).is_volatile())
+                volatile_vmobjects.append(static_cast<PurgeableVMObject&>(vmobject));
+            else if (vmobject.is_inode())
+                inode_vmobjects.append(static_cast<InodeVMObject&>(vmobject));
+            return IterationDecision::Continue;
+        });
+    }
+
+    // Volatile memory goes first, starting with whatever has been volatile the longest.
+    quick_sort(volatile_vmobjects, [](auto& a, auto& b) { return a->volatile_since() < b->volatile_since(); });
+    for (auto& vmobject : volatile_vmobjects) {
+        if (free_pages() >= m_reclaim_high_watermark)
+            break;
+        vmobject->purge();
+    }
+
+    // Cached executables can always be parsed again, so let go of their data segments.
+    if (free_pages() < m_reclaim_high_watermark)
+        ExecutableCache::the().purge();
+
+    // Then clean file pages, which can always be read back in.
+    for (auto& vmobject : inode_vmobjects) {
+        if (free_pages() >= m_reclaim_high_watermark)
+            break;
+        vmobject->release_all_clean_pages();
+    }
+
+    // Then what raw device readers have cached, and clean blocks in the disk caches.
+    if (free_pages() < m_reclaim_high_watermark)
+        BlockDevice::release_all_read_cache_pages();
+    if (free_pages() < m_reclaim_high_watermark)
+        FS::release_all_clean_cache_pages();
+
+    // And finally anonymous memory nobody has touched in a while.
+    if (free_pages() < m_reclaim_high_watermark)
+        SwapManager::the().swap_out_cold_pages(m_reclaim_high_watermark - free_pages());
+
+    if (free_pages() > free_pages_before)
+        m_reclaimed_pages += free_pages() - free_pages_before;
+    klog() << "MM: Reclaim freed " << (free_pages() > free_pages_before ? free_pages() - free_pages_before : 0) << " pages, " << free_pages() << " pages free";
+
+    if (free_pages() >= m_reclaim_low_watermark)
+        pressure.set_level(MEMORY_PRESSURE_NORMAL);
+}
+
 void MemoryManager::deallocate_supervisor_physical_page(PhysicalPage&& page)
 {
     for (auto& region : m_super_physical_regions) {
@@ -663,6 +907,9 @@ bool MemoryManager::can_read_without_faulting(const Process& process, VirtualAdd
 {
     // FIXME: Use the size argument!
     UNUSED_PARAM(size);
+    auto& pde = const_cast<MemoryManager*>(this)->pde(const_cast<PageDirectory&>(process.page_directory()), vaddr);
+    if (pde.is_present() && pde.is_huge())
+        return true;
     auto* pte = const_cast<MemoryManager*>(this)->pte(process.page_directory(), vaddr);
     if (!pte)
         return false;
@@ -39,6 +39,10 @@ namespace Kernel {
 
 #define PAGE_ROUND_UP(x) ((((u32)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
 
+// With PAE, a page directory entry can map a 2 MB "large" page directly.
+#define LARGE_PAGE_SIZE (2 * MB)
+#define LARGE_PAGE_PAGE_COUNT (LARGE_PAGE_SIZE / PAGE_SIZE)
+
 template<typename T>
 inline T* low_physical_to_virtual(T* physical)
 {
@@ -72,12 +76,15 @@ class MemoryManager {
     friend class PhysicalPage;
     friend class PhysicalRegion;
     friend class Region;
+    friend class SwapManager;
+    friend class TmpFSInode;
     friend class VMObject;
     friend Optional<KBuffer> procfs$mm(InodeIdentifier);
     friend Optional<KBuffer> procfs$memstat(InodeIdentifier);
 
 public:
     static MemoryManager& the();
+    static bool is_initialized();
 
     static void initialize();
 
@@ -132,6 +139,26 @@ public:
 
     PhysicalPage& shared_zero_page() { return *m_shared_zero_page; }
 
+    // How many neighbouring pages an inode fault may map if they're already cached,
+    // and how many pages ahead a sequential zero fault commits. Set with the
+    // "fault_around=" and "precommit=" boot parameters; 0 disables either.
+    size_t fault_around_pages() const { return m_fault_around_pages; }
+    size_t precommit_pages() const { return m_precommit_pages; }
+
+    unsigned large_pages_mapped() const { return m_large_pages_mapped; }
+    unsigned large_page_splits() const { return m_large_page_splits; }
+
+    // When free user pages drop below the low watermark, the reclaim daemon wakes up.
+    // It purges volatile memory, drops clean file pages and disk cache, and finally
+    // swaps out cold anonymous memory until we're back above the high watermark.
+    void wait_for_memory_pressure();
+    void reclaim();
+
+    unsigned reclaim_low_watermark() const { return m_reclaim_low_watermark; }
+    unsigned reclaim_high_watermark() const { return m_reclaim_high_watermark; }
+    unsigned reclaim_count() const { return m_reclaim_count; }
+    unsigned reclaimed_pages() const { return m_reclaimed_pages; }
+
 private:
     MemoryManager();
     ~MemoryManager();
@@ -171,6 +198,11 @@ private:
 
     const PageTableEntry* pte(const PageDirectory&, VirtualAddress);
     PageTableEntry& ensure_pte(PageDirectory&, VirtualAddress);
+    PageDirectoryEntry& pde(PageDirectory&, VirtualAddress);
+
+    bool map_large_page(PageDirectory&, VirtualAddress, PhysicalAddress, const Region&);
+    bool unmap_large_page(PageDirectory&, VirtualAddress);
+    void split_large_page(PageDirectory&, VirtualAddress);
 
     RefPtr<PageDirectory> m_kernel_page_directory;
     RefPtr<PhysicalPage> m_low_page_table;
@@ -191,6 +223,18 @@ private:
     InlineLinkedList<VMObject> m_vmobjects;
 
     bool m_quickmap_in_use { false };
+
+    size_t m_fault_around_pages { 16 };
+    size_t m_precommit_pages { 8 };
+
+    unsigned m_large_pages_mapped { 0 };
+    unsigned m_large_page_splits { 0 };
+
+    unsigned m_reclaim_low_watermark { 0 };
+    unsigned m_reclaim_high_watermark { 0 };
+    unsigned m_reclaim_count { 0 };
+    unsigned m_reclaimed_pages { 0 };
+    bool m_reclaim_requested { false };
 };
 
 template<typename Callback>
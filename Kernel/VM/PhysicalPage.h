@@ -61,6 +61,7 @@ public:
     static NonnullRefPtr<PhysicalPage> create(PhysicalAddress, bool supervisor, bool may_return_to_freelist = true);
 
     u32 ref_count() const { return m_ref_count; }
+    bool may_return_to_freelist() const { return m_may_return_to_freelist; }
 
     bool is_shared_zero_page() const;
 
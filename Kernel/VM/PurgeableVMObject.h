@@ -44,7 +44,11 @@ public:
     void set_was_purged(bool b) { m_was_purged = b; }
 
     bool is_volatile() const { return m_volatile; }
-    void set_volatile(bool b) { m_volatile = b; }
+    void set_volatile(bool);
+
+    // When this object was last made volatile, i.e. when its owner stopped using it.
+    // Under memory pressure, the objects that have been volatile the longest go first.
+    u64 volatile_since() const { return m_volatile_since; }
 
 private:
     explicit PurgeableVMObject(size_t);
@@ -62,6 +66,7 @@ private:
 
     bool m_was_purged { false };
     bool m_volatile { false };
+    u64 m_volatile_since { 0 };
 };
 
 }
@@ -34,6 +34,7 @@
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/Region.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/VM/SwapManager.h>
 
 //#define MM_DEBUG
 //#define PAGE_FAULT_DEBUG
@@ -86,6 +87,21 @@ NonnullOwnPtr<Region> Region::clone()
     if (vmobject().is_inode())
         ASSERT(vmobject().is_private_inode());
 
+    if (!is_writable() && !m_stack && vmobject().is_private_inode()) {
+#ifdef MM_DEBUG
+        dbg() << "Region::clone(): Sharing read-only " << name() << " (" << vaddr() << ")";
+#endif
+        // Nobody can write to this file-backed region (typically library text), so the child can
+        // simply share our VMObject instead of cloning it. Both sides are marked CoW, and whichever
+        // one is made writable first gets a VMObject of its own in prepare_for_write_access().
+        // Anything else (anonymous or purgeable memory) carries per-process state and gets cloned.
+        ensure_cow_map().fill(true);
+        auto clone_region = Region::create_user_accessible(m_range, m_vmobject, m_offset_in_vmobject, m_name, m_access);
+        clone_region->ensure_cow_map();
+        clone_region->set_mmap(m_mmap);
+        return clone_region;
+    }
+
 #ifdef MM_DEBUG
     dbg() << "Region::clone(): CoWing " << name() << " (" << vaddr() << ")";
 #endif
@@ -104,6 +120,34 @@ NonnullOwnPtr<Region> Region::clone()
     return clone_region;
 }
 
+void Region::prepare_for_write_access()
+{
+    if (m_shared || m_vmobject->ref_count() == 1)
+        return;
+    // This private region shares its VMObject with someone else (see clone()),
+    // so it needs a copy-on-write VMObject of its own before it can be written to.
+    auto vmobject = m_vmobject->clone();
+
+    // Only the pages we map need to be shared with the original. Other regions using it (like the
+    // rest of a region split by mprotect()) then keep their pages to themselves and don't have to
+    // copy them on their next write.
+    size_t first_page = first_page_index();
+    size_t end_page = first_page + page_count();
+    for (size_t i = 0; i < vmobject->page_count(); ++i) {
+        if (i >= first_page && i < end_page)
+            continue;
+        if (vmobject->is_anonymous()) {
+            vmobject->physical_pages()[i] = MM.shared_zero_page();
+            static_cast<AnonymousVMObject&>(*vmobject).clear_swap_entry(i);
+        } else {
+            vmobject->physical_pages()[i] = nullptr;
+        }
+    }
+
+    m_vmobject = move(vmobject);
+    ensure_cow_map().fill(true);
+}
+
 bool Region::commit()
 {
     InterruptDisabler disabler;
@@ -124,6 +168,9 @@ bool Region::commit(size_t page_index)
     auto& vmobject_physical_page_entry = vmobject().physical_pages()[first_page_index() + page_index];
     if (!vmobject_physical_page_entry.is_null() && !vmobject_physical_page_entry->is_shared_zero_page())
         return true;
+    // A swapped-out page is still committed, it just lives somewhere else for now.
+    if (static_cast<AnonymousVMObject&>(vmobject()).swap_entry(first_page_index() + page_index))
+        return true;
     auto physical_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
     if (!physical_page) {
         klog() << "MM: commit was unable to allocate a physical page";
@@ -134,6 +181,22 @@ bool Region::commit(size_t page_index)
     return true;
 }
 
+bool Region::decommit(size_t page_index)
+{
+    ASSERT(vmobject().is_anonymous());
+    ASSERT(!m_shared);
+    InterruptDisabler disabler;
+    auto& vmobject_physical_page_entry = vmobject().physical_pages()[first_page_index() + page_index];
+    if (vmobject_physical_page_entry.is_null() || vmobject_physical_page_entry->is_shared_zero_page())
+        return false;
+    // Put the shared zero page back, like a freshly created AnonymousVMObject has,
+    // so the next write faults in a new page instead of hitting a not-present one.
+    vmobject_physical_page_entry = MM.shared_zero_page();
+    if (m_page_directory)
+        map_individual_page_impl(page_index);
+    return true;
+}
+
 u32 Region::cow_pages() const
 {
     if (!m_cow_map)
@@ -243,12 +306,38 @@ void Region::remap_page(size_t page_index)
     map_individual_page_impl(page_index);
 }
 
+bool Region::test_and_clear_accessed(size_t vmobject_page_index)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (!m_page_directory || vmobject_page_index < first_page_index() || vmobject_page_index > last_page_index())
+        return false;
+    auto page_vaddr = vaddr().offset((vmobject_page_index - first_page_index()) * PAGE_SIZE);
+    auto* pte = MM.pte(*m_page_directory, page_vaddr);
+    if (!pte || !pte->is_present() || !pte->is_accessed())
+        return false;
+    MM.ensure_pte(*m_page_directory, page_vaddr).set_accessed(false);
+    MM.flush_tlb(page_vaddr);
+    return true;
+}
+
+void Region::remap_vmobject_page(size_t vmobject_page_index)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (!m_page_directory || vmobject_page_index < first_page_index() || vmobject_page_index > last_page_index())
+        return;
+    map_individual_page_impl(vmobject_page_index - first_page_index());
+}
+
 void Region::unmap(ShouldDeallocateVirtualMemoryRange deallocate_range)
 {
     InterruptDisabler disabler;
     ASSERT(m_page_directory);
     for (size_t i = 0; i < page_count(); ++i) {
         auto vaddr = this->vaddr().offset(i * PAGE_SIZE);
+        if (covers_large_page(i) && MM.unmap_large_page(*m_page_directory, vaddr)) {
+            i += LARGE_PAGE_PAGE_COUNT - 1;
+            continue;
+        }
         auto& pte = MM.ensure_pte(*m_page_directory, vaddr);
         pte.clear();
         MM.flush_tlb(vaddr);
@@ -275,8 +364,42 @@ void Region::map(PageDirectory& page_directory)
 #ifdef MM_DEBUG
     dbg() << "MM: Region::map() will map VMO pages " << first_page_index() << " - " << last_page_index() << " (VMO page count: " << vmobject().page_count() << ")";
 #endif
-    for (size_t page_index = 0; page_index < page_count(); ++page_index)
+    for (size_t page_index = 0; page_index < page_count(); ++page_index) {
+        if (can_map_as_large_page(page_index)) {
+            auto& physical_page = vmobject().physical_pages()[first_page_index() + page_index];
+            if (MM.map_large_page(page_directory, vaddr().offset(page_index * PAGE_SIZE), physical_page->paddr(), *this)) {
+                page_index += LARGE_PAGE_PAGE_COUNT - 1;
+                continue;
+            }
+        }
         map_individual_page_impl(page_index);
+    }
+}
+
+bool Region::covers_large_page(size_t page_index) const
+{
+    return !(vaddr().offset(page_index * PAGE_SIZE).get() % LARGE_PAGE_SIZE)
+        && page_index + LARGE_PAGE_PAGE_COUNT <= page_count();
+}
+
+bool Region::can_map_as_large_page(size_t page_index) const
+{
+    if (!covers_large_page(page_index) || !is_readable())
+        return false;
+
+    // All 512 pages must be present, physically contiguous and have the same protection.
+    auto& physical_pages = vmobject().physical_pages();
+    auto& first_page = physical_pages[first_page_index() + page_index];
+    if (!first_page || first_page->is_shared_zero_page() || first_page->paddr().get() % LARGE_PAGE_SIZE)
+        return false;
+    for (size_t i = 0; i < LARGE_PAGE_PAGE_COUNT; ++i) {
+        auto& physical_page = physical_pages[first_page_index() + page_index + i];
+        if (!physical_page || physical_page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if (should_cow(page_index + i))
+            return false;
+    }
+    return true;
 }
 
 void Region::remap()
@@ -285,6 +408,16 @@ void Region::remap()
     map(*m_page_directory);
 }
 
+static void count_fault(bool major)
+{
+    if (!Thread::current)
+        return;
+    if (major)
+        Thread::current->process().did_major_fault();
+    else
+        Thread::current->process().did_minor_fault();
+}
+
 PageFaultResponse Region::handle_fault(const PageFault& fault)
 {
     auto page_index_in_region = page_index_from_address(fault.vaddr());
@@ -303,8 +436,23 @@ PageFaultResponse Region::handle_fault(const PageFault& fault)
 #endif
             return handle_inode_fault(page_index_in_region);
         }
+        if (vmobject().is_anonymous() && static_cast<AnonymousVMObject&>(vmobject()).swap_entry(first_page_index() + page_index_in_region)) {
+#ifdef PAGE_FAULT_DEBUG
+            dbg() << "NP(swap) fault in Region{" << this << "}[" << page_index_in_region << "]";
+#endif
+            return handle_swap_in_fault(page_index_in_region);
+        }
+        if (!vmobject().physical_pages()[first_page_index() + page_index_in_region].is_null()) {
+            // The page is there, it just hasn't been mapped into this page directory yet.
+            // This is how a forked child's address space gets populated.
+            count_fault(false);
+            remap_page(page_index_in_region);
+            fault_around(page_index_in_region);
+            return PageFaultResponse::Continue;
+        }
 #ifdef MAP_SHARED_ZERO_PAGE_LAZILY
         if (fault.is_read()) {
+            count_fault(false);
             vmobject().physical_pages()[first_page_index() + page_index_in_region] = MM.shared_zero_page();
             remap_page(page_index_in_region);
             return PageFaultResponse::Continue;
@@ -342,6 +490,7 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     cli();
 
     auto& vmobject_physical_page_entry = vmobject().physical_pages()[first_page_index() + page_index_in_region];
+    count_fault(false);
 
     if (!vmobject_physical_page_entry.is_null() && !vmobject_physical_page_entry->is_shared_zero_page()) {
 #ifdef PAGE_FAULT_DEBUG
@@ -365,13 +514,85 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 #endif
     vmobject_physical_page_entry = move(physical_page);
     remap_page(page_index_in_region);
+    precommit_after_zero_fault(page_index_in_region);
     return PageFaultResponse::Continue;
 }
 
+PageFaultResponse Region::handle_swap_in_fault(size_t page_index_in_region)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(vmobject().is_anonymous());
+
+    sti();
+    LOCKER(vmobject().m_paging_lock);
+    cli();
+
+    auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(vmobject());
+    auto vmobject_page_index = first_page_index() + page_index_in_region;
+    auto& vmobject_physical_page_entry = anonymous_vmobject.physical_pages()[vmobject_page_index];
+
+    auto entry = anonymous_vmobject.swap_entry(vmobject_page_index);
+    if (!entry) {
+        // Someone else swapped it in (or the swapper gave up on it) while we waited for the lock.
+        count_fault(false);
+        ASSERT(!vmobject_physical_page_entry.is_null());
+        remap_page(page_index_in_region);
+        return PageFaultResponse::Continue;
+    }
+
+    count_fault(entry->kind() == SwapEntry::Kind::Disk);
+
+    auto physical_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (physical_page.is_null()) {
+        klog() << "MM: handle_swap_in_fault was unable to allocate a physical page";
+        return PageFaultResponse::ShouldCrash;
+    }
+
+    if (!SwapManager::the().load(*entry, *physical_page)) {
+        klog() << "MM: handle_swap_in_fault was unable to load page " << page_index_in_region << " of " << name();
+        return PageFaultResponse::ShouldCrash;
+    }
+
+#ifdef PAGE_FAULT_DEBUG
+    dbg() << "      >> SWAP IN " << physical_page->paddr();
+#endif
+    vmobject_physical_page_entry = move(physical_page);
+    anonymous_vmobject.clear_swap_entry(vmobject_page_index);
+    SwapManager::the().did_swap_in();
+    remap_page(page_index_in_region);
+    return PageFaultResponse::Continue;
+}
+
+void Region::precommit_after_zero_fault(size_t page_index_in_region)
+{
+    // Only look ahead once a region is being touched front to back.
+    bool is_sequential = page_index_in_region == m_next_sequential_zero_fault;
+    m_next_sequential_zero_fault = page_index_in_region + 1;
+    if (!is_sequential)
+        return;
+
+    size_t end = min(page_count(), page_index_in_region + 1 + MM.precommit_pages());
+    for (size_t page_index = page_index_in_region + 1; page_index < end; ++page_index) {
+        auto& vmobject_physical_page_entry = vmobject().physical_pages()[first_page_index() + page_index];
+        if (vmobject_physical_page_entry.is_null() || !vmobject_physical_page_entry->is_shared_zero_page())
+            break;
+        auto physical_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        if (physical_page.is_null())
+            break;
+        vmobject_physical_page_entry = move(physical_page);
+        // The fresh page is ours alone, so map it writable right away instead of taking a CoW fault on it.
+        if (m_cow_map && !m_shared)
+            m_cow_map->set(page_index, false);
+        remap_page(page_index);
+    }
+    m_next_sequential_zero_fault = end;
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     ASSERT_INTERRUPTS_DISABLED();
     auto& vmobject_physical_page_entry = vmobject().physical_pages()[first_page_index() + page_index_in_region];
+    count_fault(false);
     if (vmobject_physical_page_entry->ref_count() == 1) {
 #ifdef PAGE_FAULT_DEBUG
         dbg() << "    >> It's a COW page but nobody is sharing it anymore. Remap r/w";
@@ -426,10 +647,13 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
 #ifdef PAGE_FAULT_DEBUG
         dbg() << ("MM: page_in_from_inode() but page already present. Fine with me!");
 #endif
+        count_fault(false);
         remap_page(page_index_in_region);
+        fault_around(page_index_in_region);
         return PageFaultResponse::Continue;
     }
 
+    count_fault(true);
     if (Thread::current)
         Thread::current->did_inode_fault();
 
@@ -437,8 +661,20 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     dbg() << "MM: page_in_from_inode ready to read from inode";
 #endif
     sti();
-    u8 page_buffer[PAGE_SIZE];
     auto& inode = inode_vmobject.inode();
+    if (inode_vmobject.is_shared_inode() && inode.has_shared_pages()) {
+        auto page = inode.shared_page(first_page_index() + page_index_in_region);
+        cli();
+        if (!page.is_null()) {
+            vmobject_physical_page_entry = move(page);
+            remap_page(page_index_in_region);
+            fault_around(page_index_in_region);
+            return PageFaultResponse::Continue;
+        }
+    }
+
+    sti();
+    u8 page_buffer[PAGE_SIZE];
     auto nread = inode.read_bytes((first_page_index() + page_index_in_region) * PAGE_SIZE, PAGE_SIZE, page_buffer, nullptr);
     if (nread < 0) {
         klog() << "MM: handle_inode_fault had error (" << nread << ") while reading!";
@@ -460,7 +696,32 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     MM.unquickmap_page();
 
     remap_page(page_index_in_region);
+    fault_around(page_index_in_region);
     return PageFaultResponse::Continue;
 }
 
+void Region::fault_around(size_t page_index_in_region)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    size_t window = MM.fault_around_pages();
+    if (window <= 1)
+        return;
+
+    // Map whatever the VMObject already has in the window around the faulting page,
+    // so walking through a file (or a freshly forked address space) doesn't cost
+    // one fault per page that's already in memory.
+    size_t start = (page_index_in_region / window) * window;
+    size_t end = min(page_count(), start + window);
+    for (size_t page_index = start; page_index < end; ++page_index) {
+        if (page_index == page_index_in_region)
+            continue;
+        if (vmobject().physical_pages()[first_page_index() + page_index].is_null())
+            continue;
+        auto& pte = MM.ensure_pte(*m_page_directory, vaddr().offset(page_index * PAGE_SIZE));
+        if (pte.is_present())
+            continue;
+        map_individual_page_impl(page_index);
+    }
+}
+
 }
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/InlineLinkedList.h>
+#include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <AK/Weakable.h>
 #include <Kernel/Heap/SlabAllocator.h>
@@ -90,6 +91,7 @@ public:
     PageFaultResponse handle_fault(const PageFault&);
 
     NonnullOwnPtr<Region> clone();
+    void prepare_for_write_access();
 
     bool contains(VirtualAddress vaddr) const
     {
@@ -129,6 +131,9 @@ public:
     bool commit();
     bool commit(size_t page_index);
 
+    // Gives the page back to the system; it will be zero-filled again on next access.
+    bool decommit(size_t page_index);
+
     size_t amount_resident() const;
     size_t amount_shared() const;
     size_t amount_dirty() const;
@@ -153,6 +158,11 @@ public:
     void remap();
     void remap_page(size_t index);
 
+    // These take a page index into the VMObject, and do nothing if this region doesn't map it.
+    // The swapper uses them to find cold pages and to unmap the ones it takes away.
+    bool test_and_clear_accessed(size_t vmobject_page_index);
+    void remap_vmobject_page(size_t vmobject_page_index);
+
     // For InlineLinkedListNode
     Region* m_next { nullptr };
     Region* m_prev { nullptr };
@@ -163,6 +173,9 @@ public:
 private:
     Bitmap& ensure_cow_map() const;
 
+    bool covers_large_page(size_t page_index) const;
+    bool can_map_as_large_page(size_t page_index) const;
+
     void set_access_bit(Access access, bool b)
     {
         if (b)
@@ -174,6 +187,10 @@ private:
     PageFaultResponse handle_cow_fault(size_t page_index);
     PageFaultResponse handle_inode_fault(size_t page_index);
     PageFaultResponse handle_zero_fault(size_t page_index);
+    PageFaultResponse handle_swap_in_fault(size_t page_index);
+
+    void fault_around(size_t page_index);
+    void precommit_after_zero_fault(size_t page_index);
 
     void map_individual_page_impl(size_t page_index);
 
@@ -189,6 +206,7 @@ private:
     bool m_stack : 1 { false };
     bool m_mmap : 1 { false };
     mutable OwnPtr<Bitmap> m_cow_map;
+    size_t m_next_sequential_zero_fault { 0 };
 };
 
 }
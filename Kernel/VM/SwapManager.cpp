@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/AnonymousVMObject.h>
+#include <Kernel/VM/MemoryManager.h>
+#include <Kernel/VM/SwapManager.h>
+
+//#define SWAP_DEBUG
+
+namespace Kernel {
+
+static constexpr size_t words_per_page = PAGE_SIZE / sizeof(u32);
+
+// Pages are compressed as a sequence of tokens, each a u16 header followed by data.
+// If the top bit of the header is set, the low bits count the repetitions of the one
+// u32 that follows. Otherwise they count the literal u32s that follow.
+static constexpr u16 run_token_bit = 0x8000;
+
+static size_t compress_page(const u8* page_data, u8* output, size_t output_capacity)
+{
+    auto* words = (const u32*)page_data;
+    size_t out = 0;
+
+    auto emit = [&](const void* data, size_t size) {
+        if (out + size > output_capacity)
+            return false;
+        memcpy(output + out, data, size);
+        out += size;
+        return true;
+    };
+
+    size_t i = 0;
+    while (i < words_per_page) {
+        size_t run_length = 1;
+        while (i + run_length < words_per_page && words[i + run_length] == words[i])
+            ++run_length;
+        if (run_length >= 2) {
+            u16 header = run_token_bit | run_length;
+            if (!emit(&header, sizeof(header)) || !emit(&words[i], sizeof(u32)))
+                return 0;
+            i += run_length;
+            continue;
+        }
+        // Collect literals until the next run starts.
+        size_t literal_count = 1;
+        while (i + literal_count < words_per_page) {
+            size_t next = i + literal_count;
+            if (next + 1 < words_per_page && words[next] == words[next + 1])
+                break;
+            ++literal_count;
+        }
+        u16 header = literal_count;
+        if (!emit(&header, sizeof(header)) || !emit(&words[i], literal_count * sizeof(u32)))
+            return 0;
+        i += literal_count;
+    }
+    return out;
+}
+
+static bool decompress_page(const u8* input, size_t input_size, u8* page_data)
+{
+    auto* words = (u32*)page_data;
+    size_t in = 0;
+    size_t i = 0;
+    while (in < input_size) {
+        if (in + sizeof(u16) > input_size)
+            return false;
+        u16 header;
+        memcpy(&header, input + in, sizeof(header));
+        in += sizeof(header);
+        size_t count = header & ~run_token_bit;
+        if (i + count > words_per_page)
+            return false;
+        if (header & run_token_bit) {
+            if (in + sizeof(u32) > input_size)
+                return false;
+            u32 value;
+            memcpy(&value, input + in, sizeof(value));
+            in += sizeof(value);
+            for (size_t j = 0; j < count; ++j)
+                words[i++] = value;
+        } else {
+            if (in + count * sizeof(u32) > input_size)
+                return false;
+            memcpy(&words[i], input + in, count * sizeof(u32));
+            in += count * sizeof(u32);
+            i += count;
+        }
+    }
+    return i == words_per_page;
+}
+
+static bool is_same_filled(const u8* page_data, u32& fill_value)
+{
+    auto* words = (const u32*)page_data;
+    for (size_t i = 1; i < words_per_page; ++i) {
+        if (words[i] != words[0])
+            return false;
+    }
+    fill_value = words[0];
+    return true;
+}
+
+SwapEntry::~SwapEntry()
+{
+    SwapManager::the().entry_will_be_destroyed(*this);
+}
+
+SwapManager& SwapManager::the()
+{
+    static SwapManager* the;
+    if (!the)
+        the = new SwapManager;
+    return *the;
+}
+
+SwapManager::SwapManager()
+{
+    // Each pool page holds two entries. Don't let the pool grow past an eighth of memory.
+    m_pool_limit = MM.user_physical_pages() / 8 * 2;
+}
+
+KResult SwapManager::swapon(NonnullRefPtr<FileDescription> description)
+{
+    if (m_disk)
+        return KResult(-EBUSY);
+    auto* inode = description->inode();
+    if (!inode || !inode->metadata().is_regular_file())
+        return KResult(-EINVAL);
+    size_t slot_count = inode->size() / PAGE_SIZE;
+    if (!slot_count)
+        return KResult(-EINVAL);
+
+    m_disk_slots = make<Bitmap>(slot_count, false);
+    m_disk = move(description);
+    klog() << "Swap: Using " << m_disk->absolute_path() << " with " << slot_count << " slots";
+    return KSuccess;
+}
+
+Optional<u32> SwapManager::allocate_disk_slot()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (!m_disk_slots)
+        return {};
+    auto slot = m_disk_slots->find_first_unset();
+    if (!slot.has_value())
+        return {};
+    m_disk_slots->set(slot.value(), true);
+    ++m_disk_slots_used;
+    return slot.value();
+}
+
+void SwapManager::free_disk_slot(u32 slot)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(m_disk_slots->get(slot));
+    m_disk_slots->set(slot, false);
+    --m_disk_slots_used;
+}
+
+bool SwapManager::write_disk_slot(u32 slot, const u8* data)
+{
+    LOCKER(m_disk_lock);
+    auto nwritten = m_disk->inode()->write_bytes((off_t)slot * PAGE_SIZE, PAGE_SIZE, data, m_disk.ptr());
+    if (nwritten != PAGE_SIZE) {
+        klog() << "Swap: Failed to write slot " << slot << " (" << nwritten << ")";
+        return false;
+    }
+    return true;
+}
+
+bool SwapManager::read_disk_slot(u32 slot, u8* data)
+{
+    LOCKER(m_disk_lock);
+    auto nread = m_disk->inode()->read_bytes((off_t)slot * PAGE_SIZE, PAGE_SIZE, data, m_disk.ptr());
+    if (nread != PAGE_SIZE) {
+        klog() << "Swap: Failed to read slot " << slot << " (" << nread << ")";
+        return false;
+    }
+    return true;
+}
+
+RefPtr<SwapEntry> SwapManager::store_in_memory(const u8* page_data)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    u32 fill_value;
+    if (is_same_filled(page_data, fill_value)) {
+        auto entry = adopt(*new SwapEntry);
+        entry->m_kind = SwapEntry::Kind::Filled;
+        entry->m_fill_value = fill_value;
+        ++m_filled_entries;
+        return entry;
+    }
+
+    // Pages that don't fit in half a page aren't worth keeping in memory.
+    size_t compressed_size = compress_page(page_data, m_compressed_buffer, sizeof(m_compressed_buffer));
+    if (!compressed_size)
+        return nullptr;
+    return store_in_pool(compressed_size);
+}
+
+RefPtr<SwapEntry> SwapManager::store_in_pool(size_t compressed_size)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (m_pool_entries >= m_pool_limit)
+        return nullptr;
+
+    RefPtr<PhysicalPage> pool_page;
+    u16 offset;
+    if (m_open_pool_page) {
+        pool_page = move(m_open_pool_page);
+        offset = PAGE_SIZE / 2;
+    } else {
+        pool_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (!pool_page)
+            return nullptr;
+        m_open_pool_page = pool_page;
+        offset = 0;
+    }
+
+    u8* pool_data = MM.quickmap_page(*pool_page);
+    memcpy(pool_data + offset, m_compressed_buffer, compressed_size);
+    MM.unquickmap_page();
+
+    auto entry = adopt(*new SwapEntry);
+    entry->m_kind = SwapEntry::Kind::Pool;
+    entry->m_pool_page = move(pool_page);
+    entry->m_pool_offset = offset;
+    entry->m_compressed_size = compressed_size;
+    m_pool_lru.append(entry.ptr());
+    ++m_pool_entries;
+    m_pool_bytes += compressed_size;
+    return entry;
+}
+
+void SwapManager::release_pool_storage(SwapEntry& entry)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(entry.m_kind == SwapEntry::Kind::Pool);
+    m_pool_lru.remove(&entry);
+    --m_pool_entries;
+    m_pool_bytes -= entry.m_compressed_size;
+    // The pool page goes back to the freelist once both of its halves are released.
+    entry.m_pool_page = nullptr;
+}
+
+void SwapManager::entry_will_be_destroyed(SwapEntry& entry)
+{
+    InterruptDisabler disabler;
+    switch (entry.m_kind) {
+    case SwapEntry::Kind::Filled:
+        --m_filled_entries;
+        break;
+    case SwapEntry::Kind::Pool:
+        release_pool_storage(entry);
+        break;
+    case SwapEntry::Kind::Disk:
+        free_disk_slot(entry.m_disk_slot);
+        break;
+    }
+}
+
+bool SwapManager::load_from_memory(SwapEntry& entry, u8* destination)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (entry.m_kind == SwapEntry::Kind::Filled) {
+        auto* words = (u32*)destination;
+        for (size_t i = 0; i < words_per_page; ++i)
+            words[i] = entry.m_fill_value;
+        return true;
+    }
+    ASSERT(entry.m_kind == SwapEntry::Kind::Pool);
+    return decompress_page(m_compressed_buffer, entry.m_compressed_size, destination);
+}
+
+bool SwapManager::load(SwapEntry& entry, PhysicalPage& physical_page)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (entry.m_kind == SwapEntry::Kind::Pool) {
+        // Only one page can be quickmapped at a time, so get the compressed data out first.
+        u8* pool_data = MM.quickmap_page(*entry.m_pool_page);
+        memcpy(m_compressed_buffer, pool_data + entry.m_pool_offset, entry.m_compressed_size);
+        MM.unquickmap_page();
+    }
+
+    if (entry.m_kind != SwapEntry::Kind::Disk) {
+        u8* page_data = MM.quickmap_page(physical_page);
+        bool success = load_from_memory(entry, page_data);
+        MM.unquickmap_page();
+        if (!success)
+            klog() << "Swap: Corrupted pool entry " << &entry;
+        return success;
+    }
+
+    auto buffer = ByteBuffer::create_uninitialized(PAGE_SIZE);
+    sti();
+    bool success = read_disk_slot(entry.m_disk_slot, buffer.data());
+    cli();
+    if (!success)
+        return false;
+    u8* page_data = MM.quickmap_page(physical_page);
+    memcpy(page_data, buffer.data(), PAGE_SIZE);
+    MM.unquickmap_page();
+    return true;
+}
+
+void SwapManager::write_back_oldest_pool_entries(size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        RefPtr<SwapEntry> entry;
+        Optional<u32> slot;
+        {
+            InterruptDisabler disabler;
+            if (m_pool_lru.is_empty())
+                return;
+            slot = allocate_disk_slot();
+            if (!slot.has_value())
+                return;
+            entry = m_pool_lru.head();
+            u8* pool_data = MM.quickmap_page(*entry->m_pool_page);
+            memcpy(m_compressed_buffer, pool_data + entry->m_pool_offset, entry->m_compressed_size);
+            MM.unquickmap_page();
+            if (!load_from_memory(*entry, m_page_buffer)) {
+                free_disk_slot(slot.value());
+                return;
+            }
+        }
+
+        bool success = write_disk_slot(slot.value(), m_page_buffer);
+
+        InterruptDisabler disabler;
+        if (!success) {
+            free_disk_slot(slot.value());
+            return;
+        }
+        // If everybody else let go of the entry while we were writing, this frees the slot again.
+        release_pool_storage(*entry);
+        entry->m_kind = SwapEntry::Kind::Disk;
+        entry->m_disk_slot = slot.value();
+        ++m_writebacks;
+    }
+}
+
+size_t SwapManager::swap_out_cold_pages(size_t target)
+{
+    // Make room in the pool by moving its oldest entries out to disk.
+    if (m_disk && m_pool_entries + target > m_pool_limit)
+        write_back_oldest_pool_entries(m_pool_entries + target - m_pool_limit);
+
+    Vector<NonnullRefPtr<AnonymousVMObject>> vmobjects;
+    {
+        InterruptDisabler disabler;
+        MM.for_each_vmobject([&](auto& vmobject) {
+            if (vmobject.is_anonymous() && !vmobject.is_purgeable())
+                vmobjects.append(static_cast<AnonymousVMObject&>(vmobject));
+            return IterationDecision::Continue;
+        });
+    }
+
+    // Pick up where the last scan left off, so that everybody's pages get their turn.
+    size_t freed = 0;
+    for (size_t i = 0; i < vmobjects.size() && freed < target; ++i) {
+        auto& vmobject = vmobjects[(m_scan_cursor + i) % vmobjects.size()];
+        freed += swap_out_cold_pages(vmobject, target - freed);
+        if (freed < target)
+            ++m_scan_cursor;
+    }
+
+#ifdef SWAP_DEBUG
+    dbg() << "Swap: Swapped out " << freed << " pages, " << m_pool_entries << " in pool, " << m_disk_slots_used << " on disk";
+#endif
+    return freed;
+}
+
+size_t SwapManager::swap_out_cold_pages(AnonymousVMObject& vmobject, size_t target)
+{
+    LOCKER(vmobject.m_paging_lock);
+
+    {
+        // Kernel memory has to stay put, and so does anything the kernel has mapped.
+        // Stacks stay put too: signal delivery writes to them from inside the scheduler,
+        // where we can't take a page fault that has to go to swap.
+        InterruptDisabler disabler;
+        bool swappable = false;
+        bool pinned = false;
+        vmobject.for_each_region([&](auto& region) {
+            if (region.is_user_accessible() && is_user_address(region.vaddr()) && !region.is_stack())
+                swappable = true;
+            else
+                pinned = true;
+        });
+        if (!swappable || pinned)
+            return 0;
+    }
+
+    size_t freed = 0;
+    for (size_t i = 0; i < vmobject.page_count() && freed < target; ++i) {
+        RefPtr<PhysicalPage> evicted_page;
+        RefPtr<SwapEntry> entry;
+        {
+            InterruptDisabler disabler;
+            auto& physical_page = vmobject.physical_pages()[i];
+            // Pages shared with a fork()ed process are left alone; they're copy-on-write.
+            if (!physical_page || physical_page->is_shared_zero_page() || physical_page->ref_count() != 1 || !physical_page->may_return_to_freelist())
+                continue;
+
+            // Second chance: anything that has been touched since the last scan stays.
+            bool accessed = false;
+            vmobject.for_each_region([&](auto& region) {
+                if (region.test_and_clear_accessed(i))
+                    accessed = true;
+            });
+            if (accessed)
+                continue;
+
+            u8* page_data = MM.quickmap_page(*physical_page);
+            memcpy(m_page_buffer, page_data, PAGE_SIZE);
+            MM.unquickmap_page();
+
+            entry = store_in_memory(m_page_buffer);
+            if (!entry) {
+                auto slot = allocate_disk_slot();
+                if (!slot.has_value())
+                    continue;
+                entry = adopt(*new SwapEntry);
+                entry->m_kind = SwapEntry::Kind::Disk;
+                entry->m_disk_slot = slot.value();
+            }
+
+            // Unmap the page everywhere. Anyone who faults on it now has to wait for
+            // the paging lock, which we hold until it's safely on disk.
+            evicted_page = move(physical_page);
+            vmobject.set_swap_entry(i, *entry);
+            vmobject.for_each_region([&](auto& region) {
+                region.remap_vmobject_page(i);
+            });
+        }
+
+        if (entry->kind() == SwapEntry::Kind::Disk && !write_disk_slot(entry->m_disk_slot, m_page_buffer)) {
+            InterruptDisabler disabler;
+            vmobject.physical_pages()[i] = move(evicted_page);
+            vmobject.clear_swap_entry(i);
+            vmobject.for_each_region([&](auto& region) {
+                region.remap_vmobject_page(i);
+            });
+            break;
+        }
+
+        ++m_swap_outs;
+        ++freed;
+    }
+    return freed;
+}
+
+}
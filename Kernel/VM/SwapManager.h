@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/InlineLinkedList.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Heap/SlabAllocator.h>
+#include <Kernel/KResult.h>
+#include <Kernel/Lock.h>
+#include <Kernel/VM/PhysicalPage.h>
+
+namespace Kernel {
+
+class AnonymousVMObject;
+class FileDescription;
+
+// The contents of one swapped-out page of anonymous memory.
+// Entries are shared between the copies of a VMObject made by fork(),
+// and give back their storage once the last one is gone.
+class SwapEntry : public RefCounted<SwapEntry>
+    , public InlineLinkedListNode<SwapEntry> {
+    MAKE_SLAB_ALLOCATED(SwapEntry)
+public:
+    enum class Kind : u8 {
+        // Every word of the page had the same value, so there is nothing to store.
+        Filled,
+        // Compressed into one half of a page in the in-memory pool.
+        Pool,
+        // Written out to a slot in the swap file.
+        Disk,
+    };
+
+    ~SwapEntry();
+
+    Kind kind() const { return m_kind; }
+
+    // For InlineLinkedListNode.
+    SwapEntry* m_next { nullptr };
+    SwapEntry* m_prev { nullptr };
+
+private:
+    friend class SwapManager;
+    SwapEntry() {}
+
+    Kind m_kind { Kind::Filled };
+    u32 m_fill_value { 0 };
+    RefPtr<PhysicalPage> m_pool_page;
+    u16 m_pool_offset { 0 };
+    u16 m_compressed_size { 0 };
+    u32 m_disk_slot { 0 };
+};
+
+class SwapManager {
+    AK_MAKE_ETERNAL
+public:
+    static SwapManager& the();
+
+    // Adds a swap file as the second tier behind the compressed pool.
+    KResult swapon(NonnullRefPtr<FileDescription>);
+    bool has_disk() const { return m_disk; }
+
+    // Called by the reclaim daemon. Returns the number of physical pages freed.
+    size_t swap_out_cold_pages(size_t target);
+
+    // Reads a swapped-out page back into a physical page. Might block if it has to go to disk.
+    bool load(SwapEntry&, PhysicalPage&);
+
+    void did_swap_in() { ++m_swap_ins; }
+
+    unsigned swap_ins() const { return m_swap_ins; }
+    unsigned swap_outs() const { return m_swap_outs; }
+    unsigned writebacks() const { return m_writebacks; }
+    size_t pool_entries() const { return m_pool_entries; }
+    size_t pool_bytes() const { return m_pool_bytes; }
+    size_t filled_entries() const { return m_filled_entries; }
+    size_t disk_slots_used() const { return m_disk_slots_used; }
+    size_t disk_slots_total() const { return m_disk_slots ? m_disk_slots->size() : 0; }
+
+private:
+    friend class SwapEntry;
+    SwapManager();
+
+    size_t swap_out_cold_pages(AnonymousVMObject&, size_t target);
+    RefPtr<SwapEntry> store_in_memory(const u8* page_data);
+    RefPtr<SwapEntry> store_in_pool(size_t compressed_size);
+    bool load_from_memory(SwapEntry&, u8* destination);
+    void release_pool_storage(SwapEntry&);
+    Optional<u32> allocate_disk_slot();
+    void free_disk_slot(u32);
+    bool write_disk_slot(u32, const u8*);
+    bool read_disk_slot(u32, u8*);
+    void write_back_oldest_pool_entries(size_t count);
+    void entry_will_be_destroyed(SwapEntry&);
+
+    RefPtr<FileDescription> m_disk;
+    OwnPtr<Bitmap> m_disk_slots;
+    Lock m_disk_lock { "SwapDisk" };
+
+    // Pool pages are split in two halves; this is the page whose second half is still free.
+    RefPtr<PhysicalPage> m_open_pool_page;
+    InlineLinkedList<SwapEntry> m_pool_lru;
+    size_t m_pool_limit { 0 };
+
+    size_t m_scan_cursor { 0 };
+
+    // The page being swapped out; only ever touched by the reclaim daemon.
+    u8 m_page_buffer[PAGE_SIZE];
+    // Compression output and decompression input. Only used with interrupts disabled.
+    u8 m_compressed_buffer[PAGE_SIZE / 2];
+
+    unsigned m_swap_ins { 0 };
+    unsigned m_swap_outs { 0 };
+    unsigned m_writebacks { 0 };
+    size_t m_pool_entries { 0 };
+    size_t m_pool_bytes { 0 };
+    size_t m_filled_entries { 0 };
+    size_t m_disk_slots_used { 0 };
+};
+
+}
@@ -43,6 +43,7 @@ class VMObject : public RefCounted<VMObject>
     , public InlineLinkedListNode<VMObject> {
     friend class MemoryManager;
     friend class Region;
+    friend class SwapManager;
 
 public:
     virtual ~VMObject();
@@ -50,12 +50,18 @@ mknod mnt/dev/null c 1 3
 mknod mnt/dev/zero c 1 5
 mknod mnt/dev/full c 1 7
 mknod mnt/dev/debuglog c 1 18
+mknod mnt/dev/mempressure c 1 19
+mknod mnt/dev/profile c 1 20
+mknod mnt/dev/kmsg c 1 11
 # random, is failing (randomly) on fuse-ext2 on macos :)
 chmod 666 mnt/dev/random || true 
 chmod 666 mnt/dev/null
 chmod 666 mnt/dev/zero
 chmod 666 mnt/dev/full
 chmod 666 mnt/dev/debuglog
+chmod 444 mnt/dev/mempressure
+chmod 400 mnt/dev/profile
+chmod 400 mnt/dev/kmsg
 mknod mnt/dev/keyboard c 85 1
 chmod 440 mnt/dev/keyboard
 chown 0:$phys_gid mnt/dev/keyboard
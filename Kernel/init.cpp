@@ -42,12 +42,15 @@
 #include <Kernel/Devices/EBRPartitionTable.h>
 #include <Kernel/Devices/FullDevice.h>
 #include <Kernel/Devices/GPTPartitionTable.h>
+#include <Kernel/Devices/KernelLogDevice.h>
 #include <Kernel/Devices/KeyboardDevice.h>
 #include <Kernel/Devices/MBRPartitionTable.h>
 #include <Kernel/Devices/MBVGADevice.h>
+#include <Kernel/Devices/MemoryPressureDevice.h>
 #include <Kernel/Devices/NullDevice.h>
 #include <Kernel/Devices/PATAChannel.h>
 #include <Kernel/Devices/PS2MouseDevice.h>
+#include <Kernel/Devices/ProfileDevice.h>
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/Devices/SB16.h>
 #include <Kernel/Devices/SerialDevice.h>
@@ -55,12 +58,12 @@
 #include <Kernel/Devices/ZeroDevice.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
-#include <Kernel/Heap/SlabAllocator.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/Interrupts/PIC.h>
 #include <Kernel/KParams.h>
+#include <Kernel/KernelLog.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkTask.h>
@@ -99,7 +102,6 @@ extern "C" [[noreturn]] void init()
     cpu_setup();
 
     kmalloc_init();
-    slab_alloc_init();
 
     new KParams(String(reinterpret_cast<const char*>(low_physical_to_virtual(multiboot_info_ptr->cmdline))));
 
@@ -133,6 +135,8 @@ extern "C" [[noreturn]] void init()
 
     new SB16;
     new NullDevice;
+    // reclaimd (spawned below) waits on this, so it has to exist before init_stage2.
+    new MemoryPressureDevice;
     if (!get_serial_debug())
         new SerialDevice(SERIAL_COM1_ADDR, 64);
     new SerialDevice(SERIAL_COM2_ADDR, 65);
@@ -171,6 +175,12 @@ extern "C" [[noreturn]] void init()
     Thread* init_stage2_thread = nullptr;
     Process::create_kernel_process(init_stage2_thread, "init_stage2", init_stage2);
 
+    Thread* console_flush_thread = nullptr;
+    Process::create_kernel_process(console_flush_thread, "VirtualConsole", VirtualConsole::flush_thread_main);
+
+    Thread* kernel_log_thread = nullptr;
+    Process::create_kernel_process(kernel_log_thread, "KernelLog", KernelLog::drain_thread_main);
+
     Thread* syncd_thread = nullptr;
     Process::create_kernel_process(syncd_thread, "syncd", [] {
         for (;;) {
@@ -179,6 +189,14 @@ extern "C" [[noreturn]] void init()
         }
     });
 
+    Thread* reclaimd_thread = nullptr;
+    Process::create_kernel_process(reclaimd_thread, "reclaimd", [] {
+        for (;;) {
+            MM.wait_for_memory_pressure();
+            MM.reclaim();
+        }
+    });
+
     Process::create_kernel_process(g_finalizer, "Finalizer", [] {
         Thread::current->set_priority(THREAD_PRIORITY_LOW);
         for (;;) {
@@ -190,6 +208,7 @@ extern "C" [[noreturn]] void init()
                 g_finalizer_has_work = false;
             }
             Thread::finalize_dying_threads();
+            kmalloc_grow_if_needed();
         }
     });
 
@@ -208,6 +227,8 @@ void init_stage2()
     new ZeroDevice;
     new FullDevice;
     new RandomDevice;
+    new ProfileDevice;
+    new KernelLogDevice;
     new PTYMultiplexer;
 
     bool dmi_unreliable = KParams::the().has("dmi_unreliable");
@@ -219,6 +240,7 @@ void init_stage2()
 
     bool text_debug = KParams::the().has("text_debug");
     bool force_pio = KParams::the().has("force_pio");
+    bool no_block_read_cache = KParams::the().has("no_block_read_cache");
 
     auto root = KParams::the().get("root");
     if (root.is_empty()) {
@@ -231,6 +253,11 @@ void init_stage2()
     }
 
     auto pata0 = PATAChannel::create(PATAChannel::ChannelType::Primary, force_pio);
+    if (!no_block_read_cache) {
+        pata0->master_device()->enable_read_cache();
+        if (pata0->slave_device())
+            pata0->slave_device()->enable_read_cache();
+    }
     NonnullRefPtr<BlockDevice> root_dev = *pata0->master_device();
 
     root = root.substring(strlen("/dev/hda"), root.length() - strlen("/dev/hda"));
@@ -28,6 +28,10 @@
 #include <LibBareMetal/Output/Console.h>
 #include <LibBareMetal/Output/kstdio.h>
 
+#if defined(KERNEL)
+#    include <Kernel/KernelLog.h>
+#endif
+
 // Bytes output to 0xE9 end up on the Bochs console. It's very handy.
 #define CONSOLE_OUT_TO_E9
 
@@ -75,8 +79,8 @@ ssize_t Console::write(Kernel::FileDescription&, const u8* data, ssize_t size)
         return 0;
     if (!m_implementation)
         return 0;
-    for (ssize_t i = 0; i < size; ++i)
-        put_char(data[i]);
+    // Goes into the kernel log like everything else, so it shows up in dmesg too.
+    Kernel::KernelLog::write(Kernel::LogLevel::Info, (const char*)data, size);
     return size;
 }
 #endif
@@ -87,11 +91,16 @@ void Console::put_char(char ch)
     //if (ch != 27)
     IO::out8(0xe9, ch);
 #endif
-    m_logbuffer.enqueue(ch);
     if (m_implementation)
         m_implementation->on_sysconsole_receive(ch);
 }
 
+void Console::flush()
+{
+    if (m_implementation)
+        m_implementation->flush();
+}
+
 ConsoleImplementation::~ConsoleImplementation()
 {
 }
@@ -26,7 +26,6 @@
 
 #pragma once
 
-#include <AK/CircularQueue.h>
 #include <AK/Vector.h>
 #if defined(KERNEL)
 #    include <Kernel/Devices/CharacterDevice.h>
@@ -36,6 +35,9 @@ class ConsoleImplementation {
 public:
     virtual ~ConsoleImplementation();
     virtual void on_sysconsole_receive(u8) = 0;
+
+    // Get everything received so far onto the screen right now.
+    virtual void flush() {}
 };
 
 #if defined(KERNEL)
@@ -69,10 +71,8 @@ public:
     }
 
     void put_char(char);
-
-    const CircularQueue<char, 16384>& logbuffer() const { return m_logbuffer; }
+    void flush();
 
 private:
     ConsoleImplementation* m_implementation { nullptr };
-    CircularQueue<char, 16384> m_logbuffer;
 };
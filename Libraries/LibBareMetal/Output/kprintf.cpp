@@ -33,6 +33,7 @@
 #include <LibC/stdarg.h>
 
 #if defined(KERNEL)
+#    include <Kernel/KernelLog.h>
 #    include <Kernel/Process.h>
 #endif
 
@@ -48,6 +49,7 @@ int get_serial_debug()
     return serial_debug;
 }
 
+#if !defined(KERNEL)
 static void color_on()
 {
     IO::out8(0xe9, 0x1b);
@@ -64,6 +66,7 @@ static void color_off()
     IO::out8(0xe9, '0');
     IO::out8(0xe9, 'm');
 }
+#endif
 
 static void serial_putch(char ch)
 {
@@ -110,13 +113,53 @@ static void console_out(char ch)
     }
 }
 
+#if defined(KERNEL)
+struct LogLineBuffer {
+    Kernel::LogLevel level;
+    char characters[128];
+    int length { 0 };
+
+    void flush()
+    {
+        if (length)
+            Kernel::KernelLog::write(level, characters, length);
+        length = 0;
+    }
+};
+
+static void log_line_putch(char*& bufptr, char ch)
+{
+    auto& line = *reinterpret_cast<LogLineBuffer*>(bufptr);
+    if (line.length == (int)sizeof(line.characters))
+        line.flush();
+    line.characters[line.length++] = ch;
+}
+
+static int log_printf(Kernel::LogLevel level, const char* fmt, va_list ap)
+{
+    LogLineBuffer line;
+    line.level = level;
+    char* bufptr = reinterpret_cast<char*>(&line);
+    int ret = printf_internal(log_line_putch, bufptr, fmt, ap);
+    line.flush();
+    return ret;
+}
+#else
 static void console_putch(char*&, char ch)
 {
     console_out(ch);
 }
+#endif
 
 int kprintf(const char* fmt, ...)
 {
+#if defined(KERNEL)
+    va_list ap;
+    va_start(ap, fmt);
+    int ret = log_printf(Kernel::LogLevel::Info, fmt, ap);
+    va_end(ap);
+    return ret;
+#else
     color_on();
     va_list ap;
     va_start(ap, fmt);
@@ -124,6 +167,7 @@ int kprintf(const char* fmt, ...)
     va_end(ap);
     color_off();
     return ret;
+#endif
 }
 
 static void buffer_putch(char*& bufptr, char ch)
@@ -148,17 +192,23 @@ static void debugger_out(char ch)
     IO::out8(0xe9, ch);
 }
 
+#if !defined(KERNEL)
 static void debugger_putch(char*&, char ch)
 {
     debugger_out(ch);
 }
+#endif
 
 extern "C" int dbgputstr(const char* characters, int length)
 {
     if (!characters)
         return 0;
+#if defined(KERNEL)
+    Kernel::KernelLog::write(Kernel::LogLevel::Debug, characters, length);
+#else
     for (int i = 0; i < length; ++i)
         debugger_out(characters[i]);
+#endif
     return 0;
 }
 
@@ -166,13 +216,24 @@ extern "C" int kernelputstr(const char* characters, int length)
 {
     if (!characters)
         return 0;
+#if defined(KERNEL)
+    Kernel::KernelLog::write(Kernel::LogLevel::Info, characters, length);
+#else
     for (int i = 0; i < length; ++i)
         console_out(characters[i]);
+#endif
     return 0;
 }
 
 extern "C" int dbgprintf(const char* fmt, ...)
 {
+#if defined(KERNEL)
+    va_list ap;
+    va_start(ap, fmt);
+    int ret = log_printf(Kernel::LogLevel::Debug, fmt, ap);
+    va_end(ap);
+    return ret;
+#else
     color_on();
     va_list ap;
     va_start(ap, fmt);
@@ -180,4 +241,17 @@ extern "C" int dbgprintf(const char* fmt, ...)
     va_end(ap);
     color_off();
     return ret;
+#endif
+}
+
+#if defined(KERNEL)
+void kernel_log_emit(const char* characters, int length, bool to_console)
+{
+    for (int i = 0; i < length; ++i) {
+        if (to_console)
+            console_out(characters[i]);
+        else
+            debugger_out(characters[i]);
+    }
 }
+#endif
@@ -48,6 +48,12 @@ int get_serial_debug();
 
 #ifdef __cplusplus
 
+#    if defined(KERNEL)
+// Puts already logged kernel messages out on the debugger port, the serial port (if enabled)
+// and, if to_console is set, the console.
+void kernel_log_emit(const char*, int, bool to_console);
+#    endif
+
 template<size_t N>
 inline int dbgputstr(const char (&array)[N])
 {
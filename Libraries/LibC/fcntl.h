@@ -36,6 +36,8 @@ __BEGIN_DECLS
 #define F_SETFD 2
 #define F_GETFL 3
 #define F_SETFL 4
+#define F_SETPIPE_SZ 1031
+#define F_GETPIPE_SZ 1032
 
 #define FD_CLOEXEC 1
 
@@ -107,4 +109,10 @@ struct flock {
     pid_t l_pid;
 };
 
+#define SPLICE_F_MOVE 1
+#define SPLICE_F_NONBLOCK 2
+#define SPLICE_F_MORE 4
+
+ssize_t splice(int in_fd, off_t* in_offset, int out_fd, off_t* out_offset, size_t count, unsigned flags);
+
 __END_DECLS
@@ -37,6 +37,7 @@
 #    define MAXPATHLEN PATH_MAX
 #endif
 #define PIPE_BUF 4096
+#define IOV_MAX 1024
 
 #define INT_MAX INT32_MAX
 #define INT_MIN INT32_MIN
@@ -27,6 +27,7 @@
 #include <Kernel/Syscall.h>
 #include <errno.h>
 #include <serenity.h>
+#include <string.h>
 
 extern "C" {
 
@@ -85,6 +86,13 @@ int perf_event(int type, uintptr_t arg1, FlatPtr arg2)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+int perf_register_tracepoint(uint32_t id, const char* name)
+{
+    Syscall::StringArgument string { name, strlen(name) };
+    int rc = syscall(SC_perf_event, PERF_EVENT_TRACEPOINT_NAME, id, &string);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 void* shbuf_get(int shbuf_id, size_t* size)
 {
     int rc = syscall(SC_shbuf_get, shbuf_id, size);
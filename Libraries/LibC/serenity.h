@@ -65,8 +65,13 @@ int purge(int mode);
 
 #define PERF_EVENT_MALLOC 1
 #define PERF_EVENT_FREE 2
+#define PERF_EVENT_TRACEPOINT_NAME 3
+#define PERF_EVENT_TRACE_BEGIN 4
+#define PERF_EVENT_TRACE_END 5
+#define PERF_EVENT_TRACE_INSTANT 6
 
 int perf_event(int type, uintptr_t arg1, uintptr_t arg2);
+int perf_register_tracepoint(uint32_t id, const char* name);
 
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size);
 
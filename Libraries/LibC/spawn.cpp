@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <Kernel/Syscall.h>
+#include <alloca.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+
+struct __posix_spawn_file_action {
+    enum Type {
+        Close,
+        Dup2,
+        Open,
+    };
+    Type type;
+    int fd;
+    int old_fd;
+    int flags;
+    mode_t mode;
+    char* path;
+};
+
+static int spawn_with_syscall(pid_t* out_pid, const char* path, char* const argv[], char* const envp[])
+{
+    size_t arg_count = 0;
+    for (size_t i = 0; argv[i]; ++i)
+        ++arg_count;
+
+    size_t env_count = 0;
+    for (size_t i = 0; envp[i]; ++i)
+        ++env_count;
+
+    auto copy_strings = [&](auto& vec, size_t count, auto& output) {
+        output.length = count;
+        for (size_t i = 0; vec[i]; ++i) {
+            output.strings[i].characters = vec[i];
+            output.strings[i].length = strlen(vec[i]);
+        }
+    };
+
+    Syscall::SC_spawn_params params;
+    params.arguments.strings = (Syscall::StringArgument*)alloca(arg_count * sizeof(Syscall::StringArgument));
+    params.environment.strings = (Syscall::StringArgument*)alloca(env_count * sizeof(Syscall::StringArgument));
+
+    params.path = { path, strlen(path) };
+    copy_strings(argv, arg_count, params.arguments);
+    copy_strings(envp, env_count, params.environment);
+
+    int rc = syscall(SC_spawn, &params);
+    if (rc < 0)
+        return -rc;
+    if (out_pid)
+        *out_pid = rc;
+    return 0;
+}
+
+[[noreturn]] static void run_in_forked_child(const char* path, bool search_path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    if (attr) {
+        short flags = attr->flags;
+        if ((flags & POSIX_SPAWN_SETPGROUP) && setpgid(0, attr->pgroup) < 0)
+            _exit(127);
+        if ((flags & POSIX_SPAWN_RESETIDS) && (setgid(getgid()) < 0 || setuid(getuid()) < 0))
+            _exit(127);
+        if (flags & POSIX_SPAWN_SETSIGDEF) {
+            struct sigaction default_action;
+            memset(&default_action, 0, sizeof(default_action));
+            default_action.sa_handler = SIG_DFL;
+            for (int signal = 1; signal < NSIG; ++signal) {
+                if (sigismember(&attr->sigdefault, signal) && sigaction(signal, &default_action, nullptr) < 0)
+                    _exit(127);
+            }
+        }
+        if ((flags & POSIX_SPAWN_SETSIGMASK) && sigprocmask(SIG_SETMASK, &attr->sigmask, nullptr) < 0)
+            _exit(127);
+    }
+
+    if (file_actions) {
+        for (size_t i = 0; i < file_actions->count; ++i) {
+            auto& action = file_actions->actions[i];
+            switch (action.type) {
+            case __posix_spawn_file_action::Close:
+                if (close(action.fd) < 0)
+                    _exit(127);
+                break;
+            case __posix_spawn_file_action::Dup2:
+                if (dup2(action.old_fd, action.fd) < 0)
+                    _exit(127);
+                break;
+            case __posix_spawn_file_action::Open: {
+                int fd = open(action.path, action.flags, action.mode);
+                if (fd < 0)
+                    _exit(127);
+                if (fd != action.fd) {
+                    if (dup2(fd, action.fd) < 0)
+                        _exit(127);
+                    close(fd);
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    if (search_path)
+        execvpe(path, argv, envp);
+    else
+        execve(path, argv, envp);
+    _exit(127);
+}
+
+static int spawn_impl(pid_t* out_pid, const char* path, bool search_path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    bool has_file_actions = file_actions && file_actions->count;
+    bool has_attributes = attr && attr->flags;
+
+    // Without anything to set up in between, the kernel can create the child and exec() it
+    // directly, which avoids copying our address space just to throw it away.
+    if (!has_file_actions && !has_attributes) {
+        if (!search_path || strchr(path, '/'))
+            return spawn_with_syscall(out_pid, path, argv, envp);
+
+        String search = getenv("PATH");
+        if (search.is_empty())
+            search = "/bin:/usr/bin";
+        for (auto& part : search.split(':')) {
+            auto candidate = String::format("%s/%s", part.characters(), path);
+            int rc = spawn_with_syscall(out_pid, candidate.characters(), argv, envp);
+            if (rc != ENOENT)
+                return rc;
+        }
+        return ENOENT;
+    }
+
+    pid_t child = fork();
+    if (child < 0)
+        return errno;
+    if (!child)
+        run_in_forked_child(path, search_path, file_actions, attr, argv, envp);
+    if (out_pid)
+        *out_pid = child;
+    return 0;
+}
+
+int posix_spawn(pid_t* out_pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    return spawn_impl(out_pid, path, false, file_actions, attr, argv, envp ? envp : environ);
+}
+
+int posix_spawnp(pid_t* out_pid, const char* file, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    return spawn_impl(out_pid, file, true, file_actions, attr, argv, envp ? envp : environ);
+}
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t* file_actions)
+{
+    file_actions->actions = nullptr;
+    file_actions->count = 0;
+    file_actions->capacity = 0;
+    return 0;
+}
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t* file_actions)
+{
+    for (size_t i = 0; i < file_actions->count; ++i)
+        free(file_actions->actions[i].path);
+    free(file_actions->actions);
+    return posix_spawn_file_actions_init(file_actions);
+}
+
+static __posix_spawn_file_action* append_file_action(posix_spawn_file_actions_t* file_actions)
+{
+    if (file_actions->count == file_actions->capacity) {
+        size_t new_capacity = file_actions->capacity ? file_actions->capacity * 2 : 4;
+        auto* new_actions = (__posix_spawn_file_action*)realloc(file_actions->actions, new_capacity * sizeof(__posix_spawn_file_action));
+        if (!new_actions)
+            return nullptr;
+        file_actions->actions = new_actions;
+        file_actions->capacity = new_capacity;
+    }
+    auto* action = &file_actions->actions[file_actions->count++];
+    memset(action, 0, sizeof(*action));
+    return action;
+}
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t* file_actions, int fd)
+{
+    if (fd < 0)
+        return EBADF;
+    auto* action = append_file_action(file_actions);
+    if (!action)
+        return ENOMEM;
+    action->type = __posix_spawn_file_action::Close;
+    action->fd = fd;
+    return 0;
+}
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* file_actions, int old_fd, int new_fd)
+{
+    if (old_fd < 0 || new_fd < 0)
+        return EBADF;
+    auto* action = append_file_action(file_actions);
+    if (!action)
+        return ENOMEM;
+    action->type = __posix_spawn_file_action::Dup2;
+    action->old_fd = old_fd;
+    action->fd = new_fd;
+    return 0;
+}
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* file_actions, int fd, const char* path, int flags, mode_t mode)
+{
+    if (fd < 0)
+        return EBADF;
+    char* path_copy = strdup(path);
+    if (!path_copy)
+        return ENOMEM;
+    auto* action = append_file_action(file_actions);
+    if (!action) {
+        free(path_copy);
+        return ENOMEM;
+    }
+    action->type = __posix_spawn_file_action::Open;
+    action->fd = fd;
+    action->path = path_copy;
+    action->flags = flags;
+    action->mode = mode;
+    return 0;
+}
+
+int posix_spawnattr_init(posix_spawnattr_t* attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    return 0;
+}
+
+int posix_spawnattr_destroy(posix_spawnattr_t*)
+{
+    return 0;
+}
+
+int posix_spawnattr_getflags(const posix_spawnattr_t* attr, short* flags)
+{
+    *flags = attr->flags;
+    return 0;
+}
+
+int posix_spawnattr_setflags(posix_spawnattr_t* attr, short flags)
+{
+    if (flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK))
+        return EINVAL;
+    attr->flags = flags;
+    return 0;
+}
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t* attr, pid_t* pgroup)
+{
+    *pgroup = attr->pgroup;
+    return 0;
+}
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t* attr, pid_t pgroup)
+{
+    attr->pgroup = pgroup;
+    return 0;
+}
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t* attr, sigset_t* sigdefault)
+{
+    *sigdefault = attr->sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t* attr, const sigset_t* sigdefault)
+{
+    attr->sigdefault = *sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t* attr, sigset_t* sigmask)
+{
+    *sigmask = attr->sigmask;
+    return 0;
+}
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t* attr, const sigset_t* sigmask)
+{
+    attr->sigmask = *sigmask;
+    return 0;
+}
+}
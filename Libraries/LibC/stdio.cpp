@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -263,11 +264,9 @@ int putchar(int ch)
 
 int fputs(const char* s, FILE* stream)
 {
-    for (; *s; ++s) {
-        int rc = putc(*s, stream);
-        if (rc == EOF)
-            return EOF;
-    }
+    size_t length = strlen(s);
+    if (fwrite(s, 1, length, stream) < length)
+        return EOF;
     return 1;
 }
 
@@ -322,18 +321,72 @@ size_t fread(void* ptr, size_t size, size_t nmemb, FILE* stream)
     return nread / size;
 }
 
+// Writes out whatever is in the stream's buffer, followed by `size` bytes of `data`, using as few writev() calls as possible.
+static bool flush_buffer_and_write(FILE* stream, const u8* data, size_t size)
+{
+    iovec vecs[2] = {
+        { stream->buffer, stream->buffer_index },
+        { const_cast<u8*>(data), size },
+    };
+    stream->buffer_index = 0;
+    int first_vec = 0;
+    for (;;) {
+        while (first_vec < 2 && vecs[first_vec].iov_len == 0)
+            ++first_vec;
+        if (first_vec == 2)
+            return true;
+        ssize_t rc = writev(stream->fd, &vecs[first_vec], 2 - first_vec);
+        if (rc < 0) {
+            stream->error = errno;
+            return false;
+        }
+        for (size_t remaining = rc; remaining;) {
+            auto& vec = vecs[first_vec];
+            size_t nconsumed = min(remaining, vec.iov_len);
+            vec.iov_base = (u8*)vec.iov_base + nconsumed;
+            vec.iov_len -= nconsumed;
+            remaining -= nconsumed;
+            if (!vec.iov_len)
+                ++first_vec;
+        }
+    }
+}
+
 size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream)
 {
     assert(stream);
     auto* bytes = (const u8*)ptr;
-    ssize_t nwritten = 0;
-    for (size_t i = 0; i < (size * nmemb); ++i) {
-        int rc = fputc(bytes[i], stream);
-        if (rc == EOF)
-            break;
-        ++nwritten;
+    size_t total_size = size * nmemb;
+    if (!total_size)
+        return 0;
+
+    if (stream->mode == _IONBF) {
+        if (!flush_buffer_and_write(stream, bytes, total_size))
+            return 0;
+        return nmemb;
+    }
+
+    size_t nwritten = 0;
+    if (stream->mode == _IOLBF) {
+        // Everything up to and including the last newline goes out right away.
+        for (size_t i = total_size; i > 0; --i) {
+            if (bytes[i - 1] == '\n') {
+                if (!flush_buffer_and_write(stream, bytes, i))
+                    return 0;
+                nwritten = i;
+                break;
+            }
+        }
+    }
+
+    size_t remaining = total_size - nwritten;
+    if (stream->buffer_index + remaining < stream->buffer_size) {
+        memcpy(stream->buffer + stream->buffer_index, bytes + nwritten, remaining);
+        stream->buffer_index += remaining;
+    } else if (!flush_buffer_and_write(stream, bytes + nwritten, remaining)) {
+        return nwritten / size;
     }
-    return nwritten / size;
+    return nmemb;
 }
 
 int fseek(FILE* stream, long offset, int whence)
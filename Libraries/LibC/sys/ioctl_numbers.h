@@ -64,5 +64,7 @@ enum IOCtlNumber {
     SIOCGIFHWADDR,
     SIOCSIFNETMASK,
     SIOCADDRT,
-    SIOCDELRT
+    SIOCDELRT,
+    PROFILE_IOCTL_SET_FREQUENCY,
+    PROFILE_IOCTL_SET_FLAGS
 };
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <bits/stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+// /proc/all_binary has the same contents as /proc/all, but is much cheaper
+// to produce and to parse.
+//
+// It starts with a procstat_header and has one record per process after that.
+// A process record is a procstat_process followed by its strings (name, tty,
+// pledge and veil) and then thread_count thread records. A thread record is a
+// procstat_thread followed by its strings (name and state).
+//
+// Strings are a uint16_t length followed by that many bytes, without a null
+// terminator. Nothing is padded, so copy records out before looking at them.
+// The header has the size of each record type; readers should skip whatever
+// they don't know about, so that fields can be added at the end.
+
+#define PROCSTAT_MAGIC 0x54535250 // "PRST"
+#define PROCSTAT_VERSION 1
+
+struct procstat_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t process_count;
+    uint32_t process_record_size;
+    uint32_t thread_record_size;
+};
+
+struct procstat_process {
+    int32_t pid;
+    uint32_t pgid;
+    uint32_t pgp;
+    uint32_t sid;
+    uint32_t uid;
+    uint32_t gid;
+    int32_t ppid;
+    uint32_t nfds;
+    uint32_t amount_virtual;
+    uint32_t amount_resident;
+    uint32_t amount_dirty_private;
+    uint32_t amount_clean_inode;
+    uint32_t amount_shared;
+    uint32_t amount_purgeable_volatile;
+    uint32_t amount_purgeable_nonvolatile;
+    int32_t icon_id;
+    uint32_t minor_faults;
+    uint32_t major_faults;
+    uint32_t thread_count;
+};
+
+struct procstat_thread {
+    int32_t tid;
+    uint32_t times_scheduled;
+    uint32_t ticks;
+    uint32_t priority;
+    uint32_t effective_priority;
+    uint32_t syscall_count;
+    uint32_t inode_faults;
+    uint32_t zero_faults;
+    uint32_t cow_faults;
+    uint32_t file_read_bytes;
+    uint32_t file_write_bytes;
+    uint32_t unix_socket_read_bytes;
+    uint32_t unix_socket_write_bytes;
+    uint32_t ipv4_socket_read_bytes;
+    uint32_t ipv4_socket_write_bytes;
+};
+
+__END_DECLS
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <bits/stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+// /dev/profile streams samples of whatever is running, across the whole system.
+// Sampling starts when the device is opened and stops when it's closed; only one
+// reader is allowed at a time. Each read() returns one or more whole records.
+
+// perfcore.<pid> files, written when a process that used perf_event() exits, are made
+// of the same records: one PROFILE_RECORD_PROCESS followed by that process's events.
+
+// ioctl(fd, PROFILE_IOCTL_SET_FREQUENCY, hz): How often to sample. Capped at the timer frequency.
+// ioctl(fd, PROFILE_IOCTL_SET_FLAGS, flags): Any of the PROFILE_FLAG_* below.
+
+// When a thread's stack can't be walked with frame pointers, look for
+// return addresses in its stack instead. Slower, and may find stale frames.
+#define PROFILE_FLAG_SCAN_STACKS 0x1
+
+enum {
+    // A profile_sample, followed by frame_count uint32_t addresses, innermost first.
+    PROFILE_RECORD_SAMPLE = 1,
+    // A profile_process, followed by the name and then the executable path (not null-terminated).
+    // One is sent for every process when sampling starts, and another whenever a process exec()s.
+    PROFILE_RECORD_PROCESS,
+    // A profile_lost: samples had to be dropped because the reader didn't keep up.
+    PROFILE_RECORD_LOST,
+    // A profile_event: something a process reported with perf_event(), followed by
+    // frame_count uint32_t user addresses, innermost first. Only found in perfcore files.
+    PROFILE_RECORD_EVENT,
+    // A profile_tracepoint: the name of one of a process's tracepoint ids, followed by
+    // the name (not null-terminated). Only found in perfcore files.
+    PROFILE_RECORD_TRACEPOINT,
+};
+
+// Every record starts with this. size includes the header and is always a multiple of 4.
+struct profile_record_header {
+    uint16_t type;
+    uint16_t size;
+};
+
+// The sample was taken while the thread was running in the kernel.
+#define PROFILE_SAMPLE_IN_KERNEL 0x1
+// Some of the frames were found by scanning the stack.
+#define PROFILE_SAMPLE_SCANNED 0x2
+
+struct profile_sample {
+    struct profile_record_header header;
+    int32_t pid;
+    int32_t tid;
+    uint64_t timestamp;
+    uint32_t flags;
+    uint32_t frame_count;
+};
+
+struct profile_process {
+    struct profile_record_header header;
+    int32_t pid;
+    uint16_t name_length;
+    uint16_t executable_length;
+};
+
+struct profile_lost {
+    struct profile_record_header header;
+    uint32_t count;
+};
+
+// type is one of the PERF_EVENT_* types. For PERF_EVENT_MALLOC, arg1 is the size and
+// arg2 the pointer; for PERF_EVENT_FREE, arg1 is the pointer. For PERF_EVENT_TRACE_*,
+// arg1 is the tracepoint id and arg2 the payload that came with it.
+struct profile_event {
+    struct profile_record_header header;
+    int32_t tid;
+    uint64_t timestamp;
+    uint32_t type;
+    uint32_t arg1;
+    uint32_t arg2;
+    uint32_t frame_count;
+};
+
+struct profile_tracepoint {
+    struct profile_record_header header;
+    uint32_t id;
+    uint16_t name_length;
+    uint16_t reserved;
+};
+
+__END_DECLS
@@ -29,6 +29,7 @@
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
 #include <AK/NeverDestroyed.h>
+#include <AK/ScopeGuard.h>
 #include <AK/Time.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
@@ -37,18 +38,24 @@
 #include <LibCore/Notifier.h>
 #include <LibCore/Object.h>
 #include <LibCore/SyscallUtils.h>
+#include <LibCore/Tracepoint.h>
 #include <LibThread/Lock.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/epoll.h>
+#    define CEVENTLOOP_HAS_EPOLL
+#endif
+
 //#define CEVENTLOOP_DEBUG
 //#define DEFERRED_INVOKE_DEBUG
 
@@ -64,10 +71,96 @@ struct EventLoopTimer {
     TimerShouldFireWhenNotVisible fire_when_not_visible { TimerShouldFireWhenNotVisible::No };
     WeakPtr<Object> owner;
 
+    // Position in s_timer_heap, or -1 while the timer is parked (expired, but its owner is not visible.)
+    int heap_index { -1 };
+
     void reload(const timeval& now);
     bool has_expired(const timeval& now) const;
+    bool fires_before(const EventLoopTimer& other) const;
+    bool owner_is_visible() const;
+};
+
+// A binary min-heap of timers ordered by fire time. Each timer remembers its own
+// index, so unregistering a timer doesn't require a linear scan.
+class EventLoopTimerHeap {
+public:
+    bool is_empty() const { return m_timers.is_empty(); }
+    EventLoopTimer& peek_min() { return *m_timers.first(); }
+
+    void insert(EventLoopTimer& timer)
+    {
+        ASSERT(timer.heap_index == -1);
+        timer.heap_index = m_timers.size();
+        m_timers.append(&timer);
+        sift_up(timer.heap_index);
+    }
+
+    void remove(EventLoopTimer& timer)
+    {
+        ASSERT(timer.heap_index >= 0 && m_timers[timer.heap_index] == &timer);
+        int index = timer.heap_index;
+        int last_index = m_timers.size() - 1;
+        if (index != last_index) {
+            swap_entries(index, last_index);
+            m_timers.take_last();
+            sift_down(index);
+            sift_up(index);
+        } else {
+            m_timers.take_last();
+        }
+        timer.heap_index = -1;
+    }
+
+private:
+    void swap_entries(int a, int b)
+    {
+        swap(m_timers[a], m_timers[b]);
+        m_timers[a]->heap_index = a;
+        m_timers[b]->heap_index = b;
+    }
+
+    void sift_up(int index)
+    {
+        while (index > 0) {
+            int parent = (index - 1) / 2;
+            if (!m_timers[index]->fires_before(*m_timers[parent]))
+                break;
+            swap_entries(index, parent);
+            index = parent;
+        }
+    }
+
+    void sift_down(int index)
+    {
+        int size = m_timers.size();
+        for (;;) {
+            int smallest = index;
+            int left = index * 2 + 1;
+            int right = left + 1;
+            if (left < size && m_timers[left]->fires_before(*m_timers[smallest]))
+                smallest = left;
+            if (right < size && m_timers[right]->fires_before(*m_timers[smallest]))
+                smallest = right;
+            if (smallest == index)
+                break;
+            swap_entries(index, smallest);
+            index = smallest;
+        }
+    }
+
+    Vector<EventLoopTimer*> m_timers;
 };
 
+static timeval monotonic_now()
+{
+    timespec now_spec;
+    clock_gettime(CLOCK_MONOTONIC, &now_spec);
+    timeval now;
+    now.tv_sec = now_spec.tv_sec;
+    now.tv_usec = now_spec.tv_nsec / 1000;
+    return now;
+}
+
 struct EventLoop::Private {
     LibThread::Lock lock;
 };
@@ -76,9 +169,19 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop*>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static HashTable<Notifier*>* s_notifiers;
+static EventLoopTimerHeap* s_timer_heap;
+static Vector<EventLoopTimer*>* s_parked_timers;
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers;
 int EventLoop::s_wake_pipe_fds[2];
+
+// Notifiers are kept registered with the kernel (epoll) for as long as they're enabled,
+// so waiting for events doesn't have to rebuild and copy the whole fd set every time.
+// If that's unavailable (or the kernel refuses one of our fds) we fall back to poll().
+static int s_epoll_fd = -1;
+static Vector<pollfd>* s_poll_fds;
+static bool s_poll_fds_dirty = true;
 static RefPtr<LocalServer> s_rpc_server;
+static Tracepoint s_dispatch_tracepoint("Core::EventLoop::dispatch");
 HashMap<int, RefPtr<RPCClient>> s_rpc_clients;
 
 class RPCClient : public Object {
@@ -193,6 +296,19 @@ public:
             return;
         }
 
+        if (type == "GetEventLoopStats") {
+            auto& stats = EventLoop::main().stats();
+            JsonObject response;
+            response.set("type", type);
+            response.set("wakeups", stats.wakeups);
+            response.set("notifier_events", stats.notifier_events);
+            response.set("timer_events", stats.timer_events);
+            response.set("dispatched_events", stats.dispatched_events);
+            response.set("usec_in_handlers", stats.usec_in_handlers);
+            send_response(response);
+            return;
+        }
+
         if (type == "Disconnect") {
             shutdown();
             return;
@@ -217,7 +333,10 @@ EventLoop::EventLoop()
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_timer_heap = new EventLoopTimerHeap;
+        s_parked_timers = new Vector<EventLoopTimer*>;
+        s_notifiers = new HashMap<int, Vector<Notifier*, 1>>;
+        s_poll_fds = new Vector<pollfd>;
     }
 
     if (!s_main_event_loop) {
@@ -233,6 +352,20 @@ EventLoop::EventLoop()
         ASSERT(rc == 0);
         s_event_loop_stack->append(this);
 
+#ifdef CEVENTLOOP_HAS_EPOLL
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (s_epoll_fd >= 0) {
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.fd = s_wake_pipe_fds[0];
+            if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &event) < 0) {
+                perror("epoll_ctl");
+                close(s_epoll_fd);
+                s_epoll_fd = -1;
+            }
+        }
+#endif
+
         auto rpc_path = String::format("/tmp/rpc.%d", getpid());
         rc = unlink(rpc_path.characters());
         if (rc < 0 && errno != ENOENT) {
@@ -329,6 +462,16 @@ void EventLoop::pump(WaitMode mode)
         events = move(m_queued_events);
     }
 
+    if (events.is_empty())
+        return;
+
+    auto start_time = monotonic_now();
+    ScopeGuard account_time_in_handlers([&] {
+        timeval elapsed;
+        timeval_sub(monotonic_now(), start_time, elapsed);
+        m_stats.usec_in_handlers += (u64)elapsed.tv_sec * 1000000 + elapsed.tv_usec;
+    });
+
     for (size_t i = 0; i < events.size(); ++i) {
         auto& queued_event = events.at(i);
 #ifndef __clang__
@@ -336,6 +479,7 @@ void EventLoop::pump(WaitMode mode)
 #endif
         auto* receiver = queued_event.receiver.ptr();
         auto& event = *queued_event.event;
+        ++m_stats.dispatched_events;
 #ifdef CEVENTLOOP_DEBUG
         if (receiver)
             dbg() << "Core::EventLoop: " << *receiver << " event " << (int)event.type();
@@ -355,6 +499,7 @@ void EventLoop::pump(WaitMode mode)
             static_cast<DeferredInvocationEvent&>(event).m_invokee(*receiver);
         } else {
             NonnullRefPtr<Object> protector(*receiver);
+            TraceScope trace_scope(s_dispatch_tracepoint, event.type());
             receiver->dispatch_event(event);
         }
 
@@ -383,110 +528,223 @@ void EventLoop::post_event(Object& receiver, NonnullOwnPtr<Event>&& event)
     m_queued_events.empend(receiver, move(event));
 }
 
-void EventLoop::wait_for_event(WaitMode mode)
+static unsigned notifier_mask_for_fd(int fd)
 {
-    fd_set rfds;
-    fd_set wfds;
-    FD_ZERO(&rfds);
-    FD_ZERO(&wfds);
-
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
-    };
-
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            ASSERT_NOT_REACHED();
+    auto it = s_notifiers->find(fd);
+    if (it == s_notifiers->end())
+        return Notifier::None;
+    unsigned mask = Notifier::None;
+    for (auto* notifier : it->value)
+        mask |= notifier->event_mask();
+    // FIXME: Support Notifier::Exceptional.
+    ASSERT(!(mask & Notifier::Exceptional));
+    return mask;
+}
+
+#ifdef CEVENTLOOP_HAS_EPOLL
+static void fall_back_to_poll()
+{
+    dbg() << "Core::EventLoop: epoll_ctl: " << strerror(errno) << ", falling back to poll()";
+    close(s_epoll_fd);
+    s_epoll_fd = -1;
+    s_poll_fds_dirty = true;
+}
+#endif
+
+static void update_kernel_registration(int fd, unsigned old_mask, unsigned new_mask)
+{
+    s_poll_fds_dirty = true;
+#ifdef CEVENTLOOP_HAS_EPOLL
+    if (s_epoll_fd < 0 || old_mask == new_mask)
+        return;
+
+    if (new_mask == Notifier::None) {
+        // The fd may already have been closed (which removes it from the epoll set), so errors are fine here.
+        epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
     }
 
+    epoll_event event {};
+    event.data.fd = fd;
+    if (new_mask & Notifier::Read)
+        event.events |= EPOLLIN;
+    if (new_mask & Notifier::Write)
+        event.events |= EPOLLOUT;
+
+    // The kernel forgets about an fd when it's closed, and the fd number can be reused while
+    // a stale registration still exists, so treat our view of the epoll set as a hint.
+    int op = old_mask == Notifier::None ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    int rc = epoll_ctl(s_epoll_fd, op, fd, &event);
+    if (rc < 0 && op == EPOLL_CTL_ADD && errno == EEXIST)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    else if (rc < 0 && op == EPOLL_CTL_MOD && errno == ENOENT)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    if (rc < 0)
+        fall_back_to_poll();
+#else
+    (void)fd;
+    (void)old_mask;
+    (void)new_mask;
+#endif
+}
+
+static void append_poll_fd(int fd, short events)
+{
+    pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = events;
+    poll_fd.revents = 0;
+    s_poll_fds->append(poll_fd);
+}
+
+static void rebuild_poll_fds(int wake_fd)
+{
+    s_poll_fds->clear();
+    append_poll_fd(wake_fd, POLLIN);
+    for (auto& it : *s_notifiers) {
+        unsigned mask = notifier_mask_for_fd(it.key);
+        if (mask == Notifier::None)
+            continue;
+        short events = 0;
+        if (mask & Notifier::Read)
+            events |= POLLIN;
+        if (mask & Notifier::Write)
+            events |= POLLOUT;
+        append_poll_fd(it.key, events);
+    }
+    s_poll_fds_dirty = false;
+}
+
+static void drain_wake_pipe(int wake_fd)
+{
+    char buffer[32];
+    auto nread = read(wake_fd, buffer, sizeof(buffer));
+    if (nread < 0) {
+        perror("read from wake pipe");
+        ASSERT_NOT_REACHED();
+    }
+    ASSERT(nread > 0);
+}
+
+void EventLoop::post_notifier_events(int fd, bool readable, bool writable)
+{
+    auto it = s_notifiers->find(fd);
+    if (it == s_notifiers->end())
+        return;
+    for (auto* notifier : it->value) {
+        if (readable && (notifier->event_mask() & Notifier::Read) && notifier->on_ready_to_read) {
+            post_event(*notifier, make<NotifierReadEvent>(fd));
+            ++m_stats.notifier_events;
+        }
+        if (writable && (notifier->event_mask() & Notifier::Write) && notifier->on_ready_to_write) {
+            post_event(*notifier, make<NotifierWriteEvent>(fd));
+            ++m_stats.notifier_events;
+        }
+    }
+}
+
+void EventLoop::wait_for_event(WaitMode mode)
+{
     bool queued_events_is_empty;
     {
         LOCKER(m_private->lock);
         queued_events_is_empty = m_queued_events.is_empty();
     }
 
-    timeval now;
-    struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
-    if (mode == WaitMode::WaitForEvents) {
-        if (!s_timers->is_empty() && queued_events_is_empty) {
-            timespec now_spec;
-            clock_gettime(CLOCK_MONOTONIC, &now_spec);
-            now.tv_sec = now_spec.tv_sec;
-            now.tv_usec = now_spec.tv_nsec / 1000;
-            get_next_timer_expiration(timeout);
-            timeval_sub(timeout, now, timeout);
-            if (timeout.tv_sec < 0) {
-                timeout.tv_sec = 0;
-                timeout.tv_usec = 0;
-            }
+    // Parked timers expired while their owner was hidden. Give them another chance now.
+    for (size_t i = 0; i < s_parked_timers->size();) {
+        auto& timer = *s_parked_timers->at(i);
+        if (!timer.owner_is_visible()) {
+            ++i;
+            continue;
+        }
+        s_parked_timers->remove(i);
+        s_timer_heap->insert(timer);
+    }
+
+    int timeout_ms = 0;
+    if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
+        timeval timeout;
+        if (get_next_timer_expiration(timeout)) {
+            timeval_sub(timeout, monotonic_now(), timeout);
+            if (timeout.tv_sec < 0)
+                timeout_ms = 0;
+            else
+                timeout_ms = timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
         } else {
-            should_wait_forever = true;
+            timeout_ms = -1;
         }
-    } else {
-        should_wait_forever = false;
     }
 
-    int marked_fd_count = Core::safe_syscall(select, max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
-        char buffer[32];
-        auto nread = read(s_wake_pipe_fds[0], buffer, sizeof(buffer));
-        if (nread < 0) {
-            perror("read from wake pipe");
-            ASSERT_NOT_REACHED();
+#ifdef CEVENTLOOP_HAS_EPOLL
+    if (s_epoll_fd >= 0) {
+        epoll_event events[32];
+        int ready_count = Core::safe_syscall(epoll_wait, s_epoll_fd, events, 32, timeout_ms);
+        ++m_stats.wakeups;
+        for (int i = 0; i < ready_count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == s_wake_pipe_fds[0]) {
+                drain_wake_pipe(s_wake_pipe_fds[0]);
+                continue;
+            }
+            // Errors and hangups are reported as readiness, just like select() would.
+            bool readable = events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP);
+            bool writable = events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP);
+            post_notifier_events(fd, readable, writable);
         }
-        ASSERT(nread > 0);
+        fire_expired_timers();
+        return;
     }
+#endif
 
-    if (!s_timers->is_empty()) {
-        timespec now_spec;
-        clock_gettime(CLOCK_MONOTONIC, &now_spec);
-        now.tv_sec = now_spec.tv_sec;
-        now.tv_usec = now_spec.tv_nsec / 1000;
+    if (s_poll_fds_dirty)
+        rebuild_poll_fds(s_wake_pipe_fds[0]);
+    int marked_fd_count = Core::safe_syscall(poll, s_poll_fds->data(), s_poll_fds->size(), timeout_ms);
+    ++m_stats.wakeups;
+    if (marked_fd_count > 0) {
+        // Copy the set, posting events must not be disturbed by notifiers coming and going.
+        auto poll_fds = *s_poll_fds;
+        for (auto& poll_fd : poll_fds) {
+            if (!poll_fd.revents)
+                continue;
+            if (poll_fd.fd == s_wake_pipe_fds[0]) {
+                drain_wake_pipe(s_wake_pipe_fds[0]);
+                continue;
+            }
+            bool readable = poll_fd.revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL);
+            bool writable = poll_fd.revents & (POLLOUT | POLLERR | POLLHUP | POLLNVAL);
+            post_notifier_events(poll_fd.fd, readable, writable);
+        }
     }
+    fire_expired_timers();
+}
+
+void EventLoop::fire_expired_timers()
+{
+    if (s_timer_heap->is_empty())
+        return;
 
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
+    auto now = monotonic_now();
+    while (!s_timer_heap->is_empty()) {
+        auto& timer = s_timer_heap->peek_min();
         if (!timer.has_expired(now))
-            continue;
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && it.value->owner
-            && !it.value->owner->is_visible_for_timer_purposes()) {
+            break;
+        s_timer_heap->remove(timer);
+        if (!timer.owner_is_visible()) {
+            // Don't keep waking up for timers nobody will see; they're re-armed once the owner is visible.
+            s_parked_timers->append(&timer);
             continue;
         }
 #ifdef CEVENTLOOP_DEBUG
         dbg() << "Core::EventLoop: Timer " << timer.timer_id << " has expired, sending Core::TimerEvent to " << timer.owner;
 #endif
         post_event(*timer.owner, make<TimerEvent>(timer.timer_id));
+        ++m_stats.timer_events;
         if (timer.should_reload) {
             timer.reload(now);
+            s_timer_heap->insert(timer);
         } else {
-            // FIXME: Support removing expired timers that don't want to reload.
-            ASSERT_NOT_REACHED();
-        }
-    }
-
-    if (!marked_fd_count)
-        return;
-
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->on_ready_to_read)
-                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->on_ready_to_write)
-                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+            // Non-reloading timers stay registered (but dormant) until unregistered by their owner.
         }
     }
 }
@@ -496,28 +754,35 @@ bool EventLoopTimer::has_expired(const timeval& now) const
     return now.tv_sec > fire_time.tv_sec || (now.tv_sec == fire_time.tv_sec && now.tv_usec >= fire_time.tv_usec);
 }
 
+bool EventLoopTimer::fires_before(const EventLoopTimer& other) const
+{
+    return fire_time.tv_sec < other.fire_time.tv_sec || (fire_time.tv_sec == other.fire_time.tv_sec && fire_time.tv_usec < other.fire_time.tv_usec);
+}
+
+bool EventLoopTimer::owner_is_visible() const
+{
+    if (fire_when_not_visible == TimerShouldFireWhenNotVisible::Yes || !owner)
+        return true;
+    return owner->is_visible_for_timer_purposes();
+}
+
 void EventLoopTimer::reload(const timeval& now)
 {
     fire_time = now;
     fire_time.tv_sec += interval / 1000;
     fire_time.tv_usec += (interval % 1000) * 1000;
+    if (fire_time.tv_usec >= 1000000) {
+        ++fire_time.tv_sec;
+        fire_time.tv_usec -= 1000000;
+    }
 }
 
-void EventLoop::get_next_timer_expiration(timeval& soonest)
+bool EventLoop::get_next_timer_expiration(timeval& soonest)
 {
-    ASSERT(!s_timers->is_empty());
-    bool has_checked_any = false;
-    for (auto& it : *s_timers) {
-        auto& fire_time = it.value->fire_time;
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && it.value->owner
-            && !it.value->owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-        if (!has_checked_any || fire_time.tv_sec < soonest.tv_sec || (fire_time.tv_sec == soonest.tv_sec && fire_time.tv_usec < soonest.tv_usec))
-            soonest = fire_time;
-        has_checked_any = true;
-    }
+    if (s_timer_heap->is_empty())
+        return false;
+    soonest = s_timer_heap->peek_min().fire_time;
+    return true;
 }
 
 int EventLoop::register_timer(Object& object, int milliseconds, bool should_reload, TimerShouldFireWhenNotVisible fire_when_not_visible)
@@ -526,16 +791,12 @@ int EventLoop::register_timer(Object& object, int milliseconds, bool should_relo
     auto timer = make<EventLoopTimer>();
     timer->owner = object.make_weak_ptr();
     timer->interval = milliseconds;
-    timeval now;
-    timespec now_spec;
-    clock_gettime(CLOCK_MONOTONIC, &now_spec);
-    now.tv_sec = now_spec.tv_sec;
-    now.tv_usec = now_spec.tv_nsec / 1000;
-    timer->reload(now);
+    timer->reload(monotonic_now());
     timer->should_reload = should_reload;
     timer->fire_when_not_visible = fire_when_not_visible;
     int timer_id = s_id_allocator->allocate();
     timer->timer_id = timer_id;
+    s_timer_heap->insert(*timer);
     s_timers->set(timer_id, move(timer));
     return timer_id;
 }
@@ -546,18 +807,71 @@ bool EventLoop::unregister_timer(int timer_id)
     auto it = s_timers->find(timer_id);
     if (it == s_timers->end())
         return false;
+    auto& timer = *it->value;
+    if (timer.heap_index >= 0) {
+        s_timer_heap->remove(timer);
+    } else {
+        for (size_t i = 0; i < s_parked_timers->size(); ++i) {
+            if (s_parked_timers->at(i) == &timer) {
+                s_parked_timers->remove(i);
+                break;
+            }
+        }
+    }
     s_timers->remove(it);
     return true;
 }
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    int fd = notifier.fd();
+    unsigned old_mask = notifier_mask_for_fd(fd);
+    if (!s_notifiers->contains(fd))
+        s_notifiers->set(fd, {});
+    auto it = s_notifiers->find(fd);
+    if (it->value.contains_slow(&notifier))
+        return;
+    it->value.append(&notifier);
+    update_kernel_registration(fd, old_mask, notifier_mask_for_fd(fd));
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    int fd = notifier.fd();
+    auto it = s_notifiers->find(fd);
+    if (it == s_notifiers->end())
+        return;
+    unsigned old_mask = notifier_mask_for_fd(fd);
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers->remove(it);
+    update_kernel_registration(fd, old_mask, notifier_mask_for_fd(fd));
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, Notifier& notifier, unsigned old_event_mask)
+{
+    int fd = notifier.fd();
+    auto it = s_notifiers->find(fd);
+    if (it == s_notifiers->end() || !it->value.contains_slow(&notifier))
+        return;
+    unsigned old_mask = old_event_mask;
+    for (auto* other_notifier : it->value) {
+        if (other_notifier != &notifier)
+            old_mask |= other_notifier->event_mask();
+    }
+    update_kernel_registration(fd, old_mask, notifier_mask_for_fd(fd));
+}
+
+void EventLoop::dump_stats() const
+{
+    u64 events_per_wakeup_x100 = m_stats.wakeups ? (m_stats.notifier_events + m_stats.timer_events) * 100 / m_stats.wakeups : 0;
+    dbg() << "Core::EventLoop{" << this << "} stats:";
+    dbg() << "    wakeups: " << m_stats.wakeups;
+    dbg() << "    notifier events: " << m_stats.notifier_events;
+    dbg() << "    timer events: " << m_stats.timer_events;
+    dbg() << "    events per wakeup: " << events_per_wakeup_x100 / 100 << "." << String::format("%02u", (unsigned)(events_per_wakeup_x100 % 100));
+    dbg() << "    dispatched events: " << m_stats.dispatched_events;
+    dbg() << "    time in handlers: " << m_stats.usec_in_handlers / 1000 << " ms";
 }
 
 void EventLoop::wake()
@@ -64,6 +64,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void notifier_event_mask_changed(Badge<Notifier>, Notifier&, unsigned old_event_mask);
 
     void quit(int);
     void unquit();
@@ -75,9 +76,22 @@ public:
 
     static void wake();
 
+    struct Stats {
+        u64 wakeups { 0 };
+        u64 notifier_events { 0 };
+        u64 timer_events { 0 };
+        u64 dispatched_events { 0 };
+        u64 usec_in_handlers { 0 };
+    };
+
+    const Stats& stats() const { return m_stats; }
+    void dump_stats() const;
+
 private:
     void wait_for_event(WaitMode);
-    void get_next_timer_expiration(timeval&);
+    void post_notifier_events(int fd, bool readable, bool writable);
+    void fire_expired_timers();
+    bool get_next_timer_expiration(timeval&);
 
     struct QueuedEvent {
         AK_MAKE_NONCOPYABLE(QueuedEvent);
@@ -96,6 +110,8 @@ private:
     bool m_exit_requested { false };
     int m_exit_code { 0 };
 
+    Stats m_stats;
+
     static int s_wake_pipe_fds[2];
 
     struct Private;
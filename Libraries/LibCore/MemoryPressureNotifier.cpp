@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef __serenity__
+
+#    include <AK/LogStream.h>
+#    include <LibCore/MemoryPressureNotifier.h>
+#    include <fcntl.h>
+#    include <stdio.h>
+#    include <unistd.h>
+
+namespace Core {
+
+MemoryPressureNotifier::MemoryPressureNotifier(Object* parent)
+    : Object(parent)
+{
+    m_fd = open("/dev/mempressure", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        dbg() << "MemoryPressureNotifier: Unable to open /dev/mempressure";
+        return;
+    }
+    m_notifier = Notifier::construct(m_fd, Notifier::Read, this);
+    m_notifier->on_ready_to_read = [this] { drain(); };
+}
+
+MemoryPressureNotifier::~MemoryPressureNotifier()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+void MemoryPressureNotifier::drain()
+{
+    memory_pressure_event event;
+    ssize_t nread = read(m_fd, &event, sizeof(event));
+    if (nread < 0) {
+        perror("MemoryPressureNotifier: read");
+        return;
+    }
+    if (nread != sizeof(event) || event.level == m_level)
+        return;
+    m_level = event.level;
+    if (on_memory_pressure)
+        on_memory_pressure(m_level);
+}
+
+}
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * Copyright (c) 2020, the SerenityOS developers.
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,43 +26,37 @@
 
 #pragma once
 
-#include <AK/Types.h>
-#include <Kernel/KBuffer.h>
-#include <Kernel/Lock.h>
+// /dev/mempressure only exists on Serenity, so there's nothing to listen to anywhere else (like Lagom.)
+#ifdef __serenity__
 
-namespace Kernel {
+#    include <AK/Function.h>
+#    include <LibCore/Notifier.h>
+#    include <LibCore/Object.h>
+#    include <sys/memory_pressure.h>
 
-class DoubleBuffer {
-public:
-    explicit DoubleBuffer(size_t capacity = 65536);
+namespace Core {
 
-    ssize_t write(const u8*, ssize_t);
-    ssize_t read(u8*, ssize_t);
+// Listens on /dev/mempressure and calls on_memory_pressure whenever the kernel's
+// memory pressure level changes. Drop caches you can rebuild when it's not NORMAL.
+class MemoryPressureNotifier : public Object {
+    C_OBJECT(MemoryPressureNotifier)
+public:
+    virtual ~MemoryPressureNotifier() override;
 
-    bool is_empty() const { return m_empty; }
+    int level() const { return m_level; }
 
-    size_t space_for_writing() const { return m_space_for_writing; }
+    Function<void(int level)> on_memory_pressure;
 
 private:
-    void flip();
-    void compute_lockfree_metadata();
+    explicit MemoryPressureNotifier(Object* parent = nullptr);
 
-    struct InnerBuffer {
-        u8* data { nullptr };
-        size_t size;
-    };
+    void drain();
 
-    InnerBuffer* m_write_buffer { nullptr };
-    InnerBuffer* m_read_buffer { nullptr };
-    InnerBuffer m_buffer1;
-    InnerBuffer m_buffer2;
-
-    KBuffer m_storage;
-    size_t m_capacity { 0 };
-    size_t m_read_buffer_index { 0 };
-    size_t m_space_for_writing { 0 };
-    bool m_empty { true };
-    mutable Lock m_lock { "DoubleBuffer" };
+    int m_fd { -1 };
+    int m_level { MEMORY_PRESSURE_NORMAL };
+    RefPtr<Notifier> m_notifier;
 };
 
 }
+
+#endif
@@ -31,12 +31,159 @@
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
 #include <stdio.h>
+#include <string.h>
+
+#ifdef __serenity__
+#    include <sys/procstat.h>
+#endif
 
 namespace Core {
 
 HashMap<uid_t, String> ProcessStatisticsReader::s_usernames;
 
+// /proc/all_binary is Serenity's own, so elsewhere (like Lagom) we only ever read /proc/all.
+#ifdef __serenity__
+namespace {
+
+class BinaryReader {
+public:
+    explicit BinaryReader(const ByteBuffer& buffer)
+        : m_buffer(buffer)
+    {
+    }
+
+    // Copies out a record that might be smaller or larger than we expect,
+    // zero-filling whatever a (hypothetical) older kernel didn't provide.
+    bool read_record(void* record, size_t record_size, size_t size_in_buffer)
+    {
+        if (m_offset + size_in_buffer > m_buffer.size())
+            return false;
+        memset(record, 0, record_size);
+        memcpy(record, m_buffer.data() + m_offset, min(record_size, size_in_buffer));
+        m_offset += size_in_buffer;
+        return true;
+    }
+
+    bool read_string(String& string)
+    {
+        u16 length;
+        if (!read_record(&length, sizeof(length), sizeof(length)))
+            return false;
+        if (m_offset + length > m_buffer.size())
+            return false;
+        string = String((const char*)m_buffer.data() + m_offset, length);
+        m_offset += length;
+        return true;
+    }
+
+private:
+    const ByteBuffer& m_buffer;
+    size_t m_offset { 0 };
+};
+
+}
+#endif
+
 HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
+{
+#ifdef __serenity__
+    // The binary version is a lot cheaper to generate and to parse, and we keep
+    // the file open between calls since this usually gets polled. ProcFS makes
+    // a new snapshot whenever it's read from offset 0, so seeking back is enough.
+    static RefPtr<Core::File> binary_file;
+    if (!binary_file) {
+        auto file = Core::File::construct("/proc/all_binary");
+        if (file->open(Core::IODevice::ReadOnly))
+            binary_file = move(file);
+    } else {
+        binary_file->seek(0);
+    }
+
+    if (binary_file) {
+        HashMap<pid_t, Core::ProcessStatistics> map;
+        if (parse_binary(binary_file->read_all(), map))
+            return map;
+    }
+#endif
+
+    return get_all_from_json();
+}
+
+#ifdef __serenity__
+bool ProcessStatisticsReader::parse_binary(const ByteBuffer& buffer, HashMap<pid_t, Core::ProcessStatistics>& map)
+{
+    BinaryReader reader(buffer);
+
+    procstat_header header;
+    if (!reader.read_record(&header, sizeof(header), sizeof(header)))
+        return false;
+    if (header.magic != PROCSTAT_MAGIC || header.version != PROCSTAT_VERSION) {
+        fprintf(stderr, "ProcessStatisticsReader: Unexpected /proc/all_binary version %u\n", header.version);
+        return false;
+    }
+
+    for (size_t i = 0; i < header.process_count; ++i) {
+        procstat_process record;
+        if (!reader.read_record(&record, sizeof(record), header.process_record_size))
+            return false;
+
+        Core::ProcessStatistics process;
+        process.pid = record.pid;
+        process.pgid = record.pgid;
+        process.pgp = record.pgp;
+        process.sid = record.sid;
+        process.uid = record.uid;
+        process.gid = record.gid;
+        process.ppid = record.ppid;
+        process.nfds = record.nfds;
+        process.amount_virtual = record.amount_virtual;
+        process.amount_resident = record.amount_resident;
+        process.amount_shared = record.amount_shared;
+        process.amount_dirty_private = record.amount_dirty_private;
+        process.amount_clean_inode = record.amount_clean_inode;
+        process.amount_purgeable_volatile = record.amount_purgeable_volatile;
+        process.amount_purgeable_nonvolatile = record.amount_purgeable_nonvolatile;
+        process.icon_id = record.icon_id;
+        process.minor_faults = record.minor_faults;
+        process.major_faults = record.major_faults;
+        if (!reader.read_string(process.name) || !reader.read_string(process.tty) || !reader.read_string(process.pledge) || !reader.read_string(process.veil))
+            return false;
+
+        process.threads.ensure_capacity(record.thread_count);
+        for (size_t j = 0; j < record.thread_count; ++j) {
+            procstat_thread thread_record;
+            if (!reader.read_record(&thread_record, sizeof(thread_record), header.thread_record_size))
+                return false;
+
+            Core::ThreadStatistics thread;
+            thread.tid = thread_record.tid;
+            thread.times_scheduled = thread_record.times_scheduled;
+            thread.ticks = thread_record.ticks;
+            thread.priority = thread_record.priority;
+            thread.effective_priority = thread_record.effective_priority;
+            thread.syscall_count = thread_record.syscall_count;
+            thread.inode_faults = thread_record.inode_faults;
+            thread.zero_faults = thread_record.zero_faults;
+            thread.cow_faults = thread_record.cow_faults;
+            thread.unix_socket_read_bytes = thread_record.unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_record.unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_record.ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_record.ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_record.file_read_bytes;
+            thread.file_write_bytes = thread_record.file_write_bytes;
+            if (!reader.read_string(thread.name) || !reader.read_string(thread.state))
+                return false;
+            process.threads.append(move(thread));
+        }
+
+        process.username = username_from_uid(process.uid);
+        map.set(process.pid, move(process));
+    }
+    return true;
+}
+#endif
+
+HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all_from_json()
 {
     auto file = Core::File::construct("/proc/all");
     if (!file->open(Core::IODevice::ReadOnly)) {
@@ -73,6 +220,8 @@ HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
         process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
         process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile").to_u32();
         process.icon_id = process_object.get("icon_id").to_int();
+        process.minor_faults = process_object.get("minor_faults").to_u32();
+        process.major_faults = process_object.get("major_faults").to_u32();
 
         auto& thread_array = process_object.get_ptr("threads")->as_array();
         process.threads.ensure_capacity(thread_array.size());
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/HashMap.h>
 #include <AK/String.h>
 #include <unistd.h>
@@ -53,7 +54,7 @@ struct ThreadStatistics {
 };
 
 struct ProcessStatistics {
-    // Keep this in sync with /proc/all.
+    // Keep this in sync with /proc/all and /proc/all_binary.
     // From the kernel side:
     pid_t pid;
     unsigned pgid;
@@ -75,6 +76,8 @@ struct ProcessStatistics {
     size_t amount_purgeable_volatile;
     size_t amount_purgeable_nonvolatile;
     int icon_id;
+    unsigned minor_faults;
+    unsigned major_faults;
 
     Vector<Core::ThreadStatistics> threads;
 
@@ -87,6 +90,10 @@ public:
     static HashMap<pid_t, Core::ProcessStatistics> get_all();
 
 private:
+#ifdef __serenity__
+    static bool parse_binary(const ByteBuffer&, HashMap<pid_t, Core::ProcessStatistics>&);
+#endif
+    static HashMap<pid_t, Core::ProcessStatistics> get_all_from_json();
     static String username_from_uid(uid_t);
     static HashMap<uid_t, String> s_usernames;
 };
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibCore/Tracepoint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __serenity__
+#    include <serenity.h>
+#endif
+
+namespace Core {
+
+static u32 s_next_tracepoint_id;
+
+static bool is_enabled_by_environment(const char* name)
+{
+    const char* enabled = getenv("TRACEPOINTS");
+    if (!enabled)
+        return false;
+    StringView name_view(name);
+    for (auto& prefix : StringView(enabled).split_view(',')) {
+        if (prefix == "*" || name_view.starts_with(prefix))
+            return true;
+    }
+    return false;
+}
+
+Tracepoint::Tracepoint(const char* name)
+    : m_name(name)
+    , m_id(++s_next_tracepoint_id)
+    , m_enabled(is_enabled_by_environment(name))
+{
+}
+
+void Tracepoint::emit(Type type, u32 payload)
+{
+#ifdef __serenity__
+    // The name only needs to reach the perfcore file once, and only if the tracepoint fires.
+    if (!m_registered) {
+        m_registered = true;
+        perf_register_tracepoint(m_id, m_name);
+    }
+
+    switch (type) {
+    case Type::Begin:
+        perf_event(PERF_EVENT_TRACE_BEGIN, m_id, payload);
+        break;
+    case Type::End:
+        perf_event(PERF_EVENT_TRACE_END, m_id, payload);
+        break;
+    case Type::Instant:
+        perf_event(PERF_EVENT_TRACE_INSTANT, m_id, payload);
+        break;
+    }
+#else
+    (void)type;
+    (void)payload;
+#endif
+}
+
+}
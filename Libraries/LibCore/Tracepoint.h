@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Core {
+
+// A named point in the code that reports begin/end/instant events through perf_event(),
+// ending up in the process's perfcore file for ProfileViewer to show on its timeline.
+//
+// Tracepoints are off unless their name starts with one of the comma-separated prefixes
+// in the TRACEPOINTS environment variable ("*" turns all of them on), and a tracepoint
+// that is off costs one branch. Declare them as statics so that this is decided once:
+//
+//     static Core::Tracepoint s_paint_tracepoint("GUI::Window::paint");
+//     Core::TraceScope scope(s_paint_tracepoint);
+class Tracepoint {
+public:
+    explicit Tracepoint(const char* name);
+
+    const char* name() const { return m_name; }
+    u32 id() const { return m_id; }
+
+    bool is_enabled() const { return m_enabled; }
+    void set_enabled(bool enabled) { m_enabled = enabled; }
+
+    void begin(u32 payload = 0)
+    {
+        if (m_enabled)
+            emit(Type::Begin, payload);
+    }
+
+    void end(u32 payload = 0)
+    {
+        if (m_enabled)
+            emit(Type::End, payload);
+    }
+
+    void instant(u32 payload = 0)
+    {
+        if (m_enabled)
+            emit(Type::Instant, payload);
+    }
+
+private:
+    enum class Type {
+        Begin,
+        End,
+        Instant,
+    };
+
+    void emit(Type, u32 payload);
+
+    const char* m_name { nullptr };
+    u32 m_id { 0 };
+    bool m_enabled { false };
+    bool m_registered { false };
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(Tracepoint& tracepoint, u32 payload = 0)
+        : m_tracepoint(tracepoint)
+    {
+        m_tracepoint.begin(payload);
+    }
+
+    ~TraceScope()
+    {
+        m_tracepoint.end();
+    }
+
+private:
+    Tracepoint& m_tracepoint;
+};
+
+}
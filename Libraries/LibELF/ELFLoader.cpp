@@ -187,22 +187,30 @@ String ELFLoader::symbolicate(u32 address, u32* out_offset) const
     sorted_symbols = m_sorted_symbols.data();
 #endif
 
-    for (size_t i = 0; i < m_image.symbol_count(); ++i) {
-        if (sorted_symbols[i].address > address) {
-            if (i == 0) {
-                if (out_offset)
-                    *out_offset = 0;
-                return "!!";
-            }
-            auto& symbol = sorted_symbols[i - 1];
-            if (out_offset) {
-                *out_offset = address - symbol.address;
-                return demangle(symbol.name);
-            }
-            return String::format("%s +%u", demangle(symbol.name).characters(), address - symbol.address);
-        }
+    // Find the first symbol above the address, the one before it is ours.
+    size_t low = 0;
+    size_t high = m_image.symbol_count();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (sorted_symbols[middle].address > address)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    if (low == m_image.symbol_count()) {
+        if (out_offset)
+            *out_offset = 0;
+        return "??";
+    }
+    if (low == 0) {
+        if (out_offset)
+            *out_offset = 0;
+        return "!!";
+    }
+    auto& symbol = sorted_symbols[low - 1];
+    if (out_offset) {
+        *out_offset = address - symbol.address;
+        return demangle(symbol.name);
     }
-    if (out_offset)
-        *out_offset = 0;
-    return "??";
+    return String::format("%s +%u", demangle(symbol.name).characters(), address - symbol.address);
 }
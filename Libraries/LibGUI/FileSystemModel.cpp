@@ -27,6 +27,7 @@
 #include <AK/FileSystemPath.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/DirIterator.h>
+#include <LibCore/MemoryPressureNotifier.h>
 #include <LibGUI/FileSystemModel.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Bitmap.h>
@@ -443,6 +444,26 @@ Icon FileSystemModel::icon_for(const Node& node) const
 
 static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
 
+static void purge_thumbnail_cache_under_memory_pressure()
+{
+    static Core::MemoryPressureNotifier* s_notifier;
+    if (s_notifier)
+        return;
+    s_notifier = &Core::MemoryPressureNotifier::construct().leak_ref();
+    s_notifier->on_memory_pressure = [](int level) {
+        if (level == MEMORY_PRESSURE_NORMAL)
+            return;
+        // Keep the entries for thumbnails that are still being rendered.
+        Vector<String> paths_to_remove;
+        for (auto& it : s_thumbnail_cache) {
+            if (it.value)
+                paths_to_remove.append(it.key);
+        }
+        for (auto& path : paths_to_remove)
+            s_thumbnail_cache.remove(path);
+    };
+}
+
 static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
 {
     auto png_bitmap = Gfx::Bitmap::load_from_file(path);
@@ -470,6 +491,7 @@ bool FileSystemModel::fetch_thumbnail_for(const Node& node)
     // Otherwise, arrange to render the thumbnail
     // in background and make it available later.
 
+    purge_thumbnail_cache_under_memory_pressure();
     s_thumbnail_cache.set(path, nullptr);
     m_thumbnail_progress_total++;
 
@@ -30,6 +30,7 @@
 #include <AK/SharedBuffer.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/Tracepoint.h>
 #include <LibGUI/Action.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/Event.h>
@@ -239,6 +240,8 @@ void Window::event(Core::Event& event)
             return;
         if (!m_main_widget)
             return;
+        static Core::Tracepoint s_paint_tracepoint("GUI::Window::paint");
+        Core::TraceScope trace_scope(s_paint_tracepoint);
         auto& paint_event = static_cast<MultiPaintEvent&>(event);
         auto rects = paint_event.rects();
         ASSERT(!rects.is_empty());
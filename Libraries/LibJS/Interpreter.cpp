@@ -25,6 +25,7 @@
  */
 
 #include <AK/Badge.h>
+#include <LibCore/Tracepoint.h>
 #include <LibJS/AST.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/ArrayPrototype.h>
@@ -59,6 +60,9 @@ Value Interpreter::run(const Statement& statement, Vector<Argument> arguments, S
     if (!statement.is_scope_node())
         return statement.execute(*this);
 
+    static Core::Tracepoint s_run_tracepoint("JS::Interpreter::run");
+    Core::TraceScope trace_scope(s_run_tracepoint, (u32)scope_type);
+
     auto& block = static_cast<const BlockStatement&>(statement);
     enter_scope(block, move(arguments), scope_type);
 
@@ -27,6 +27,7 @@
 #include <AK/FileSystemPath.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/Timer.h>
+#include <LibCore/Tracepoint.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/DisplayLink.h>
 #include <LibGUI/MessageBox.h>
@@ -212,6 +213,9 @@ void Document::layout()
     if (!frame())
         return;
 
+    static Core::Tracepoint s_layout_tracepoint("Web::Document::layout");
+    Core::TraceScope trace_scope(s_layout_tracepoint);
+
     if (!m_layout_root) {
         LayoutTreeBuilder tree_builder;
         m_layout_root = tree_builder.build(*this);
@@ -148,6 +148,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (unveil("/proc/all_binary", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
     if (unveil("/bin/SystemMonitor", "x") < 0) {
         perror("unveil");
         return 1;
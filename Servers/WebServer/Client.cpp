@@ -31,7 +31,10 @@
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/HttpRequest.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -119,18 +122,62 @@ void Client::handle_request(ByteBuffer raw_request)
         return;
     }
 
-    send_response(file->read_all(), request);
+    send_file(*file, request);
 }
 
-void Client::send_response(StringView response, const Core::HttpRequest& request)
+void Client::send_file(Core::File& file, const Core::HttpRequest& request)
+{
+    struct stat st;
+    if (fstat(file.fd(), &st) < 0) {
+        perror("fstat");
+        send_error_response(500, "Internal server error, bro!", request);
+        return;
+    }
+
+    send_success_headers(st.st_size);
+
+    // Let the kernel move the file contents straight into the socket.
+    off_t offset = 0;
+    while (offset < st.st_size) {
+        ssize_t nsent = sendfile(m_socket->fd(), file.fd(), &offset, st.st_size - offset);
+        if (nsent < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {
+                // The socket is nonblocking, so wait for room in its send buffer and try again.
+                pollfd pfd { m_socket->fd(), POLLOUT, 0 };
+                if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                    perror("poll");
+                    break;
+                }
+                continue;
+            }
+            perror("sendfile");
+            break;
+        }
+        if (nsent == 0)
+            break;
+    }
+
+    log_response(200, request);
+}
+
+void Client::send_success_headers(Optional<size_t> content_length)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n");
     builder.append("Server: WebServer (SerenityOS)\r\n");
     builder.append("Content-Type: text/html\r\n");
+    if (content_length.has_value())
+        builder.appendf("Content-Length: %u\r\n", (unsigned)content_length.value());
     builder.append("\r\n");
 
     m_socket->write(builder.to_string());
+}
+
+void Client::send_response(StringView response, const Core::HttpRequest& request)
+{
+    send_success_headers({});
     m_socket->write(response);
 
     log_response(200, request);
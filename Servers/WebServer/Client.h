@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <LibCore/Object.h>
 #include <LibCore/TCPSocket.h>
 
@@ -40,7 +41,9 @@ private:
     Client(NonnullRefPtr<Core::TCPSocket>, Core::Object* parent);
 
     void handle_request(ByteBuffer);
+    void send_success_headers(Optional<size_t> content_length);
     void send_response(StringView, const Core::HttpRequest&);
+    void send_file(Core::File&, const Core::HttpRequest&);
     void send_redirect(StringView redirect, const Core::HttpRequest& request);
     void send_error_response(unsigned code, const StringView& message, const Core::HttpRequest&);
     void die();
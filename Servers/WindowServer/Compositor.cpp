@@ -33,6 +33,7 @@
 #include "WindowManager.h"
 #include <AK/Memory.h>
 #include <LibCore/Timer.h>
+#include <LibCore/Tracepoint.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibThread/BackgroundAction.h>
@@ -125,6 +126,9 @@ void Compositor::compose()
         return;
     }
 
+    static Core::Tracepoint s_compose_tracepoint("WindowServer::compose");
+    Core::TraceScope trace_scope(s_compose_tracepoint, dirty_rects.size());
+
     dirty_rects.add(Gfx::Rect::intersection(m_last_geometry_label_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::Rect::intersection(m_last_cursor_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::Rect::intersection(m_last_dnd_rect, Screen::the().rect()));
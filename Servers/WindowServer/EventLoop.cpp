@@ -77,6 +77,18 @@ EventLoop::EventLoop()
     m_mouse_notifier = Core::Notifier::construct(m_mouse_fd, Core::Notifier::Read);
     m_mouse_notifier->on_ready_to_read = [this] { drain_mouse(); };
 
+    // The previous backing store of each window is only kept around so clients can flip
+    // back to it without a round-trip. Drop them when memory gets tight.
+    m_memory_pressure_notifier = Core::MemoryPressureNotifier::construct();
+    m_memory_pressure_notifier->on_memory_pressure = [](int level) {
+        if (level == MEMORY_PRESSURE_NORMAL)
+            return;
+        WindowManager::the().for_each_window([](auto& window) {
+            window.discard_last_backing_store();
+            return IterationDecision::Continue;
+        });
+    };
+
     Clipboard::the().on_content_change = [&] {
         ClientConnection::for_each_client([&](auto& client) {
             client.notify_about_clipboard_contents_changed();
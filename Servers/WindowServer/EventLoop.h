@@ -29,6 +29,7 @@
 #include <AK/ByteBuffer.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/MemoryPressureNotifier.h>
 #include <LibCore/Notifier.h>
 
 namespace WindowServer {
@@ -52,6 +53,7 @@ private:
     int m_mouse_fd { -1 };
     RefPtr<Core::Notifier> m_mouse_notifier;
     RefPtr<Core::LocalServer> m_server;
+    RefPtr<Core::MemoryPressureNotifier> m_memory_pressure_notifier;
 };
 
 }
@@ -186,6 +186,7 @@ public:
     }
 
     Gfx::Bitmap* last_backing_store() { return m_last_backing_store.ptr(); }
+    void discard_last_backing_store() { m_last_backing_store = nullptr; }
 
     void set_global_cursor_tracking_enabled(bool);
     void set_automatic_cursor_tracking_enabled(bool enabled) { m_automatic_cursor_tracking_enabled = enabled; }
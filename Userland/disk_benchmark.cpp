@@ -59,22 +59,24 @@ Result average_result(const Vector<Result>& results)
 
 void exit_with_usage(int rc)
 {
-    fprintf(stderr, "Usage: disk_benchmark [-h] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
+    fprintf(stderr, "Usage: disk_benchmark [-h] [-c] [-d directory | -r device] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
     exit(rc);
 }
 
 Result benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache);
+Result benchmark_device(const String& device, int read_size, int block_size, ByteBuffer& buffer, bool allow_cache);
 
 int main(int argc, char** argv)
 {
     char* directory = strdup(".");
+    char* device = nullptr;
     int time_per_benchmark = 10;
     Vector<int> file_sizes;
     Vector<int> block_sizes;
     bool allow_cache = false;
 
     int opt;
-    while ((opt = getopt(argc, argv, "chd:t:f:b:")) != -1) {
+    while ((opt = getopt(argc, argv, "chd:r:t:f:b:")) != -1) {
         switch (opt) {
         case 'h':
             exit_with_usage(0);
@@ -85,6 +87,9 @@ int main(int argc, char** argv)
         case 'd':
             directory = strdup(optarg);
             break;
+        case 'r':
+            device = strdup(optarg);
+            break;
         case 't':
             time_per_benchmark = atoi(optarg);
             break;
@@ -125,11 +130,17 @@ int main(int argc, char** argv)
             while (timer.elapsed() < time_per_benchmark * 1000) {
                 printf(".");
                 fflush(stdout);
-                results.append(benchmark(filename, file_size, block_size, buffer, allow_cache));
+                if (device)
+                    results.append(benchmark_device(device, file_size, block_size, buffer, allow_cache));
+                else
+                    results.append(benchmark(filename, file_size, block_size, buffer, allow_cache));
                 usleep(100);
             }
             auto average = average_result(results);
-            printf("\nFinished: runs=%zu time=%dms write_bps=%llu read_bps=%llu\n", results.size(), timer.elapsed(), average.write_bps, average.read_bps);
+            if (device)
+                printf("\nFinished: runs=%zu time=%dms read_bps=%llu\n", results.size(), timer.elapsed(), average.read_bps);
+            else
+                printf("\nFinished: runs=%zu time=%dms write_bps=%llu read_bps=%llu\n", results.size(), timer.elapsed(), average.write_bps, average.read_bps);
 
             sleep(1);
         }
@@ -206,3 +217,48 @@ Result benchmark(const String& filename, int file_size, int block_size, ByteBuff
 
     return res;
 }
+
+// Sequential reads from the start of a raw device. We never write to it, since that would destroy whatever is on it.
+Result benchmark_device(const String& device, int read_size, int block_size, ByteBuffer& buffer, bool allow_cache)
+{
+    int flags = O_RDONLY;
+    if (!allow_cache)
+        flags |= O_DIRECT;
+
+    int fd = open(device.characters(), flags);
+    if (fd == -1) {
+        perror("open");
+        exit(1);
+    }
+
+    Result res;
+    res.write_bps = 0;
+
+    Core::ElapsedTimer timer;
+
+    timer.start();
+    int nread = 0;
+    while (nread < read_size) {
+        int n = read(fd, buffer.data(), block_size);
+        if (n < 0) {
+            perror("read");
+            close(fd);
+            exit(1);
+        }
+        if (n == 0) {
+            fprintf(stderr, "%s is smaller than %d bytes\n", device.characters(), read_size);
+            close(fd);
+            exit(1);
+        }
+        nread += n;
+    }
+
+    res.read_bps = (u64)(timer.elapsed() ? (read_size / timer.elapsed()) : read_size) * 1000;
+
+    if (close(fd) != 0) {
+        perror("close");
+        exit(1);
+    }
+
+    return res;
+}
@@ -25,12 +25,47 @@
  */
 
 #include <AK/ByteBuffer.h>
+#include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
 #include <assert.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+// Same as the kernel's LogLevel::Info, anything above that is debug chatter.
+static const int max_level_to_show = 6;
+
+static int follow_kernel_log()
+{
+    int fd = open("/dev/kmsg", O_RDONLY);
+    if (fd < 0) {
+        perror("open /dev/kmsg");
+        return 1;
+    }
+
+    // Each read() gives us one record: "<level>,<sequence>,<seconds>.<microseconds>;<text>"
+    char buffer[256];
+    for (;;) {
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            return 1;
+        }
+        if (nread == 0)
+            continue;
+        auto* text = (const char*)memchr(buffer, ';', nread);
+        if (!text)
+            continue;
+        ++text;
+        if (atoi(buffer) > max_level_to_show)
+            continue;
+        fwrite(text, 1, nread - (text - buffer), stdout);
+        fflush(stdout);
+    }
+}
+
 int main(int argc, char** argv)
 {
     if (pledge("stdio rpath", nullptr) < 0) {
@@ -43,10 +78,22 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (unveil("/dev/kmsg", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
     unveil(nullptr, nullptr);
 
-    (void)argc;
-    (void)argv;
+    bool follow = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(follow, "Wait for new messages", "follow", 'w');
+    args_parser.parse(argc, argv);
+
+    if (follow)
+        return follow_kernel_log();
+
     auto f = Core::File::construct("/proc/dmesg");
     if (!f->open(Core::IODevice::ReadOnly)) {
         fprintf(stderr, "open: failed to open /proc/dmesg: %s\n", f->error_string());
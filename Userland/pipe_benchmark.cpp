@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: pipe_benchmark [-h] [-s total_size] [-p pipe_size] [-b block_size1,block_size2,...]\n");
+    exit(rc);
+}
+
+static u64 benchmark(int total_size, int block_size, int pipe_size)
+{
+    int fds[2];
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    if (pipe_size && fcntl(fds[1], F_SETPIPE_SZ, pipe_size) < 0) {
+        perror("fcntl(F_SETPIPE_SZ)");
+        exit(1);
+    }
+
+    auto buffer = ByteBuffer::create_zeroed(block_size);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        for (int nwritten = 0; nwritten < total_size;) {
+            int n = write(fds[1], buffer.data(), min(block_size, total_size - nwritten));
+            if (n < 0) {
+                perror("write");
+                _exit(1);
+            }
+            nwritten += n;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    int nread = 0;
+    for (;;) {
+        int n = read(fds[0], buffer.data(), block_size);
+        if (n < 0) {
+            perror("read");
+            exit(1);
+        }
+        if (n == 0)
+            break;
+        nread += n;
+    }
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+
+    if (nread != total_size) {
+        fprintf(stderr, "Short transfer: %d of %d bytes\n", nread, total_size);
+        exit(1);
+    }
+
+    return (u64)(timer.elapsed() ? (total_size / timer.elapsed()) : total_size) * 1000;
+}
+
+int main(int argc, char** argv)
+{
+    int total_size = 64 * MB;
+    int pipe_size = 0;
+    Vector<int> block_sizes;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hs:p:b:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 's':
+            total_size = atoi(optarg);
+            break;
+        case 'p':
+            pipe_size = atoi(optarg);
+            break;
+        case 'b':
+            for (auto size : String(optarg).split(','))
+                block_sizes.append(atoi(size.characters()));
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (block_sizes.size() == 0)
+        block_sizes = { 512, 4096, 32768, 65536 };
+
+    for (auto block_size : block_sizes) {
+        if (block_size <= 0)
+            exit_with_usage(1);
+        printf("Running: total_size=%d block_size=%d pipe_size=%d\n", total_size, block_size, pipe_size);
+        auto bps = benchmark(total_size, block_size, pipe_size);
+        printf("Finished: bps=%llu\n", bps);
+    }
+
+    return 0;
+}
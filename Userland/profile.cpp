@@ -24,11 +24,68 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/ByteBuffer.h>
 #include <LibCore/ArgsParser.h>
+#include <fcntl.h>
 #include <serenity.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
+#include <sys/profile.h>
+#include <time.h>
+#include <unistd.h>
+
+static int record_system_profile(const char* output_path, int seconds, int frequency, bool scan_stacks)
+{
+    int fd = open("/dev/profile", O_RDONLY);
+    if (fd < 0) {
+        perror("open /dev/profile");
+        return 1;
+    }
+
+    if (frequency > 0 && ioctl(fd, PROFILE_IOCTL_SET_FREQUENCY, frequency) < 0) {
+        perror("ioctl(PROFILE_IOCTL_SET_FREQUENCY)");
+        return 1;
+    }
+
+    if (scan_stacks && ioctl(fd, PROFILE_IOCTL_SET_FLAGS, PROFILE_FLAG_SCAN_STACKS) < 0) {
+        perror("ioctl(PROFILE_IOCTL_SET_FLAGS)");
+        return 1;
+    }
+
+    int output_fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (output_fd < 0) {
+        perror("open");
+        return 1;
+    }
+
+    auto buffer = ByteBuffer::create_uninitialized(64 * KB);
+    size_t total = 0;
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - start.tv_sec >= seconds)
+            break;
+        ssize_t nread = read(fd, buffer.data(), buffer.size());
+        if (nread < 0) {
+            perror("read");
+            return 1;
+        }
+        if (write(output_fd, buffer.data(), nread) != nread) {
+            perror("write");
+            return 1;
+        }
+        total += nread;
+    }
+
+    close(output_fd);
+    close(fd);
+    printf("Wrote %zu bytes to %s\n", total, output_path);
+    return 0;
+}
 
 int main(int argc, char** argv)
 {
@@ -38,14 +95,27 @@ int main(int argc, char** argv)
     const char* cmd_argument = nullptr;
     bool enable = false;
     bool disable = false;
+    bool all = false;
+    bool scan_stacks = false;
+    int seconds = 5;
+    int frequency = 0;
+    const char* output_path = "/tmp/system.profile";
 
     args_parser.add_option(pid_argument, "Target PID", nullptr, 'p', "PID");
     args_parser.add_option(enable, "Enable", nullptr, 'e');
     args_parser.add_option(disable, "Disable", nullptr, 'd');
     args_parser.add_option(cmd_argument, "Command", nullptr, 'c', "command");
+    args_parser.add_option(all, "Record the whole system", "all", 'a');
+    args_parser.add_option(seconds, "How long to record for (with -a)", "seconds", 's', "seconds");
+    args_parser.add_option(frequency, "Samples per second (with -a)", "frequency", 'f', "hz");
+    args_parser.add_option(scan_stacks, "Scan stacks that can't be walked (with -a)", "scan-stacks", 'S');
+    args_parser.add_option(output_path, "Where to write the profile (with -a)", "output", 'o', "path");
 
     args_parser.parse(argc, argv);
 
+    if (all)
+        return record_system_profile(output_path, seconds, frequency, scan_stacks);
+
     if (!pid_argument && !cmd_argument) {
         args_parser.print_usage(stdout, argv[0]);
         return 0;
@@ -143,6 +143,11 @@ int main(int, char**)
         return 1;
     }
 
+    if (unveil("/proc/all_binary", "r") < 0) {
+        perror("unveil");
+        return 1;
+    }
+
     if (unveil("/etc/passwd", "r") < 0) {
         perror("unveil");
         return 1;